@@ -0,0 +1,144 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file DatagramBench.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Measures the cost of constructing a Datagram, compared to the MD5 based id it had before
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#ifdef PLAGN_BENCH_MD5
+// openssl includes
+#include <openssl/evp.h>
+#endif
+
+// own includes
+#include "Datagram.hpp"
+#include "Utilities.hpp"
+
+using namespace std;
+
+namespace
+{
+size_t g_sink = 0;  //!< results of the runs end up here, so that they are not optimized away
+
+#ifdef PLAGN_BENCH_MD5
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief the id, each Datagram got in its constructor before: an MD5 hash over the name of the
+ * source, the time and the microseconds since the start of the steady clock
+ *
+ * @param sourceName the name of the Plag, which created the Datagram
+ * @return string the 16 bytes of the hash
+ */
+string makeMd5Id(const string & sourceName)
+{
+    string feed = sourceName + to_string(0);
+    feed += getTimeAsUtcIsoStr(chrono::system_clock::to_time_t(chrono::system_clock::now()));
+    chrono::microseconds sinceEpoch = chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now().time_since_epoch());
+    feed += to_string(sinceEpoch.count() % 1000000);
+
+    unsigned char hash[EVP_MAX_MD_SIZE];
+    unsigned int hashLength = 0;
+    EVP_MD_CTX * context = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(context, EVP_md5(), nullptr);
+    EVP_DigestUpdate(context, feed.data(), feed.size());
+    EVP_DigestFinal_ex(context, hash, &hashLength);
+    EVP_MD_CTX_free(context);
+    return string(reinterpret_cast<char *>(hash), hashLength);
+}
+#endif
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief constructs a Datagram, as it is done now
+ *
+ */
+void constructDatagram()
+{
+    shared_ptr<Datagram> datagram = make_shared<Datagram>("bench");
+    g_sink += reinterpret_cast<size_t>(datagram.get()) & 1;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief constructs a Datagram and renders its id, as reading "uuid" or toString() does
+ *
+ */
+void constructDatagramWithId()
+{
+    shared_ptr<Datagram> datagram = make_shared<Datagram>("bench");
+    g_sink += datagram->getId().size();
+}
+
+#ifdef PLAGN_BENCH_MD5
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief constructs a Datagram with the work its constructor did before for the MD5 based id
+ *
+ */
+void constructMd5Datagram()
+{
+    shared_ptr<Datagram> datagram = make_shared<Datagram>("bench");
+    g_sink += makeMd5Id("bench").size();
+}
+#endif
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief runs @p construct @p iterations times and prints the time per Datagram
+ *
+ * @param name label of the run
+ * @param iterations number of Datagrams to construct
+ * @param construct the construction to run
+ */
+void measure(const char * name, size_t iterations, void (*construct)())
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++)
+    {
+        construct();
+    }
+    chrono::nanoseconds duration = chrono::steady_clock::now() - start;
+    printf("%-28s %10zu Datagrams, %8.1f ns/Datagram\n", name, iterations,
+           static_cast<double>(duration.count()) / iterations);
+}
+} // namespace
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief usage: datagramBench [iterations], by default 1000000. The MD5 based id is only measured,
+ * if OpenSSL was found when configuring.
+ *
+ */
+int main(int argc, char * argv[])
+{
+    size_t iterations = argc > 1 ? max(strtoul(argv[1], nullptr, 10), 1ul) : 1000000;
+#ifdef PLAGN_BENCH_MD5
+    measure("before: MD5 id", iterations, constructMd5Datagram);
+#endif
+    measure("now: sequence number", iterations, constructDatagram);
+    measure("now: sequence number + getId", iterations, constructDatagramWithId);
+    return g_sink == 0 ? 1 : 0;
+}
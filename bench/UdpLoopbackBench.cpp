@@ -0,0 +1,208 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file UdpLoopbackBench.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Measures the packets per second over loopback with one syscall per packet and with
+ * sendmmsg()/recvmmsg(), as PlagUdp uses them
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// system includes
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+constexpr size_t PAYLOAD_SIZE = 64;     //!< bytes per packet
+constexpr size_t BUFFER_SIZE = 2048;    //!< bytes per receive buffer
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief sockets, buffers and headers of one run. A run sends a round of packets to the receiving
+ * socket, then takes them from it again, round after round.
+ *
+ */
+struct Loopback
+{
+    int sender;                         //!< socket sending to receiverAddress
+    int receiver;                       //!< socket bound to receiverAddress
+    sockaddr_in receiverAddress;        //!< 127.0.0.1 and a port chosen by the kernel
+    vector<char> payload;               //!< content of every sent packet
+    vector<char> buffers;               //!< one receive buffer per packet of a round
+    vector<sockaddr_in> senders;        //!< senders of the received packets
+    vector<iovec> sendVectors;          //!< one iovec per sent packet
+    vector<iovec> receiveVectors;       //!< one iovec per receive buffer
+    vector<mmsghdr> sendHeaders;        //!< headers handed to sendmmsg()
+    vector<mmsghdr> receiveHeaders;     //!< headers handed to recvmmsg()
+};
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief opens the sockets and prepares the headers for rounds of @p batch packets
+ *
+ * @param batch packets per round
+ * @return Loopback ready to run
+ */
+Loopback openLoopback(size_t batch)
+{
+    Loopback loopback;
+    loopback.sender = socket(AF_INET, SOCK_DGRAM, 0);
+    loopback.receiver = socket(AF_INET, SOCK_DGRAM, 0);
+    if (loopback.sender < 0 || loopback.receiver < 0)
+    {
+        perror("socket");
+        exit(EXIT_FAILURE);
+    }
+    int receiveBuffer = 8 << 20;
+    setsockopt(loopback.receiver, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    loopback.receiverAddress = sockaddr_in();
+    loopback.receiverAddress.sin_family = AF_INET;
+    loopback.receiverAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sockaddr * address = reinterpret_cast<sockaddr *>(&loopback.receiverAddress);
+    socklen_t addressLength = sizeof(loopback.receiverAddress);
+    if (bind(loopback.receiver, address, addressLength) < 0
+        || getsockname(loopback.receiver, address, &addressLength) < 0)
+    {
+        perror("bind");
+        exit(EXIT_FAILURE);
+    }
+
+    loopback.payload.assign(PAYLOAD_SIZE, 'x');
+    loopback.buffers.assign(batch * BUFFER_SIZE, 0);
+    loopback.senders.resize(batch);
+    loopback.sendVectors.resize(batch);
+    loopback.receiveVectors.resize(batch);
+    loopback.sendHeaders.assign(batch, mmsghdr());
+    loopback.receiveHeaders.assign(batch, mmsghdr());
+    for (size_t i = 0; i < batch; i++)
+    {
+        loopback.sendVectors[i].iov_base = loopback.payload.data();
+        loopback.sendVectors[i].iov_len = loopback.payload.size();
+        loopback.sendHeaders[i].msg_hdr.msg_iov = &loopback.sendVectors[i];
+        loopback.sendHeaders[i].msg_hdr.msg_iovlen = 1;
+        loopback.sendHeaders[i].msg_hdr.msg_name = &loopback.receiverAddress;
+        loopback.sendHeaders[i].msg_hdr.msg_namelen = sizeof(loopback.receiverAddress);
+        loopback.receiveVectors[i].iov_base = &loopback.buffers[i * BUFFER_SIZE];
+        loopback.receiveVectors[i].iov_len = BUFFER_SIZE;
+        loopback.receiveHeaders[i].msg_hdr.msg_iov = &loopback.receiveVectors[i];
+        loopback.receiveHeaders[i].msg_hdr.msg_iovlen = 1;
+        loopback.receiveHeaders[i].msg_hdr.msg_name = &loopback.senders[i];
+    }
+    return loopback;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief one round with sendto() and recvfrom() per packet
+ *
+ * @param loopback the sockets to use
+ * @param batch packets per round
+ * @return size_t packets received
+ */
+size_t runSingleRound(Loopback & loopback, size_t batch)
+{
+    for (size_t i = 0; i < batch; i++)
+    {
+        sendto(loopback.sender, loopback.payload.data(), loopback.payload.size(), 0,
+               reinterpret_cast<sockaddr *>(&loopback.receiverAddress),
+               sizeof(loopback.receiverAddress));
+    }
+    size_t received = 0;
+    for (size_t i = 0; i < batch; i++)
+    {
+        socklen_t senderLength = sizeof(loopback.senders[0]);
+        if (recvfrom(loopback.receiver, loopback.buffers.data(), BUFFER_SIZE, MSG_DONTWAIT,
+                     reinterpret_cast<sockaddr *>(&loopback.senders[0]), &senderLength) > 0)
+        {
+            received++;
+        }
+    }
+    return received;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief one round with one sendmmsg() and one recvmmsg() for all packets
+ *
+ * @param loopback the sockets to use
+ * @param batch packets per round
+ * @return size_t packets received
+ */
+size_t runBatchedRound(Loopback & loopback, size_t batch)
+{
+    sendmmsg(loopback.sender, loopback.sendHeaders.data(), static_cast<unsigned int>(batch), 0);
+    for (size_t i = 0; i < batch; i++)
+    {
+        loopback.receiveHeaders[i].msg_hdr.msg_namelen = sizeof(loopback.senders[i]);
+    }
+    int received = recvmmsg(loopback.receiver, loopback.receiveHeaders.data(),
+                            static_cast<unsigned int>(batch), MSG_DONTWAIT, nullptr);
+    return received > 0 ? static_cast<size_t>(received) : 0;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief runs @p rounds and prints the packets per second, counting each packet sent and
+ * received once
+ *
+ * @param name label of the run
+ * @param rounds number of rounds
+ * @param batch packets per round
+ * @param round the round to run
+ */
+void measure(const string & name, size_t rounds, size_t batch, size_t (*round)(Loopback &, size_t))
+{
+    Loopback loopback = openLoopback(batch);
+    size_t received = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < rounds; i++)
+    {
+        received += round(loopback, batch);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("%-24s %10zu packets in %6.2f s = %10.0f pps\n", name.c_str(), received, seconds,
+           received / seconds);
+    close(loopback.sender);
+    close(loopback.receiver);
+}
+} // namespace
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief usage: udpLoopbackBench [batch [rounds]], by default 32 packets per round (PlagUdp's
+ * default syscallBatch) and 50000 rounds
+ *
+ */
+int main(int argc, char * argv[])
+{
+    size_t batch = argc > 1 ? max(strtoul(argv[1], nullptr, 10), 1ul) : 32;
+    size_t rounds = argc > 2 ? max(strtoul(argv[2], nullptr, 10), 1ul) : 50000;
+    measure("sendto/recvfrom", rounds, batch, runSingleRound);
+    measure("sendmmsg/recvmmsg x" + to_string(batch), rounds, batch, runBatchedRound);
+    return 0;
+}
@@ -23,17 +23,59 @@
 #define KABLE_HPP
 
 // std includes
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <memory>
+#include <vector>
+
+// boost includes
+#include <boost/asio.hpp>
 
 // own includes
+#include "Runtime.hpp"
+#include "utils/DataExpression.hpp"
+#include "utils/GateCondition.hpp"
+#include "utils/LatencyMetric.hpp"
+#include "utils/MpscRingQueue.hpp"
 #include "utils/PlagInterface.hpp"
 #include "utils/PropertyTreeReader.hpp"
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief how a Kable hands translated Datagrams to its target
+ *
+ */
+enum DeliveryMode : uint8_t
+{
+    SYNC_DELIVERY,  //!< on the source Plag's turn, right after translation
+    ASYNC_DELIVERY  //!< via a queue of the Kable, drained on its own strand of the Runtime
+};
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The Kable class translates the Datagrams of its source Plag into Datagrams of its target
+ * Plag and delivers them there.
+ *
+ * @details Translation is done on the turn of the source Plag. By default, so is the delivery.
+ * With `delivery=async` the translated Datagrams are queued instead, and delivered by the Kable's
+ * own strand of the Runtime, so that a slow or contended target does not hold up the source.
+ * If that queue is full, the newest Datagram is dropped.
+ * Either way the Kable counts delivered and dropped Datagrams, the time from transmit() until the
+ * target had the Datagram placed (latency) and the longest backlog of its queue.
+ * Translated Datagrams keep the time of ingress of their source Datagram. Target Plags, that mark
+ * when they send a Datagram (see Datagram::markEgress()), thereby record the latency from ingress
+ * to egress into the Kable's m_ingressToEgress.
+ */
 class Kable : public PropertyTreeReader
 {
 public:
+    static constexpr size_t DEFAULT_DELIVERY_QUEUE_CAPACITY = 4096; //!< default Datagrams in the delivery queue
+    static constexpr size_t MAX_DELIVERY_BATCH = 256;   //!< most Datagrams delivered per drain of the queue
+
     Kable(const boost::property_tree::ptree & propTree,
           const std::string & rootName,
+          Runtime & runtime,
           std::weak_ptr<PlagInterface> parent,
           std::weak_ptr<PlagInterface> target = std::weak_ptr<PlagInterface>{});
 
@@ -42,16 +84,77 @@ public:
     bool assignTarget(std::weak_ptr<PlagInterface> parent);
 
     void transmit(std::shared_ptr<Datagram> datagram);
+    void transmit(const std::vector<std::shared_ptr<Datagram>> & datagrams);
 
     std::shared_ptr<Datagram> translate(std::shared_ptr<Datagram> sourceDatagram);
 
     void deliver(std::shared_ptr<Datagram> datagram);
+    void deliver(const std::vector<std::shared_ptr<Datagram>> & datagrams);
+
+    size_t getRoomFor(size_t count);
+
+    std::string getStatistics() const;
+
+private:
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief a translated Datagram waiting in the delivery queue
+     *
+     */
+    struct QueuedDatagram
+    {
+        std::shared_ptr<Datagram> datagram;                 //!< the translated Datagram
+        std::chrono::steady_clock::time_point transmitTime; //!< when it was handed to transmit()
+    };
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief one key of the target Datagram to set and its value
+     *
+     */
+    struct Translation
+    {
+        std::string targetKey;  //!< name of the key of the target Datagram
+        FieldId targetField;    //!< id of targetKey for m_targetType (FIELD_NONE: set by name)
+        DataExpression value;   //!< compiled value to set, evaluated against the source Datagram
+    };
+
+    bool passesGate(const Datagram & datagram) const;
+
+    void enqueue(const std::vector<std::shared_ptr<Datagram>> & datagrams,
+                 std::chrono::steady_clock::time_point transmitTime);
+
+    void notifyDelivery();
+
+    void drainQueue();
+
+    void countDelivery(size_t count, std::chrono::steady_clock::time_point transmitTime,
+                       std::chrono::steady_clock::time_point deliveryTime);
+
+    void resolveTargetFields();
 
 private:
+    std::string m_name;                                     //!< name of the Kable's section in the config file
     std::weak_ptr<PlagInterface> m_parent;                  //!< the source Plag (where Datagrams originate)
     std::weak_ptr<PlagInterface> m_target;                  //!< the target Plag (where Datagrams are meant to be delivered to)
     PlagType m_targetType;                                  //!< the type of the target Plag, to ensure, replacements fit
-    std::map<std::string, std::string> m_translationMap;    //!< map of values to set to target Plag keys
+    std::vector<Translation> m_translations;                //!< target Plag keys and the compiled values to set them to
+    std::shared_ptr<const GateCondition> m_gateCondition;   //!< only Datagrams passing this are translated (nullptr: all)
+    std::vector<std::shared_ptr<Datagram>> m_translatedBatch; //!< translations of the batch being transmitted
+    DeliveryMode m_deliveryMode;                            //!< whether to deliver on the source's turn or queued
+    boost::asio::strand<boost::asio::io_context::executor_type> m_strand; //!< serializes the deliveries from the queue
+    std::unique_ptr<MpscRingQueue<QueuedDatagram>> m_deliveryQueue; //!< translated Datagrams to deliver (async only)
+    std::vector<QueuedDatagram> m_drainBatch;               //!< Datagrams taken from m_deliveryQueue by drainQueue()
+    std::vector<std::shared_ptr<Datagram>> m_deliveryBatch; //!< Datagrams of m_drainBatch, as handed to the target
+    std::atomic<bool> m_drainPending;                       //!< whether a drain is already posted to m_strand
+    std::atomic<size_t> m_inDelivery;                       //!< Datagrams drainQueue() takes from m_deliveryQueue, until delivered
+    std::atomic<bool> m_sourceWaiting;                      //!< whether the backlog held the source back (see getRoomFor())
+    std::atomic<uint64_t> m_deliveredDatagrams;             //!< Datagrams placed at the target
+    std::atomic<uint64_t> m_droppedDatagrams;               //!< Datagrams dropped, as the delivery queue was full
+    std::atomic<uint64_t> m_totalLatency;                   //!< sum of the latencies of delivered Datagrams in µs
+    std::atomic<uint64_t> m_maxLatency;                     //!< highest latency of a delivered Datagram in µs
+    std::atomic<size_t> m_maxBacklog;                       //!< most Datagrams waiting in the delivery queue
+    std::shared_ptr<LatencyMetric> m_ingressToEgress;       //!< latencies from ingress at the source until egress at the target
 };
 
 #endif // KABLE_HPP
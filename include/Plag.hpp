@@ -23,15 +23,36 @@
 #define PLAG_HPP
 
 // std includes
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <exception>
-#include <thread>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
+// boost includes
+#include <boost/asio.hpp>
+
 // own includes
 #include "Kable.hpp"
+#include "Runtime.hpp"
 #include "utils/PlagInterface.hpp"
 #include "utils/PropertyTreeReader.hpp"
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief what a Plag does with a Datagram placed by a Kable, when its incoming queue is full
+ *
+ */
+enum QueuePolicy : uint8_t
+{
+    DROP_OLDEST,        //!< evict the oldest queued Datagram to make room
+    DROP_NEWEST,        //!< drop the placed Datagram
+    BLOCK_PRODUCER,     //!< hold back the distribution of the producing Plags, until there is room
+    COALESCE_BY_KEY     //!< keep only the latest Datagram per value of a key (e.g. per topic)
+};
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief The base class for the operations between protocol end-points and this program.
@@ -49,14 +70,17 @@
  * user-understandable, meaning a Plag'n internal, format. And vice versa, generate data the
  * end-point can interprete from Datagrams of the internal format.
  * Kables are left with the internal translation part and their description can be found there.
+ * The work of a Plag is done in turns, running on the Plag's strand of the shared Runtime. So a
+ * Plag does not need a thread of its own and is never worked on by two threads at once.
  *
  * @sa Kable::Kable()
+ * @sa Runtime::Runtime()
  *
  */
 class Plag : public PlagInterface, public PropertyTreeReader
 {
 public:
-    Plag(const boost::property_tree::ptree & propTree,
+    Plag(const boost::property_tree::ptree & propTree, Runtime & runtime,
          const std::string & name, const uint64_t & id, PlagType type = PlagType::none);
 
     virtual void readConfig();
@@ -71,26 +95,66 @@ public:
 
     virtual void stopWork();
 
-    virtual void loop(const bool & stopToken);
-
     virtual bool loopWork() = 0;
 
     virtual void placeDatagram(const std::shared_ptr<Datagram> datagram);
 
+    virtual size_t getRoomFor(size_t count, const std::weak_ptr<PlagInterface> & producer);
+
+    virtual void notify();
+
+    boost::asio::io_context & getIoContext();
+
+    boost::asio::strand<boost::asio::io_context::executor_type> & getStrand();
+
+    std::string getStatistics() const;
+
 protected:
+    virtual std::string getSpecificStatistics() const;
+
     void appendToDistribution(std::shared_ptr<Datagram> datagram);
+    void appendToIncoming(std::shared_ptr<Datagram> datagram);
+    size_t takeFromIncoming(std::vector<std::shared_ptr<Datagram>> & datagrams, size_t maxCount);
+
+    bool isBackpressured() const;
+    virtual void resumeIngress();
 
 private:
-    void distribute();
+    void turn();
+
+    void park();
+
+    bool distribute();
+
+    void coalesce(std::shared_ptr<Datagram> datagram);
+
+    size_t getIncomingRoom() const;
+
+    void wakeUpProducers();
 
 protected:
     std::string m_name;         //!< name (descriptive, needs to be unique)
     uint64_t m_plagId;          //!< id of the Plag (unique identifier)
-    std::thread m_workerThread; //!< thread to run the communications department (=main thread)
-    bool m_stopToken;           //!< central token to stop worker thread
+    std::atomic<bool> m_stopToken;              //!< central token to stop the worker (set until startWorker())
+    std::chrono::milliseconds m_maxIdleTime;    //!< longest time the idle worker parks without any event
+    size_t m_maxBatch;                          //!< most Datagrams to handle per queue and loop iteration
+    QueuePolicy m_queuePolicy;                  //!< what to do, when the incoming queue is full
+    std::string m_coalesceKey;                  //!< key of the Datagrams to coalesce by with COALESCE_BY_KEY
+    boost::asio::io_context & m_ioContext;      //!< event loop of the Runtime, all sockets register here
+    boost::asio::strand<boost::asio::io_context::executor_type> m_strand; //!< serializes the turns and handlers of this Plag
 
 private:
     std::vector<std::shared_ptr<Kable>> m_kables;   //!< all Kables connected to this Plag
+    std::vector<std::shared_ptr<Datagram>> m_distributionBatch; //!< Datagrams taken from m_outgoingDatagrams by distribute()
+    boost::asio::steady_timer m_idleTimer;          //!< wakes up the parked worker after m_maxIdleTime
+    std::atomic<bool> m_turnPending;                //!< whether a turn is already posted to m_strand
+    std::mutex m_mtxCoalesce;                       //!< guards the coalescing members below
+    std::unordered_map<std::string, std::shared_ptr<Datagram>> m_coalescedByKey; //!< latest incoming Datagram per key value
+    std::deque<std::string> m_coalesceOrder;        //!< key values of m_coalescedByKey in order of arrival
+    std::mutex m_mtxProducers;                      //!< guards m_waitingProducers
+    std::vector<std::weak_ptr<PlagInterface>> m_waitingProducers; //!< Plags held back by getRoomFor()
+    std::atomic<bool> m_producersWaiting;           //!< whether m_waitingProducers needs to be woken up
+    std::atomic<bool> m_distributionBlocked;        //!< whether a target held back distribute() last turn
 };
 
 #endif // PLAG_HPP
@@ -0,0 +1,77 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file Runtime.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the Runtime class
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef RUNTIME_HPP
+#define RUNTIME_HPP
+
+// std includes
+#include <thread>
+#include <vector>
+
+// boost includes
+#include <boost/asio.hpp>
+
+// own includes
+#include "utils/PropertyTreeReader.hpp"
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The Runtime class holds the one event loop all Plags and their transport layers run on,
+ * together with the pool of threads running it.
+ *
+ * @details Plags do not own a thread. Instead each Plag runs its work as a chain of handlers on a
+ * strand of the Runtime's io_context, hence the work of one Plag is never executed concurrently,
+ * while any number of Plags share the same few threads. The number of threads is configured in the
+ * section [runtime] by the key "threads" and defaults to the number of cores.
+ * Nothing run on these threads blocks: the HttpServer serves its requests and their Lua scripts,
+ * which wait for answers, on threads of its own.
+ *
+ * @sa Plag::notify()
+ */
+class Runtime : public PropertyTreeReader
+{
+public:
+    static const unsigned int MIN_THREAD_COUNT = 1; //!< lowest number of threads, see details above
+
+    Runtime(const boost::property_tree::ptree & propTree);
+    ~Runtime();
+
+    virtual void readConfig();
+
+    void start();
+
+    void stop();
+
+    boost::asio::io_context & getIoContext();
+
+    unsigned int getThreadCount() const;
+
+private:
+    void run();
+
+private:
+    unsigned int m_threadCount;                 //!< number of threads running m_ioContext
+    boost::asio::io_context m_ioContext;        //!< the event loop shared by all Plags
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_workGuard; //!< keeps m_ioContext from running out of work
+    std::vector<std::thread> m_threads;         //!< the threads running m_ioContext
+};
+
+#endif // RUNTIME_HPP
@@ -24,27 +24,77 @@
 
 // std includes
 #include <chrono>
+#include <memory>
 //#include <string> <- included via Utilities.hpp
 
 // own includes
+#include "LatencyMetric.hpp"
 #include "Utilities.hpp"
 
+typedef uint16_t FieldId; //!< compact id of a field of a Datagram, see Datagram::getFieldId()
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The Datagram class is the base of all messages passed between Plags
+ *
+ * @details Its values can be accessed by name via getData() and setData(), which is meant for Lua
+ * and for debugging. Where the same name is accessed for many Datagrams (e.g. by Kables), the name
+ * is resolved to a FieldId once via the static getFieldId() of the Datagram's class, and the value
+ * is accessed via getField() and setField() afterwards.
+ * Each class numbers its fields within its own block of ids, so that an id handed to a Datagram
+ * of another class fails, instead of accessing an unrelated value:
+ *      Datagram 0x01 - 0x0F, DatagramUdp 0x10 - 0x1F, DatagramMqtt 0x20 - 0x2F,
+ *      DatagramHttpServer 0x30 - 0x3F
+ * Classes holding fields of arbitrary names (DatagramMap) are accessed by name only.
+ */
 class Datagram
 {
 public:
+    enum Field : FieldId
+    {
+        FIELD_NONE = 0x00,              //!< no field of this name (access it by name then)
+        FIELD_UUID = 0x01,              //!< "uuid"
+        FIELD_SOURCE_DATAGRAM_ID,       //!< "sourceDatagramId"
+        FIELD_SOURCE_PLAG               //!< "sourcePlag"
+    };
+
     Datagram(const std::string & sourceName);
 
+    static FieldId getFieldId(const std::string & key);
+
     virtual DataType getData(const std::string & key) const;
 
     virtual void setData(const std::string & key, const DataType & value);
 
+    virtual DataType getField(FieldId field) const;
+
+    virtual void setField(FieldId field, const DataType & value);
+
     virtual std::string toString() const;
 
+    std::string getId() const;
+
+    const std::string & getSourcePlagName() const;
+
+    std::chrono::steady_clock::time_point getTimeOfIngress() const;
+
+    void setTimeOfIngress(std::chrono::steady_clock::time_point timeOfIngress);
+
+    void inheritIngress(const Datagram & sourceDatagram,
+                        const std::shared_ptr<LatencyMetric> & egressLatency);
+
+    void markEgress(std::chrono::steady_clock::time_point timeOfEgress) const;
+
+private:
+    static uint64_t generateSequenceNumber();
+
 private:
-    std::string m_ownId;                                                    //!< generated unique DatagramId
+    uint64_t m_ownSequenceNumber;                                           //!< unique number of this Datagram within this process
     std::string m_sourcePlagName;                                           //!< name of the Plag this Datagram originated from
     uint64_t m_sourceDatagramId;                                            //!< id of Datagram this was translated from (if new: 0)
     std::chrono::time_point<std::chrono::steady_clock> m_timeOfCreation;    //!< time this Datagram was created
+    std::chrono::time_point<std::chrono::steady_clock> m_timeOfIngress;     //!< time its data entered plag'n (e.g. kernel receive time of a packet)
+    std::shared_ptr<LatencyMetric> m_egressLatency;                         //!< where markEgress() records the latency since m_timeOfIngress (nullptr: nowhere)
 
 };
 
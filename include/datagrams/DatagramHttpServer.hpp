@@ -30,6 +30,11 @@
 class DatagramHttpServer : public DatagramMap
 {
 public:
+    enum HttpServerField : FieldId
+    {
+        FIELD_REQUEST_ID = 0x30 //!< "requestId"
+    };
+
     DatagramHttpServer(const std::string & sourcePlag);
     DatagramHttpServer(const std::string & sourcePlag,
                 std::string reqId, std::map<std::string, DataType> map);
@@ -38,10 +43,16 @@ public:
 
     void setReqId(std::string reqId);
 
+    static FieldId getFieldId(const std::string & key);
+
     virtual DataType getData(const std::string & key) const;
 
     virtual void setData(const std::string & key, const DataType & value);
 
+    virtual DataType getField(FieldId field) const;
+
+    virtual void setField(FieldId field, const DataType & value);
+
     virtual std::string toString() const;
 
 private:
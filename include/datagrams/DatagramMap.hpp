@@ -33,6 +33,8 @@ public:
     DatagramMap(const std::string & sourcePlag);
     DatagramMap(const std::string & sourcePlag, std::map<std::string, DataType> map);
 
+    static FieldId getFieldId(const std::string & key);
+
     virtual DataType getData(const std::string & key) const;
 
     virtual void setData(const std::string & key, const DataType & value);
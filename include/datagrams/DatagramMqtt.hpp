@@ -92,6 +92,16 @@ enum MqttPropertyType : uint8_t
 class DatagramMqtt : public Datagram
 {
 public:
+    enum MqttField : FieldId
+    {
+        FIELD_ACTION = 0x20,    //!< "action"
+        FIELD_TOPIC,            //!< "topic"
+        FIELD_CONTENT,          //!< "content"
+        FIELD_USER_INFO,        //!< "userInfo"
+        FIELD_QOS,              //!< "qos"
+        FIELD_RETAIN            //!< "retain"
+    };
+
     DatagramMqtt(const std::string & sourcePlag);
     DatagramMqtt(const std::string & sourcePlag, const std::string & action,
                  const std::string & topic, const std::string & content, uint8_t qos, bool retain);
@@ -103,10 +113,16 @@ public:
     unsigned int getQoS() const;
     bool getRetainFlag() const;
 
+    static FieldId getFieldId(const std::string & key);
+
     virtual DataType getData(const std::string & key) const;
 
     virtual void setData(const std::string & key, const DataType & value);
 
+    virtual DataType getField(FieldId field) const;
+
+    virtual void setField(FieldId field, const DataType & value);
+
     virtual std::string toString() const;
 
 
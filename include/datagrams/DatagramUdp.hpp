@@ -30,6 +30,14 @@
 class DatagramUdp : public Datagram
 {
 public:
+    enum UdpField : FieldId
+    {
+        FIELD_SENDER = 0x10,    //!< "sender"
+        FIELD_RECEIVER,         //!< "receiver"
+        FIELD_PORT,             //!< "port"
+        FIELD_PAYLOAD           //!< "payload"
+    };
+
     DatagramUdp(const std::string & sourcePlag);
     DatagramUdp(const std::string & sourcePlag, const std::string & sender,
                 unsigned int port, const std::string & payload);
@@ -39,10 +47,16 @@ public:
     unsigned int getPort() const;
     const std::string & getPayload() const;
 
+    static FieldId getFieldId(const std::string & key);
+
     virtual DataType getData(const std::string & key) const;
 
     virtual void setData(const std::string & key, const DataType & value);
 
+    virtual DataType getField(FieldId field) const;
+
+    virtual void setField(FieldId field, const DataType & value);
+
     virtual std::string toString() const;
 
 
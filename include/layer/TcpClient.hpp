@@ -23,26 +23,37 @@
 #define TCPCLIENT_HPP_
 
 // std includes
+#include <atomic>
+#include <mutex>
 
 // boost includes
 #include <boost/asio.hpp>
 
 // own includs
+#include "IoUring.hpp"
 #include "Plag.hpp"
 #include "TransportLayer.hpp"
 
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief Imlements a TCP client as an implementation of the TransportLayer interface using boost
+ * @details With the io_uring backend, a multishot receive into registered buffers replaces the
+ * async_receive, its completions are awaited via the eventfd of the io_uring, and transmit() sends
+ * via another io_uring. Connecting always uses boost.
+ * startConnect() connects without blocking: its completion handler only records the outcome and
+ * wakes up the parent, which completes the connection with its next call of isConnecting().
+ * All completion handlers run on the strand of the parent. Each socket gets the next number of
+ * m_connection, so completions of a socket closed by disconnect() are told apart and ignored.
  * @sa TransportLayer::TransportLayer
  */
 class TcpClient : public TransportLayer
 {
 public:
-    TcpClient(const std::chrono::milliseconds & timeout, const Plag & parent,
-              const std::string & serverIP, uint16_t port);
+    TcpClient(const std::chrono::milliseconds & timeout, Plag & parent,
+              const std::string & serverIP, uint16_t port, IoBackend ioBackend = ASIO_BACKEND);
 
-    virtual void connect(const std::chrono::milliseconds & timeout = std::chrono::milliseconds(1000));
+    virtual void startConnect(const std::chrono::milliseconds & timeout);
+    virtual bool isConnecting();
     virtual void disconnect();
     virtual bool isConnected();
 
@@ -55,19 +66,45 @@ public:
 
 private:
     // methods:
-    void handleBoostConnect(const boost::system::error_code & error);
+    void handleConnect(const boost::system::error_code & error, unsigned int connection);
     void initBoostReceive();
-    void handleBoostReceive(const boost::system::error_code & error, std::size_t n);
+    void handleBoostReceive(const boost::system::error_code & error, std::size_t n,
+                            unsigned int connection);
+#ifdef IORING_RECV_MULTISHOT
+    void initRingReceive();
+    void handleRingReceive(const boost::system::error_code & error,
+                           std::shared_ptr<IoUring> receiveRing,
+                           std::shared_ptr<boost::asio::posix::stream_descriptor> ringEvents,
+                           unsigned int connection);
+    void awaitRingCompletions(std::shared_ptr<IoUring> receiveRing,
+                              std::shared_ptr<boost::asio::posix::stream_descriptor> ringEvents,
+                              unsigned int connection);
+    void transmitWithRing(const std::string & appData);
+#endif
 
 private:
-    const Plag & m_parent;                                  //!< the parent Plag, holding this layer
+    Plag & m_parent;                                        //!< the parent Plag, holding this layer
     boost::asio::ip::tcp::endpoint m_endpoint;              //!< TCP/IP endpoint to connect to (IP and port)
-    boost::asio::io_context m_ioContext;                    //!< boost interface object for async operations
+    boost::asio::io_context & m_ioContext;                  //!< event loop of the Runtime for async operations
     std::unique_ptr<boost::asio::ip::tcp::socket> m_socket; //!< socket, representing an open connection
     std::string m_receiveBuffer;                            //!< buffer for this as interface to Plag
-    bool m_isConnected;                                     //!< state: is this connected to server
+    std::mutex m_mtxReceiveBuffer;                          //!< guards m_receiveBuffer against the receive handler
+    std::atomic<bool> m_isConnected;                        //!< state: is this connected to server
+    std::atomic<bool> m_isConnecting;                       //!< state: is an attempt of startConnect() going on
+    bool m_connectHandled;                                  //!< state: did the async connect operation return
+    unsigned int m_connection;                              //!< number of the current socket, handed to its completions
+    boost::system::error_code m_connectError;               //!< outcome of the async connect operation
+    std::chrono::steady_clock::time_point m_connectDeadline; //!< when the attempt of startConnect() is aborted
     static const size_t RECEIVE_BUFFER_SIZE = 1024;         //!< buffer size for async receiv operations
     char m_boostsReceiveBuffer[RECEIVE_BUFFER_SIZE];        //!< buffer for boost's async receive operations
+    IoBackend m_ioBackend;                                  //!< whether the socket is served by boost or io_uring
+#ifdef IORING_RECV_MULTISHOT
+    static const unsigned int RING_BUFFER_COUNT = 16;       //!< registered buffers of RECEIVE_BUFFER_SIZE for io_uring receives
+    std::shared_ptr<IoUring> m_receiveRing;                 //!< receives of m_socket (io_uring backend only)
+    std::unique_ptr<IoUring> m_sendRing;                    //!< sends of m_socket (io_uring backend only)
+    std::shared_ptr<boost::asio::posix::stream_descriptor> m_ringEvents; //!< eventfd of m_receiveRing, to wait on
+    bool m_ringArmed;                                       //!< whether the multishot receive of m_receiveRing is pending
+#endif
 };
 
 #endif /*TCPCLIENT_HPP_*/
\ No newline at end of file
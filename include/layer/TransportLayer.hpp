@@ -100,11 +100,21 @@ public:
 
     /**
      * ---------------------------------------------------------------------------------------------
-     * @brief connects the transport level to its counter point
-     * 
-     * @param timeout specific timeout for connection, will use defaultm when 0
+     * @brief starts to connect the transport level to its counter point, without waiting for it
+     *
+     * @param timeout time after which the attempt is deemed to have failed
+     * @sa TransportLayer::isConnecting()
+     */
+    virtual void startConnect(const std::chrono::milliseconds & timeout) = 0;
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief progress of the connection attempt started by startConnect()
+     *
+     * @return true while the attempt is still going on
+     * @return false once it is over (isConnected() tells the outcome), or if there is none
      */
-    virtual void connect(const std::chrono::milliseconds & timeout) = 0;
+    virtual bool isConnecting() = 0;
 
     /**
      * ---------------------------------------------------------------------------------------------
@@ -23,10 +23,15 @@
 #define PLAGHTTPSERVER_HPP
 
 // std includes
+#include <chrono>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <list>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 // lua includes
 #include <lua.hpp>
@@ -59,6 +64,8 @@ public:
     HttpResponse workingRequest(HttpRequest req);
     
 private:
+    HttpResponse runScript(HttpRequest & req);
+
     int sendDatagramInterface(lua_State * L); //!< function for sending a dgram from lua
     int resvDatagramInterface(lua_State * L); //!< function for resv a dgram to lua 
 
@@ -83,7 +90,7 @@ public:
 
     } endpoint;
 
-    PlagHttpServer(const boost::property_tree::ptree & propTree,
+    PlagHttpServer(const boost::property_tree::ptree & propTree, Runtime & runtime,
             const std::string & name, const uint64_t & id);
     ~PlagHttpServer();
 
@@ -98,17 +105,26 @@ public:
 protected:
     // interface for the Lua scripts to use datagrams
     int sendDatagram(std::shared_ptr<DatagramHttpServer> dgram);
-    std::shared_ptr<DatagramHttpServer> resvDatagram(const std::vector<std::string> & reqIds);
+    std::shared_ptr<DatagramHttpServer> resvDatagram(const std::vector<std::string> & reqIds,
+                                                     std::chrono::milliseconds timeout);
+    void closeRequests(const std::vector<std::string> & reqIds);
+
+private:
+    std::shared_ptr<DatagramHttpServer> takeAnswer(const std::vector<std::string> & reqIds);
 
 private:
     // config parameters
     uint16_t m_port;    //!< port the endpoint should bind to
+    unsigned int m_requestThreads;  //!< threads running the requests and their scripts
     std::list<endpoint> m_endpoints; //!< list of the configured endpoints
-    boost::asio::io_context m_ioContext; //!< io_context for the server
     std::shared_ptr<AsyncHttpServer<PlagHttpServerConnection>> m_tcpServer; //!< pointer that holds the TCP Server
-    std::shared_ptr<std::thread> m_ioContextThread; //!< thread for running the io context
+    std::unique_ptr<boost::asio::thread_pool> m_requestPool; //!< runs the requests, as their scripts block while waiting for answers
     std::mutex m_mtxSending; //!< mutex lock for the sending function
     std::mutex m_mtxRecv; //!< mutex lock for resv function 
+    std::unordered_set<std::string> m_openRequests; //!< reqIds sent by scripts, that still run (guarded by m_mtxRecv)
+    std::unordered_map<std::string, std::shared_ptr<DatagramHttpServer>> m_pendingResponses; //!< answers to m_openRequests by reqId, not yet picked up (guarded by m_mtxRecv)
+    std::condition_variable m_answerPlaced; //!< notified, when an answer was placed (with m_mtxRecv)
+    bool m_closing; //!< whether scripts waiting for answers are to give up (guarded by m_mtxRecv)
 
     // we need the class PlagHttpServerConnection have access to private 
     // members of this class. So make it friend
@@ -37,7 +37,7 @@
 class PlagMqtt : public Plag
 {
 public:
-    PlagMqtt(const boost::property_tree::ptree & propTree,
+    PlagMqtt(const boost::property_tree::ptree & propTree, Runtime & runtime,
             const std::string & name, const uint64_t & id);
     ~PlagMqtt();
 
@@ -49,6 +49,9 @@ public:
 
     virtual void placeDatagram(const std::shared_ptr<Datagram> datagram);
 
+protected:
+    virtual std::string getSpecificStatistics() const;
+
 private:
 
 private:
@@ -65,9 +68,18 @@ private:
     bool m_cleanSessions;               //!< whether or not to always start clean sessions
     unsigned int m_sessionExpire;       //!< when a session should expire (0 = on disconnect, UINT_MAX = never)
     std::vector<std::pair<std::string, uint8_t>> m_defaultSubscriptions; //!< default subscriptions, the pair is organized as <topicName, qos>
+    IoBackend m_ioBackend;              //!< whether the connection to the broker is served by boost::asio or io_uring
+    std::chrono::microseconds m_maxFlushDelay;  //!< longest time an outgoing MQTT packet waits to be written with others
+    size_t m_maxFlushSize;              //!< outgoing MQTT packets are written, as soon as they add up to this many bytes
+    uint16_t m_maxTopicAliases;         //!< most topic aliases to use with MQTT v5 (0: none)
+    uint16_t m_maxInflight;             //!< most QoS 1 and 2 PUBLISHes awaiting acknowledgement at a time
+    std::chrono::milliseconds m_retryInterval;  //!< time an unacknowledged packet waits to be resent
+    std::chrono::milliseconds m_minReconnectDelay;  //!< delay before the first reconnect attempt
+    std::chrono::milliseconds m_maxReconnectDelay;  //!< longest delay between reconnect attempts
 
     // worker members
     std::shared_ptr<MqttInterface> m_interface; //!< interface to MQTT
+    std::vector<std::shared_ptr<Datagram>> m_transmitBatch; //!< Datagrams taken from the incoming buffer by loopWork(), left over ones after a failure
 };
 
 #endif // PLAGMQTT_HPP
@@ -23,22 +23,45 @@
 #define PLAGUDP_HPP
 
 // std includes
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
 
 // boost includes
 #include <boost/asio.hpp>
 
 // own includes
+#include "DatagramUdp.hpp"
+#include "EndpointCache.hpp"
+#include "IoUring.hpp"
 #include "Plag.hpp"
 
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief The PlagUdp class is a Plag to both receive and send data via UDP
  * 
+ * @details Receiving is done by one or more shards, each being a socket bound to the same ip and
+ * port (SO_REUSEPORT) with its own receive handler running on its own strand. The kernel hands all
+ * packets of one sender to the same shard, so their order is kept. All shards put their Datagrams
+ * into the one outgoing buffer of this Plag, so Kables still see one Plag. Sending uses the socket
+ * of the first shard.
+ * With the io_uring backend, each shard keeps one multishot receive pending in its own io_uring,
+ * which the kernel completes into registered buffers; the strand of the shard waits on the
+ * eventfd of that io_uring. Sends are submitted to another io_uring with one system call per
+ * m_syscallBatch messages.
  */
 class PlagUdp : public Plag
 {
 public:
-    PlagUdp(const boost::property_tree::ptree & propTree,
+    PlagUdp(const boost::property_tree::ptree & propTree, Runtime & runtime,
             const std::string & name, const uint64_t & id);
     ~PlagUdp();
 
@@ -46,22 +69,152 @@ public:
 
     virtual void init();
 
+    virtual void startWorker();
+
     virtual bool loopWork();
 
     virtual void placeDatagram(const std::shared_ptr<Datagram> datagram);
 
 protected:
-    bool sendOneFromList();
+    virtual std::string getSpecificStatistics() const;
+    virtual void resumeIngress();
+
+    void openSocket(boost::asio::ip::udp::socket & socket);
+    void checkBufferSize(const std::string & optionName, int size, int granted);
+    bool sendFromList();
+    bool sendPrepared();
+    void sendSingle(size_t count);
+    void waitUntilWritable();
+
+#ifdef __linux__
+    void sendBatched(size_t count);
+    size_t prepareMessages(size_t first, size_t count);
+    size_t countSegments(size_t first, size_t count) const;
+#endif
+#ifdef IORING_RECV_MULTISHOT
+    void sendWithRing(size_t messages);
+    void awaitSendCompletions();
+    void handleSendCompletions(const boost::system::error_code & error);
+#endif
+
+private:
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief one socket receiving on m_ip and m_port, with its own strand and a pool of
+     * m_syscallBatch receive buffers of m_recvBufferSize bytes, allocated once in init(). The
+     * pending async_receive_from uses the first buffer, recvmmsg() all of them.
+     *
+     */
+    struct ReceiveShard
+    {
+        ReceiveShard(boost::asio::ip::udp::socket & shardSocket,
+                     const boost::asio::strand<boost::asio::io_context::executor_type> & shardStrand);
+
+        boost::asio::ip::udp::socket & socket;                  //!< socket of this shard
+        std::unique_ptr<boost::asio::ip::udp::socket> ownSocket; //!< socket, if not m_socket
+        boost::asio::strand<boost::asio::io_context::executor_type> strand; //!< serializes the receive handlers
+        boost::asio::ip::udp::endpoint senderEndPoint;          //!< sender of the packet of the pending async_receive_from
+        bool receiving;                                         //!< whether an async_receive_from is pending
+        std::vector<char> recvBuffers;                          //!< the receive buffers, one after the other
+        std::atomic<uint64_t> kernelDrops;                      //!< packets the kernel dropped for a full socket buffer (SO_RXQ_OVFL)
+#ifdef __linux__
+        std::vector<char> recvControls;                         //!< ancillary data of received packets
+        std::vector<boost::asio::ip::udp::endpoint> recvEndpoints; //!< senders of received packets
+        std::vector<iovec> recvVectors;                         //!< one iovec per receive buffer
+        std::vector<mmsghdr> recvHeaders;                       //!< headers handed to recvmmsg()
+#endif
+#ifdef IORING_RECV_MULTISHOT
+        std::unique_ptr<IoUring> ring;                          //!< receives of this shard (io_uring backend only)
+        std::unique_ptr<boost::asio::posix::stream_descriptor> ringEvents; //!< eventfd of ring, the strand waits on
+        msghdr ringHeader;                                      //!< room for name and ancillary data in the buffers of ring
+        bool ringArmed;                                         //!< whether the multishot receive of ring is pending
+#endif
+    };
+
+    void prepareShard(ReceiveShard & shard);
+    void startReceive(ReceiveShard & shard);
+    void handleReceive(ReceiveShard & shard, const boost::system::error_code & error,
+                       size_t length);
+    void appendReceived(const char * data, size_t length,
+                        const boost::asio::ip::udp::endpoint & sender,
+                        std::chrono::steady_clock::time_point timeOfIngress);
+    char * getReceiveBuffer(ReceiveShard & shard, size_t slot) const;
+
+#ifdef __linux__
+    size_t receiveBatched(ReceiveShard & shard);
+    void appendPacket(const char * data, size_t length,
+                      const boost::asio::ip::udp::endpoint & sender, size_t segmentSize,
+                      std::chrono::steady_clock::time_point timeOfIngress);
+    static std::chrono::steady_clock::time_point toTimeOfIngress(
+        const timespec & kernelTime, std::chrono::steady_clock::time_point steadyNow,
+        std::chrono::system_clock::time_point systemNow);
+    size_t readControlMessages(ReceiveShard & shard, msghdr & header, timespec & kernelTime);
+#endif
+#ifdef IORING_RECV_MULTISHOT
+    void prepareRing(ReceiveShard & shard);
+    void startRingReceive(ReceiveShard & shard);
+    void handleRingCompletions(ReceiveShard & shard, const boost::system::error_code & error);
+    void appendRingMessage(ReceiveShard & shard, uint16_t bufferId, size_t length,
+                           std::chrono::steady_clock::time_point steadyNow,
+                           std::chrono::system_clock::time_point systemNow);
+#endif
 
 private:
+    static constexpr size_t MAX_DATAGRAM_SIZE = 65507;  //!< largest payload of a UDP packet over IPv4
+    static constexpr size_t MAX_COALESCED_SIZE = 65536; //!< largest packet GRO coalesces
+    static constexpr size_t MAX_SEGMENTS = 64;          //!< most packets per segmented send (UDP_MAX_SEGMENTS)
+    static constexpr size_t MAX_SEGMENT_SIZE = 1472;    //!< largest payload to segment, fitting an Ethernet MTU
+#ifdef __linux__
+    //! room for the ancillary data of a received packet: drop count, GRO segment size and timestamp
+    static constexpr size_t RECEIVE_CONTROL_SIZE = CMSG_SPACE(sizeof(uint32_t))
+                                                   + CMSG_SPACE(sizeof(int))
+                                                   + CMSG_SPACE(sizeof(timespec));
+#endif
     // config parameters
     std::string m_ip;   //!< ip the endpoint should bind to
     uint16_t m_port;    //!< port the endpoint should bind to
+    size_t m_syscallBatch;  //!< packets per recvmmsg()/sendmmsg() call (1: one syscall per packet)
+    size_t m_shardCount;    //!< sockets receiving on m_ip and m_port
+    size_t m_maxDatagramSize;   //!< largest payload received, larger packets are dropped
+    bool m_gso;             //!< whether runs of equal payloads to one receiver are sent segmented (UDP_SEGMENT)
+    bool m_gro;             //!< whether the kernel may coalesce received packets (UDP_GRO), which are split again
+    bool m_timestamps;      //!< whether received packets are timed by the kernel (SO_TIMESTAMPNS)
+    IoBackend m_ioBackend;  //!< whether the sockets are served by boost::asio or io_uring
+    int m_rcvBuf;           //!< SO_RCVBUF of the socket in bytes (0: system default)
+    int m_sndBuf;           //!< SO_SNDBUF of the socket in bytes (0: system default)
+    size_t m_endpointCacheSize;         //!< most receivers m_endpointCache keeps
+    std::chrono::seconds m_resolveTtl;  //!< how long a resolved hostname of a receiver is used
+    std::chrono::seconds m_resolveFailureTtl;   //!< how long Datagrams to an unresolvable hostname are dropped
+    size_t m_maxHeldBack;               //!< most Datagrams to hold back for resolves (queueCapacity)
     // to correctly interprete the following members, see the boost documentation
-    boost::asio::io_context m_ioContext;            //!< member of boost necessity for ease of use
     boost::asio::ip::udp::socket m_socket;          //!< member of boost necessity for ease of use
-    boost::asio::ip::udp::resolver m_resolver;      //!< member of boost necessity for ease of use
+    std::unique_ptr<EndpointCache> m_endpointCache; //!< endpoints of the receivers, created in init()
     boost::asio::ip::udp::endpoint m_endPoint;      //!< member of boost necessity for ease of use
+    std::vector<std::unique_ptr<ReceiveShard>> m_shards; //!< receiving sockets, the first one using m_socket
+    size_t m_recvBufferSize;                            //!< size of each receive buffer of the shards
+    std::atomic<uint64_t> m_truncatedDatagrams;         //!< received packets larger than m_maxDatagramSize
+    std::vector<std::shared_ptr<Datagram>> m_sendBatch; //!< Datagrams taken from the incoming buffer by sendFromList()
+    std::deque<std::shared_ptr<Datagram>> m_heldBack;   //!< Datagrams waiting for the resolve of their receiver
+    size_t m_heldBackToRetry;                           //!< of m_heldBack, the ones (from the front) to look up again
+    std::vector<std::string> m_sendPayloads;                        //!< payloads of m_sendBatch
+    std::vector<boost::asio::ip::udp::endpoint> m_sendEndpoints;    //!< receivers of m_sendBatch
+    size_t m_sendCount;                                             //!< payloads in m_sendPayloads to send
+    size_t m_sentCount;                                             //!< of these, the ones sent already
+    bool m_waitingToSend;                                           //!< whether m_socket (or m_sendRing) is waited on to take more
+#ifdef __linux__
+    // preallocated once in init(), so that a batched syscall does not allocate
+    std::vector<iovec> m_sendVectors;                               //!< one iovec per sent payload
+    std::vector<mmsghdr> m_sendHeaders;                             //!< headers handed to sendmmsg()
+    std::vector<char> m_sendControls;                               //!< ancillary data of segmented messages
+    std::vector<size_t> m_sendSegments;                             //!< payloads per message in m_sendHeaders
+#endif
+#ifdef IORING_RECV_MULTISHOT
+    std::unique_ptr<IoUring> m_sendRing;                            //!< sends of m_socket (io_uring backend only)
+    std::unique_ptr<boost::asio::posix::stream_descriptor> m_sendRingEvents; //!< eventfd of m_sendRing, to wait on
+    size_t m_ringMessages;                                          //!< messages of m_sendHeaders submitted to m_sendRing
+    size_t m_ringCompleted;                                         //!< of these, the ones completed
+    int m_ringError;                                                //!< first error of their completions (0: none)
+#endif
 };
 
 #endif // PLAGUDP_HPP
@@ -22,33 +22,80 @@
 #ifndef MQTTCLIENT_HPP
 #define MQTTCLIENT_HPP
 
+// std includes
+#include <deque>
+#include <random>
+#include <unordered_set>
+
+// boost includes
+#include <boost/asio/steady_timer.hpp>
+
 // own includes
+#include "IoUring.hpp"
 #include "MqttInterface.hpp"
 #include "TransportLayer.hpp"
 
 class MqttClient : public MqttInterface
 {
 public:
-    MqttClient(const Plag & parent, const std::string & brokerIP, unsigned int brokerPort,
+    MqttClient(Plag & parent, const std::string & brokerIP, unsigned int brokerPort,
                  const std::string & clientId, uint8_t defaultQoS, const std::string & userName,
                  const std::string & userPass, unsigned int keepAliveInterval, bool cleanSessions,
                  const std::string & willTopic, const std::string willMessage,
                  const std::vector<std::pair<std::string, uint8_t>> & defaultSubscriptions,
                  uint8_t version = 4);
 
+    void setIoBackend(IoBackend ioBackend);
+    void setFlushLimits(std::chrono::microseconds maxFlushDelay, size_t maxFlushSize);
+    void setMaxInflight(uint16_t maxInflight);
+    void setRetryInterval(std::chrono::milliseconds retryInterval);
+    void setReconnectDelays(std::chrono::milliseconds minDelay, std::chrono::milliseconds maxDelay);
+
     virtual void init();
     virtual void poll();
-    virtual void transmitDatagram(std::shared_ptr<DatagramMqtt> datagram);
+    virtual bool transmitDatagram(std::shared_ptr<DatagramMqtt> datagram);
+    bool hasPendingPublishes() const;
 
     virtual void connect();
     virtual bool isConnected();
     virtual void disconnect();
 
+    // output buffer
+    void flushDueTransmissions();
+    void flushTransmissions();
+    uint64_t getQueuedPacketCount() const;
+    uint64_t getWriteCount() const;
+
 protected:
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief steps of the connect sequence driven by connect()
+     *
+     */
+    enum ConnectState : uint8_t
+    {
+        CONNECT_IDLE = 0,           //!< connected, or waiting for the next attempt
+        CONNECT_TCP,                //!< waiting for the TransportLayer to connect
+        CONNECT_AWAITING_CONNACK    //!< CONNECT sent, waiting for the CONNACK
+    };
+
     virtual std::string createConnectMessage() = 0;
 
+    // connect sequence
+    void completeConnect();
+    void scheduleReconnect(const std::string & reason);
+    void wakeUpAt(std::chrono::steady_clock::time_point timePoint);
+    void receiveFromTransportLayer();
+
     // transmitter (from client to broker)
     virtual void transmitPingReq();
+    void queueTransmission(const std::string & packet);
+
+    // inflight window
+    void setInflightWindow(uint16_t receiveMaximum);
+    void releaseInflight(uint16_t identifier);
+    void transmitPendingPublishes();
+    void publishDatagram(const std::shared_ptr<DatagramMqtt> & datagram);
 
     // helper methods
     virtual void resendOldData();
@@ -58,15 +105,37 @@ protected:
     uint8_t m_qualityOfService;         //!< default quality of service flag for MQTT
     std::string m_userName;             //!< the client username provided to the Broker
     std::string m_userPass;             //!< password associated with m_userName
-    unsigned int m_keepAliveInterval;   //!< keepaliveinterval in ms
+    unsigned int m_keepAliveInterval;   //!< keepaliveinterval in s
     bool m_cleanSessions;               //!< whether or not to always start clean sessions
     std::string m_willTopic;            //!< topic, the will message will be published under (testament topic)
     std::string m_willMessage;          //!< message to be broadcast as will (testament)
     std::vector<std::pair<std::string, uint8_t>> m_defaultSubscriptions;    //!< subscriptions to subscribe to by default
+    IoBackend m_ioBackend;              //!< what the TransportLayer serves its socket with
     // working members
     const uint8_t m_protocolVersion;    //!< version of the protocol this client implemented
     bool m_brokerConnected;             //!< connection state of client to MQTT broker
     std::string m_transportBuffer;      //!< current buffer from TransportLayer
+    std::chrono::microseconds m_maxFlushDelay;  //!< longest time a packet waits in m_outputBuffer
+    size_t m_maxFlushSize;              //!< m_outputBuffer is written, as soon as it holds this many bytes
+    std::string m_outputBuffer;         //!< packets waiting to be written to the TransportLayer in one go
+    std::chrono::steady_clock::time_point m_timeOfFirstQueued;  //!< when the oldest packet of m_outputBuffer was queued
+    boost::asio::steady_timer m_flushTimer; //!< wakes up parent, when m_outputBuffer is due to be written
+    uint64_t m_queuedPackets;           //!< number of packets queued for transmission
+    uint64_t m_writes;                  //!< number of writes to the TransportLayer
+    uint16_t m_maxInflight;             //!< most QoS 1 and 2 PUBLISHes to await acknowledgement for
+    uint16_t m_inflightWindow;          //!< m_maxInflight, lowered to the Receive Maximum of the broker
+    std::unordered_set<uint16_t> m_inflightPublishes;   //!< identifiers of QoS 1 and 2 PUBLISHes until their PUBACK or PUBCOMP
+    std::deque<std::shared_ptr<DatagramMqtt>> m_pendingPublishes; //!< PUBLISHes waiting for a free slot in the window
+    ConnectState m_connectState;        //!< current step of the connect sequence
+    std::chrono::milliseconds m_connectTimeout; //!< time the TCP connect and the CONNACK may take each
+    std::chrono::milliseconds m_minReconnectDelay;  //!< delay before the first reconnect attempt
+    std::chrono::milliseconds m_maxReconnectDelay;  //!< longest delay between reconnect attempts
+    unsigned int m_connectAttempts;     //!< failed attempts since the last connection, that held
+    std::chrono::steady_clock::time_point m_nextConnectAttempt; //!< earliest time of the next attempt
+    std::chrono::steady_clock::time_point m_connectDeadline;    //!< when the current step is deemed failed
+    std::chrono::steady_clock::time_point m_timeOfConnect;      //!< when the CONNACK accepted the connection
+    boost::asio::steady_timer m_connectTimer;   //!< wakes up parent for the next step of the connect sequence
+    std::minstd_rand m_random;          //!< source of the jitter of the reconnect delays
     std::unique_ptr<TransportLayer> m_transportLayer;   //!< connection interface
 };
 
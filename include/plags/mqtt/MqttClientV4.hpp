@@ -28,7 +28,7 @@
 class MqttClientV4 : public MqttClient
 {
 public:
-    MqttClientV4(const Plag & parent, const std::string & brokerIP, unsigned int brokerPort,
+    MqttClientV4(Plag & parent, const std::string & brokerIP, unsigned int brokerPort,
                  const std::string & clientId, uint8_t defaultQoS, const std::string & userName,
                  const std::string & userPass, unsigned int keepAliveInterval, bool cleanSessions,
                  const std::string & willTopic, const std::string willMessage,
@@ -37,22 +37,22 @@ public:
 protected:
     virtual std::string createConnectMessage();
 
-    virtual void parseConnect(const std::string & content);
-    virtual void parseConnAck(const std::string & content);
-    virtual void parseDisconnect(const std::string & content);
-    virtual void parsePublish(uint8_t firstByte, std::string & content);
-    virtual void parsePubAck(const std::string & content);
-    virtual void parsePubRec(const std::string & content);
-    virtual void parsePubRel(const std::string & content);
-    virtual void parsePubComp(const std::string & content);
-    virtual void parseSubAck(const std::string & content);
-    virtual void parseUnsubAck(const std::string & content);
-    virtual void parseAuth(const std::string & content);
+    virtual void parseConnect(std::string_view content);
+    virtual void parseConnAck(std::string_view content);
+    virtual void parseDisconnect(std::string_view content);
+    virtual void parsePublish(uint8_t firstByte, std::string_view content);
+    virtual void parsePubAck(std::string_view content);
+    virtual void parsePubRec(std::string_view content);
+    virtual void parsePubRel(std::string_view content);
+    virtual void parsePubComp(std::string_view content);
+    virtual void parseSubAck(std::string_view content);
+    virtual void parseUnsubAck(std::string_view content);
+    virtual void parseAuth(std::string_view content);
 
     // transmitter (from client to broker)
     virtual void transmitDisconnect();
     virtual void transmitAuth(bool reauthenticate);
-    virtual void transmitPublish(const std::string & topic, const std::string & content, uint8_t flags);
+    virtual uint16_t transmitPublish(const std::string & topic, const std::string & content, uint8_t flags);
     virtual void transmitPubAck(const std::string & identifier, char reasonCode = '\x00');
     virtual void transmitPubRec(const std::string & identifier, char reasonCode = '\x00');
     virtual void tranmitPubRel(const std::string & identifier, char reasonCode = '\x00');
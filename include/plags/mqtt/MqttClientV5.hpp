@@ -24,6 +24,7 @@
 
 // own includes
 #include "MqttClient.hpp"
+#include "MqttTopicAliases.hpp"
 
 enum MqttReasonCode: uint8_t
 {
@@ -75,15 +76,19 @@ enum MqttReasonCode: uint8_t
 class MqttClientV5 : public MqttClient
 {
 public:
-    MqttClientV5(const Plag & parent, const std::string & brokerIP, unsigned int brokerPort,
+    MqttClientV5(Plag & parent, const std::string & brokerIP, unsigned int brokerPort,
                  const std::string & clientId, uint8_t defaultQoS, const std::string & userName,
                  const std::string & userPass, unsigned int keepAliveInterval, bool cleanSessions,
                  const std::string & willTopic, const std::string willMessage,
                  const std::vector<std::pair<std::string, uint8_t>> & defaultSubscriptions);
 
+    void setMaxTopicAliases(uint16_t maxTopicAliases);
+
+    uint64_t getTopicAliasHits() const;
+
 protected:
     // mqtt string helper
-    std::map<MqttPropertyType, std::string> readProperties(const std::string & content) const;
+    std::map<MqttPropertyType, std::string> readProperties(std::string_view content) const;
     std::map<std::string,
              std::string> convertUserPropertiesToMap(const std::map<MqttPropertyType,
                                                                     std::string> & properties) const;
@@ -93,22 +98,22 @@ protected:
     virtual std::string createConnectMessage();
 
     // parser (from broker to client (this))
-    virtual void parseConnect(const std::string & content);
-    virtual void parseConnAck(const std::string & content);
-    virtual void parseDisconnect(const std::string & content);
-    virtual void parsePublish(uint8_t firstByte, std::string & content);
-    virtual void parsePubAck(const std::string & content);
-    virtual void parsePubRec(const std::string & content);
-    virtual void parsePubRel(const std::string & content);
-    virtual void parsePubComp(const std::string & content);
-    virtual void parseSubAck(const std::string & content);
-    virtual void parseUnsubAck(const std::string & content);
-    virtual void parseAuth(const std::string & content);
+    virtual void parseConnect(std::string_view content);
+    virtual void parseConnAck(std::string_view content);
+    virtual void parseDisconnect(std::string_view content);
+    virtual void parsePublish(uint8_t firstByte, std::string_view content);
+    virtual void parsePubAck(std::string_view content);
+    virtual void parsePubRec(std::string_view content);
+    virtual void parsePubRel(std::string_view content);
+    virtual void parsePubComp(std::string_view content);
+    virtual void parseSubAck(std::string_view content);
+    virtual void parseUnsubAck(std::string_view content);
+    virtual void parseAuth(std::string_view content);
 
     // transmitter (from client to broker)
     virtual void transmitDisconnect();
     virtual void transmitAuth(bool reauthenticate);
-    virtual void transmitPublish(const std::string & topic, const std::string & content, uint8_t flags);
+    virtual uint16_t transmitPublish(const std::string & topic, const std::string & content, uint8_t flags);
     virtual void transmitPubAck(const std::string & identifier, char reasonCode = '\x00');
     virtual void transmitPubRec(const std::string & identifier, char reasonCode = '\x00');
     virtual void tranmitPubRel(const std::string & identifier, char reasonCode = '\x00');
@@ -123,6 +128,8 @@ protected:
     unsigned int m_sessionExpire;       //!< when a session should expire (0 = on disconnect, UINT_MAX = never)
     bool m_willIsText;                      //!< whether will is text or number
     unsigned int m_willDelay;               //!< delay before the will message will be sent; default 0
+    uint16_t m_maxTopicAliases;             //!< most topic aliases to use, if the broker allows that many
+    MqttTopicAliases m_topicAliases;        //!< topic aliases of the current connection
 };
 
 #endif /*MQTTCLIENTV5_HPP*/
\ No newline at end of file
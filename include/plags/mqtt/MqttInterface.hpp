@@ -24,10 +24,14 @@
 
 // std includes
 #include <list>
+#include <string_view>
+#include <vector>
 
 // own includes
 #include "DatagramMqtt.hpp"
+#include "IdentifierBitmap.hpp"
 #include "Plag.hpp"
+#include "TimingWheel.hpp"
 
 /**
  *-------------------------------------------------------------------------------------------------
@@ -37,13 +41,13 @@
 class MqttInterface
 {
 public:
-    MqttInterface(const Plag & parent, const std::string & brokerIP,
+    MqttInterface(Plag & parent, const std::string & brokerIP,
                   unsigned int brokerPort);
 
     virtual void init() = 0;
     virtual void poll() = 0;
 
-    virtual void transmitDatagram(const std::shared_ptr<DatagramMqtt> datagram) = 0;
+    virtual bool transmitDatagram(const std::shared_ptr<DatagramMqtt> datagram) = 0;
     virtual bool hasMessages();
     virtual std::shared_ptr<DatagramMqtt> getMessage();
 
@@ -51,38 +55,45 @@ protected:
     // mqtt string helper
     virtual std::string makeMqttString(const std::string & text) const;
     virtual std::string extractMqttString(std::string & text, size_t startPos = 0) const;
+    virtual std::string_view readMqttString(std::string_view data, size_t & pos) const;
     virtual std::string makeMqttVarInt(unsigned int value) const;
-    virtual unsigned int readMqttVarInt(const std::string & data, uint8_t & offset,
+    virtual unsigned int readMqttVarInt(std::string_view data, uint8_t & offset,
                                         size_t startPos = 0) const;
+    static bool decodeMqttVarInt(std::string_view data, size_t startPos, unsigned int & value,
+                                 uint8_t & length);
+    virtual uint16_t readMqttIdentifier(std::string_view data, size_t startPos = 0) const;
     // datagram generation convenience stuff
     virtual void prepareFixedHeader(MqttMessageType type, uint8_t flags,
                                     std::string & content) const;
 
     // parser (from broker to client (this))
     virtual std::size_t parseIncomingBuffer(std::string & inBuffer);
+    virtual void dispatchPacket(uint8_t firstByte, std::string_view content);
 
     // general helper
     uint16_t generateIdentifier();
     void addNonAcknowledgedData(uint16_t identifier, const std::string & data);
     void removeNonAcknowledgedData(uint16_t identifier);
+    bool isNonAcknowledged(uint16_t identifier) const;
+    void collectNonAcknowledged(std::vector<uint64_t> & identifiers) const;
 
     // parser (all abstract)
-    virtual void parseConnect(const std::string & content) = 0;
-    virtual void parseConnAck(const std::string & content) = 0;
-    virtual void parseDisconnect(const std::string & content) = 0;
-    virtual void parsePublish(uint8_t firstByte, std::string & content) = 0;
-    virtual void parsePubAck(const std::string & content) = 0;
-    virtual void parsePubRec(const std::string & content) = 0;
-    virtual void parsePubRel(const std::string & content) = 0;
-    virtual void parsePubComp(const std::string & content) = 0;
-    virtual void parseSubAck(const std::string & content) = 0;
-    virtual void parseUnsubAck(const std::string & content) = 0;
-    virtual void parseAuth(const std::string & content) = 0;
+    virtual void parseConnect(std::string_view content) = 0;
+    virtual void parseConnAck(std::string_view content) = 0;
+    virtual void parseDisconnect(std::string_view content) = 0;
+    virtual void parsePublish(uint8_t firstByte, std::string_view content) = 0;
+    virtual void parsePubAck(std::string_view content) = 0;
+    virtual void parsePubRec(std::string_view content) = 0;
+    virtual void parsePubRel(std::string_view content) = 0;
+    virtual void parsePubComp(std::string_view content) = 0;
+    virtual void parseSubAck(std::string_view content) = 0;
+    virtual void parseUnsubAck(std::string_view content) = 0;
+    virtual void parseAuth(std::string_view content) = 0;
 
     // transmitter (all abstract)
     virtual void transmitDisconnect() = 0;
     virtual void transmitAuth(bool reauthenticate) = 0;
-    virtual void transmitPublish(const std::string & topic, const std::string & content, uint8_t flags) = 0;
+    virtual uint16_t transmitPublish(const std::string & topic, const std::string & content, uint8_t flags) = 0;
     virtual void transmitPubAck(const std::string & identifier, char reasonCode = '\x00') = 0;
     virtual void transmitPubRec(const std::string & identifier, char reasonCode = '\x00') = 0;
     virtual void tranmitPubRel(const std::string & identifier, char reasonCode = '\x00') = 0;
@@ -92,14 +103,19 @@ protected:
     virtual void transmitPingReq() = 0;
 
 protected:
-    const Plag & m_parent;                                          //!< reference to parent plag
+    Plag & m_parent;                                                //!< reference to parent plag
     std::string m_brokerIP;                                         //!< ip for the broker service
     unsigned int m_brokerPort;                                      //!< port to use with the broker service
     uint16_t m_currentIdentifier;                                   //!< packet identifier
     std::list<std::shared_ptr<DatagramMqtt>> m_incomingBuffer;      //!< buffer of parsed but not yet forwarded telegrams
     std::chrono::steady_clock::time_point m_lastTimeOfSent;         //!< indicator of last time this sent stuff to broker
     std::chrono::steady_clock::time_point m_lastTimeReceived;       //!< indicator of last time this received from broker
-    std::map<uint16_t, std::pair<std::string, std::chrono::steady_clock::time_point>> m_nonAckedData; //!< data transmitted but not yet acknowledged by broker
+    std::vector<std::string> m_nonAckedData;                        //!< data transmitted but not yet acknowledged by broker, indexed by identifier
+    IdentifierBitmap m_usedIdentifiers;                             //!< identifiers, whose packet m_nonAckedData holds
+    IdentifierBitmap m_receivedQoS2;                                //!< identifiers of QoS 2 PUBLISHes of the broker, until their PUBREL
+    std::chrono::milliseconds m_retryInterval;                      //!< time to wait for an acknowledgement, before resending
+    TimingWheel m_retransmitWheel;                                  //!< identifiers in m_nonAckedData by time of their next resend
+    std::vector<uint64_t> m_dueIdentifiers;                         //!< reused buffer for identifiers, whose resend is due
 };
 
 #endif /*MQTTINTERFACE_HPP*/
\ No newline at end of file
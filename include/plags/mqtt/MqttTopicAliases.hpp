@@ -0,0 +1,75 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file MqttTopicAliases.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the MqttTopicAliases class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef MQTTTOPICALIASES_HPP
+#define MQTTTOPICALIASES_HPP
+
+// std includes
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The MqttTopicAliases class assigns MQTT v5 topic aliases to the topics a client
+ * publishes to, so that repeated PUBLISHes carry a two byte alias instead of the topic
+ *
+ * @details The broker announces in its CONNACK, how many aliases it accepts (TOPIC_ALIAS_MAX).
+ * Aliases are only valid for one connection, so the table is reset with every CONNACK. Until all
+ * aliases are taken, each new topic gets the next one. Afterwards the alias of the least recently
+ * published topic is reassigned. The first PUBLISH with an alias carries the topic as well, which
+ * establishes (or reassigns) the alias at the broker; later ones may leave the topic empty.
+ * Not thread-safe; used by the worker of the PlagMqtt only.
+ */
+class MqttTopicAliases
+{
+public:
+    MqttTopicAliases();
+
+    void reset(uint16_t maximum);
+
+    bool lookUp(const std::string & topic, uint16_t & alias);
+
+    uint16_t getMaximum() const;
+
+    uint64_t getHits() const;
+
+private:
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief one topic with its alias
+     *
+     */
+    struct Entry
+    {
+        std::string topic;  //!< the topic published to
+        uint16_t alias;     //!< alias of topic at the broker (1 ... m_maximum)
+    };
+
+private:
+    uint16_t m_maximum;                             //!< most aliases to use (0: none)
+    std::list<Entry> m_entries;                     //!< entries, most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index; //!< entries by topic
+    uint64_t m_hits;                                //!< PUBLISHes, that could leave out the topic
+};
+
+#endif // MQTTTOPICALIASES_HPP
@@ -120,8 +120,9 @@ template <class T>
 class AsyncHttpServer: public AsyncTcpServer<T>
 {
 public:
-    AsyncHttpServer(boost::asio::io_context & ioContext, Plag * ptrParentPlag, uint16_t port = 80):
-        AsyncTcpServer<T>(ioContext, port, ptrParentPlag)
+    AsyncHttpServer(boost::asio::io_context & ioContext, Plag * ptrParentPlag,
+                    boost::asio::any_io_executor connectionExecutor, uint16_t port = 80):
+        AsyncTcpServer<T>(ioContext, port, ptrParentPlag, connectionExecutor)
     {
     }
 };
@@ -59,7 +59,8 @@ private:
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief The AsyncTcpServer class Handles the connections from a client async
- *
+ * @details Connections are accepted on the io_context, but started on the executor given, as they
+ * may read, work and write blocking.
  */
 template<class T>
 class AsyncTcpServer
@@ -72,11 +73,14 @@ public:
     * @param io_context the boost::io_context
     * @param port port number of the server
     * @param ptrParentPlag ptr to the parent plag
+    * @param connectionExecutor executor the connections are started on, as they may block
     */
-    AsyncTcpServer(boost::asio::io_context & ioContext, uint16_t port, Plag * ptrParentPlag)
+    AsyncTcpServer(boost::asio::io_context & ioContext, uint16_t port, Plag * ptrParentPlag,
+                   boost::asio::any_io_executor connectionExecutor)
         : m_acceptor(ioContext, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port)),
         m_ioContext(ioContext),
-        m_ptrParentPlag(ptrParentPlag)
+        m_ptrParentPlag(ptrParentPlag),
+        m_connectionExecutor(connectionExecutor)
     {
         startAccept();
     }
@@ -91,7 +95,7 @@ public:
     {
         if (!err)
         {
-            connection->start();
+            boost::asio::post(m_connectionExecutor, [connection]() { connection->start(); });
         }
         startAccept();
     }
@@ -116,6 +120,7 @@ protected:
     boost::asio::ip::tcp::acceptor m_acceptor; //!< acceptor for the incoming connections
     boost::asio::io_context & m_ioContext; //!< io_service for the server
     Plag * m_ptrParentPlag; //!< ptr to the parent plug of this server
+    boost::asio::any_io_executor m_connectionExecutor; //!< runs the connections
 };
 
 #endif /*ASYNCTCPSERVER_HPP_*/
\ No newline at end of file
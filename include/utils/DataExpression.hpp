@@ -0,0 +1,81 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file DataExpression.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the DataExpression class
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef DATAEXPRESSION_HPP
+#define DATAEXPRESSION_HPP
+
+// std includes
+#include <memory>
+#include <string>
+
+// own includes
+#include "Datagram.hpp"
+#include "PlagInterface.hpp"
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The DataExpression class is the compiled form of a value in a Kable section, e.g.
+ * `"literal"`, `42`, `payload` or `SPLIT(payload,;).2`
+ *
+ * @details The text of the expression is parsed once, when it is constructed. Evaluating it
+ * against a Datagram then only walks the resulting tree: literals are returned as they are, keys
+ * are read and SPLITs split the value of their inner expression.
+ * If the type of the Plag, the Datagrams come from, is known, keys are resolved to FieldIds at
+ * construction and read via Datagram::getField(). Else they are read via Datagram::getData().
+ * Datagram::getData() still understands the same syntax, but parses it on every call.
+ */
+class DataExpression
+{
+public:
+    enum ExpressionType : uint8_t
+    {
+        LITERAL = 0,    //!< a quoted string or a number, that is used as it is
+        KEY,            //!< the name of a value in the Datagram
+        SPLIT           //!< SPLIT(inner,separators) or SPLIT(inner,separators).index
+    };
+
+    explicit DataExpression(const std::string & expression, PlagType sourceType = PlagType::none);
+
+    static FieldId lookUpFieldId(PlagType plagType, const std::string & key);
+
+    DataType evaluate(const Datagram & datagram) const;
+
+    ExpressionType getType() const;
+
+    const std::string & getText() const;
+
+    const DataType & getLiteral() const;
+
+private:
+    void parseSplit(PlagType sourceType);
+
+private:
+    ExpressionType m_type;                          //!< what kind of expression this is
+    std::string m_text;                             //!< the expression as configured
+    DataType m_literal;                             //!< value of a LITERAL
+    std::string m_key;                              //!< name of the value of a KEY
+    FieldId m_field;                                //!< id of m_key, if it could be resolved
+    std::shared_ptr<const DataExpression> m_inner;  //!< the expression a SPLIT splits the value of
+    std::string m_separators;                       //!< any of these characters splits with SPLIT
+    size_t m_index;                                 //!< 1-based index of the part SPLIT returns (0: all)
+};
+
+#endif // DATAEXPRESSION_HPP
@@ -0,0 +1,111 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file EndpointCache.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the EndpointCache class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+
+#ifndef ENDPOINTCACHE_HPP
+#define ENDPOINTCACHE_HPP
+
+// std includes
+#include <chrono>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// boost includes
+#include <boost/asio.hpp>
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The EndpointCache class maps the receiver and port of outgoing Datagrams to UDP endpoints,
+ * so that they are not parsed or resolved for every packet
+ *
+ * @details Up to a capacity of entries are kept, evicting the least recently used one. IP addresses
+ * are parsed once and kept until evicted. Hostnames are resolved asynchronously on the strand, so
+ * that no lookup blocks: a new hostname is RESOLVING, until the result arrives and the handler
+ * given to the constructor is called. A resolved hostname is re-resolved after a time to live,
+ * keeping the known endpoint until the result replaces it. A hostname, that cannot be resolved,
+ * is UNRESOLVABLE for a shorter time to live, before it is tried again.
+ * Not thread-safe; lookups and the completion of resolves run on the same strand.
+ */
+class EndpointCache
+{
+public:
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief what a lookup found
+     *
+     */
+    enum Resolution
+    {
+        RESOLVED,       //!< the endpoint is known
+        RESOLVING,      //!< a new hostname is being resolved, the Datagram has to wait for it
+        UNRESOLVABLE    //!< the hostname could not be resolved lately, the Datagram is to be dropped
+    };
+
+    EndpointCache(boost::asio::strand<boost::asio::io_context::executor_type> & strand,
+                  size_t capacity, std::chrono::seconds timeToLive,
+                  std::chrono::seconds failureTimeToLive, std::function<void()> onResolved);
+
+    Resolution lookUp(const std::string & receiver, uint16_t port,
+                      boost::asio::ip::udp::endpoint & endpoint);
+
+    uint64_t getHits() const;
+
+    uint64_t getMisses() const;
+
+private:
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief one cached endpoint
+     *
+     */
+    struct Entry
+    {
+        std::string key;                                //!< receiver and port, see makeKey()
+        std::string host;                               //!< receiver as looked up
+        uint16_t port;                                  //!< port as looked up
+        boost::asio::ip::udp::endpoint endpoint;        //!< where to send to (if RESOLVED)
+        Resolution resolution;                          //!< whether endpoint is known
+        bool isHostname;                                //!< whether host needs to be resolved
+        bool resolving;                                 //!< whether a resolve is pending
+        std::chrono::steady_clock::time_point expiry;   //!< when to (re-)resolve a hostname
+    };
+
+    void makeKey(const std::string & receiver, uint16_t port);
+    Entry & insert(const std::string & receiver, uint16_t port);
+    void startResolve(Entry & entry);
+
+private:
+    boost::asio::strand<boost::asio::io_context::executor_type> & m_strand; //!< strand of lookups
+    boost::asio::ip::udp::resolver m_resolver;      //!< resolves hostnames
+    size_t m_capacity;                              //!< most entries to keep
+    std::chrono::seconds m_timeToLive;              //!< how long a resolved hostname is used
+    std::chrono::seconds m_failureTimeToLive;       //!< how long an unresolvable hostname is not tried
+    std::function<void()> m_onResolved;             //!< called on the strand, when a resolve completed
+    std::list<Entry> m_entries;                     //!< entries, most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index; //!< entries by key
+    std::string m_key;                              //!< key of the current lookup, reused
+    uint64_t m_hits;                                //!< lookups answered by an entry
+    uint64_t m_misses;                              //!< lookups that needed a new entry
+};
+
+#endif // ENDPOINTCACHE_HPP
@@ -0,0 +1,132 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file GateCondition.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the GateCondition class
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef GATECONDITION_HPP
+#define GATECONDITION_HPP
+
+// std includes
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+// own includes
+#include "DataExpression.hpp"
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The GateCondition class is the compiled form of the gateCondition of a Kable. Only
+ * Datagrams it is true for pass the Kable.
+ *
+ * @details A condition is made of operands (anything a DataExpression understands, or a number)
+ * and these operations, from strongest to weakest binding:
+ *      - `PREFIX(a,b)` a starts with b, `MATCH(a,"regex")` a contains a match of the regex,
+ *        `RANGE(a,low,high)` low <= a <= high (low and high are numbers)
+ *      - `a == b`, `a != b`, `a < b`, `a <= b`, `a > b`, `a >= b` and a sole `a` (a is true)
+ *      - `!condition` and `(condition)`
+ *      - `condition && condition`
+ *      - `condition || condition`
+ * Comparisons are numeric, if one operand is a number (e.g. `port > 1000`) or both values are
+ * numbers. A value, that is no number, fails a numeric comparison. All other comparisons compare
+ * strings. The condition is parsed once, when constructed; evaluating it does not allocate, apart
+ * from reading the values of the Datagram.
+ */
+class GateCondition
+{
+public:
+    explicit GateCondition(const std::string & condition, PlagType sourceType = PlagType::none);
+
+    bool evaluate(const Datagram & datagram) const;
+
+    const std::string & getText() const;
+
+private:
+    enum Operation : uint8_t
+    {
+        AND = 0,        //!< all children are true
+        OR,             //!< any child is true
+        NOT,            //!< the only child is false
+        EQUAL,          //!< operands are equal
+        NOT_EQUAL,      //!< operands are not equal
+        LESS,           //!< first operand is less than the second
+        LESS_EQUAL,     //!< first operand is less than or equal to the second
+        GREATER,        //!< first operand is greater than the second
+        GREATER_EQUAL,  //!< first operand is greater than or equal to the second
+        PREFIX,         //!< first operand starts with the second
+        MATCH,          //!< first operand contains a match of pattern
+        RANGE,          //!< first operand is within [lowerBound, upperBound]
+        TRUTHY          //!< the only operand converts to true
+    };
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief one side of a comparison or argument of a function
+     *
+     */
+    struct Operand
+    {
+        std::shared_ptr<const DataExpression> expression;   //!< how to get the value (nullptr: number)
+        DataType constant;                                  //!< value of numbers and literals
+        bool isConstant;                                    //!< whether the value is constant
+        bool isNumber;                                      //!< whether this is a number
+    };
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief one operation of the compiled condition
+     *
+     */
+    struct Node
+    {
+        Operation operation;                        //!< what this node does
+        std::vector<Node> children;                 //!< sub conditions of AND, OR and NOT
+        std::vector<Operand> operands;              //!< operands of comparisons and functions
+        double lowerBound;                          //!< lowest value passing a RANGE
+        double upperBound;                          //!< highest value passing a RANGE
+        std::shared_ptr<const std::regex> pattern;  //!< regular expression of a MATCH
+    };
+
+    Node parseOr(size_t & pos) const;
+    Node parseAnd(size_t & pos) const;
+    Node parseUnary(size_t & pos) const;
+    Node parseFunction(size_t & pos, Operation operation, size_t nameLength) const;
+    Node parseComparison(size_t & pos) const;
+    Operand parseOperand(size_t & pos) const;
+
+    void skipSpaces(size_t & pos) const;
+    bool consume(size_t & pos, const std::string & token) const;
+
+    bool evaluateNode(const Node & node, const Datagram & datagram) const;
+    bool compare(const Node & node, const Datagram & datagram) const;
+
+    static const DataType & getValue(const Operand & operand, const Datagram & datagram,
+                                     DataType & storage);
+    static const std::string & toText(const DataType & value, std::string & storage);
+    static bool toNumber(const DataType & value, double & number);
+    static bool parseNumber(const std::string & text, double & number);
+
+private:
+    std::string m_text;     //!< the condition as configured
+    PlagType m_sourceType;  //!< type of the Plag, the evaluated Datagrams come from
+    Node m_root;            //!< the compiled condition
+};
+
+#endif // GATECONDITION_HPP
@@ -0,0 +1,58 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file IdentifierBitmap.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the IdentifierBitmap class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef IDENTIFIERBITMAP_HPP
+#define IDENTIFIERBITMAP_HPP
+
+// std includes
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The IdentifierBitmap class keeps track of the used 16 bit packet identifiers with one bit
+ * per identifier
+ *
+ * @details A free identifier is found 64 identifiers at a time, by counting the trailing zeros of
+ * the inverted word. The identifier 0 is not allowed, so it is always marked as used, but neither
+ * tested nor collected as such. Not thread-safe.
+ */
+class IdentifierBitmap
+{
+public:
+    IdentifierBitmap();
+
+    uint16_t findFreeAfter(uint16_t identifier) const;
+
+    void markUsed(uint16_t identifier);
+
+    void markFree(uint16_t identifier);
+
+    bool isUsed(uint16_t identifier) const;
+
+    void collectUsed(std::vector<uint64_t> & identifiers) const;
+
+private:
+    std::array<uint64_t, 1024> m_words;     //!< bit per identifier, set while it is used (and for 0)
+};
+
+#endif // IDENTIFIERBITMAP_HPP
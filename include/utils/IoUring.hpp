@@ -0,0 +1,181 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file IoUring.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the IoUring class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef IOURING_HPP
+#define IOURING_HPP
+
+// std includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief which implementation a Plag uses for the I/O on its sockets
+ *
+ */
+enum IoBackend : uint8_t
+{
+    ASIO_BACKEND,       //!< boost::asio (epoll on Linux), available everywhere
+    IO_URING_BACKEND    //!< io_uring with multishot receives into registered buffers (Linux >= 6.0)
+};
+
+// multishot receives came with Linux 6.0, after the provided buffer rings they need
+#ifdef IORING_RECV_MULTISHOT
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The IoUring class is a minimal io_uring instance, talking to the kernel via its system
+ * calls directly (no liburing needed)
+ *
+ * @details Operations are prepared into the submission queue and handed to the kernel with one
+ * submit(), which may also wait for their completions. Receives are multishot: one submission
+ * keeps receiving into buffers of a ring registered with the kernel (registerBuffers()), that are
+ * handed back with recycleBuffer(), once their data is taken. Completions are taken with
+ * reapCompletions(). With openEventFd(), the kernel signals completions on an eventfd, so that
+ * boost::asio can wait for them.
+ * Not thread-safe: each instance is meant to be used from one strand, so a socket receiving and
+ * sending from different strands uses one instance for each.
+ */
+class IoUring
+{
+public:
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief a message received by a multishot recvmsg, as laid out in its buffer by the kernel
+     *
+     */
+    struct ReceivedMessage
+    {
+        const char * name;      //!< address of the sender
+        size_t nameLength;      //!< size of name
+        char * control;         //!< ancillary data
+        size_t controlLength;   //!< size of control
+        const char * payload;   //!< the received data
+        size_t payloadLength;   //!< size of payload, as far as it fits into the buffer
+        bool truncated;         //!< whether the data did not fit into the buffer
+    };
+
+    static constexpr uint16_t BUFFER_GROUP = 0; //!< id of the registered buffer ring
+
+    explicit IoUring(unsigned int entries);
+    ~IoUring();
+
+    IoUring(const IoUring &) = delete;
+    IoUring & operator=(const IoUring &) = delete;
+
+    static bool isSupported();
+
+    void registerBuffers(unsigned int count, size_t size);
+    char * getBuffer(uint16_t bufferId);
+    void recycleBuffer(uint16_t bufferId);
+
+    int openEventFd();
+    void clearEventFd();
+
+    bool prepareReceiveMessages(int fd, msghdr * header, uint64_t userData);
+    bool prepareReceive(int fd, uint64_t userData);
+    bool prepareSendMessage(int fd, const msghdr * header, uint64_t userData);
+    bool prepareSend(int fd, const void * data, size_t length, uint64_t userData);
+
+    unsigned int submit(unsigned int waitFor = 0);
+
+    template <typename Handler>
+    size_t reapCompletions(Handler && handler);
+
+    static bool parseMessage(char * buffer, size_t length, const msghdr & header,
+                             ReceivedMessage & message);
+
+private:
+    void release();
+    io_uring_sqe * nextSqe(uint8_t opcode, int fd);
+    bool flushOverflow();
+    int enter(unsigned int toSubmit, unsigned int waitFor, unsigned int flags);
+
+private:
+    int m_ringFd;                       //!< file descriptor of the io_uring
+    int m_eventFd;                      //!< eventfd the kernel signals completions on (-1: none)
+    void * m_sqRing;                    //!< mapped submission queue ring
+    size_t m_sqRingSize;                //!< size of m_sqRing
+    void * m_cqRing;                    //!< mapped completion queue ring (may be m_sqRing)
+    size_t m_cqRingSize;                //!< size of m_cqRing
+    io_uring_sqe * m_sqes;              //!< mapped array of submission queue entries
+    size_t m_sqesSize;                  //!< size of m_sqes
+    unsigned int * m_sqHead;            //!< head of the submission queue, moved by the kernel
+    unsigned int * m_sqTail;            //!< tail of the submission queue, moved by submit()
+    unsigned int * m_sqFlags;           //!< flags of the submission queue, e.g. of a CQ overflow
+    unsigned int * m_sqArray;           //!< indices of m_sqes to submit
+    unsigned int m_sqMask;              //!< mask of the indices of the submission queue
+    unsigned int m_sqEntries;           //!< size of the submission queue
+    unsigned int m_sqPrepared;          //!< tail including the prepared, not yet submitted entries
+    unsigned int * m_cqHead;            //!< head of the completion queue, moved by reapCompletions()
+    unsigned int * m_cqTail;            //!< tail of the completion queue, moved by the kernel
+    unsigned int m_cqMask;              //!< mask of the indices of the completion queue
+    io_uring_cqe * m_cqes;              //!< the completion queue entries
+    io_uring_buf * m_bufferRing;        //!< ring of registered buffers, shared with the kernel
+    size_t m_bufferRingSize;            //!< size of m_bufferRing
+    unsigned int m_bufferCount;         //!< number of registered buffers (power of two)
+    uint16_t m_bufferTail;              //!< tail of m_bufferRing
+    size_t m_bufferSize;                //!< size of each registered buffer
+    std::vector<char> m_buffers;        //!< the registered buffers, one after the other
+};
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief hands all available completions to @p handler , oldest first
+ *
+ * @param handler is called as handler(uint64_t userData, int32_t result, uint32_t flags) with the
+ * user data of the submission, its result (e.g. bytes, or -errno) and the flags of the completion
+ * (e.g. IORING_CQE_F_MORE: a multishot operation goes on; IORING_CQE_F_BUFFER: the data is in the
+ * buffer with id flags >> IORING_CQE_BUFFER_SHIFT)
+ * @return size_t number of completions handled
+ */
+template <typename Handler>
+size_t IoUring::reapCompletions(Handler && handler)
+{
+    size_t reaped = 0;
+    do
+    {
+        unsigned int head = *m_cqHead;
+        unsigned int tail = std::atomic_ref<unsigned int>(*m_cqTail).load(std::memory_order_acquire);
+        for (; head != tail; head++, reaped++)
+        {
+            io_uring_cqe completion = m_cqes[head & m_cqMask];
+            // free the entry first, so that a throwing handler does not see it again
+            std::atomic_ref<unsigned int>(*m_cqHead).store(head + 1, std::memory_order_release);
+            handler(completion.user_data, completion.res, completion.flags);
+        }
+    }
+    while (flushOverflow());
+    return reaped;
+}
+
+#endif // IORING_RECV_MULTISHOT
+
+#endif // IOURING_HPP
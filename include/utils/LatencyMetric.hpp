@@ -0,0 +1,59 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file LatencyMetric.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the LatencyMetric class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef LATENCYMETRIC_HPP
+#define LATENCYMETRIC_HPP
+
+// std includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The LatencyMetric class sums up latencies of Datagrams: how many were recorded, their
+ * average and the maximum
+ *
+ * @details Thread-safe: Datagrams of one Kable may be sent by several threads of the Runtime.
+ */
+class LatencyMetric
+{
+public:
+    LatencyMetric();
+
+    void record(std::chrono::steady_clock::duration latency);
+
+    uint64_t getCount() const;
+
+    uint64_t getAverage() const;
+
+    uint64_t getMaximum() const;
+
+    std::string toString() const;
+
+private:
+    std::atomic<uint64_t> m_count;          //!< recorded latencies
+    std::atomic<uint64_t> m_totalLatency;   //!< sum of the recorded latencies in µs
+    std::atomic<uint64_t> m_maxLatency;     //!< highest recorded latency in µs
+};
+
+#endif // LATENCYMETRIC_HPP
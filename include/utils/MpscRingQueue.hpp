@@ -0,0 +1,282 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file MpscRingQueue.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the MpscRingQueue class template
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef MPSCRINGQUEUE_HPP
+#define MPSCRINGQUEUE_HPP
+
+// std includes
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The MpscRingQueue class is a bounded, lock-free queue for many producers and one consumer
+ *
+ * @details Kables push Datagrams from the worker threads of their source Plags, while only the
+ * target Plag pops them. The queue is a ring of preallocated cells, each carrying a sequence
+ * number, that tells producers and the consumer whose turn it is (see D. Vyukov's bounded queue).
+ * Hence no node is allocated per item and no lock is taken. The positions of producers and
+ * consumer are kept on separate cache lines, so that both sides do not invalidate each other's
+ * cache on every operation.
+ * The capacity is rounded up to the next power of two. A push to a full queue fails, it is up to
+ * the caller to decide, what to do about that.
+ * Popping is done by compare-and-swap as well, so several consumers would not break the queue. But
+ * it is meant to be consumed by one only.
+ *
+ * @tparam T type of the items, needs to be default constructible and movable
+ */
+template <class T>
+class MpscRingQueue
+{
+public:
+    static const size_t CACHE_LINE_SIZE = 64;   //!< assumed size of a cache line in bytes
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief Construct a new MpscRingQueue object, by allocating all of its cells
+     *
+     * @param capacity minimum number of items the queue can hold (rounded up to power of two)
+     */
+    explicit MpscRingQueue(size_t capacity) :
+        m_capacity(roundUpToPowerOfTwo(capacity)),
+        m_mask(m_capacity - 1),
+        m_cells(new Cell[m_capacity]),
+        m_enqueuePos(0),
+        m_dequeuePos(0)
+    {
+        for (size_t i = 0; i < m_capacity; i++)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRingQueue(const MpscRingQueue &) = delete;
+    MpscRingQueue & operator=(const MpscRingQueue &) = delete;
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief puts @p item at the end of the queue. Safe to be called from any thread.
+     *
+     * @param item the item to move into the queue (untouched, if the queue is full)
+     * @return true if @p item was queued
+     * @return false if the queue is full
+     */
+    bool push(T && item)
+    {
+        size_t pos;
+        Cell * cell = claimForPush(pos);
+        if (cell == nullptr) return false;
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief copying overload of push()
+     *
+     * @param item the item to copy into the queue
+     * @return true if @p item was queued
+     * @return false if the queue is full
+     */
+    bool push(const T & item)
+    {
+        T copy = item;
+        return push(std::move(copy));
+    }
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief pushes as many of @p items as fit, in order
+     *
+     * @param items the items to move into the queue; the ones, that did not fit, stay untouched
+     * @return size_t number of items queued (from the front of @p items )
+     */
+    size_t pushBatch(std::vector<T> & items)
+    {
+        size_t pushed = 0;
+        while (pushed < items.size() && push(std::move(items[pushed]))) ++pushed;
+        return pushed;
+    }
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief takes the oldest item from the queue
+     *
+     * @param item target to move the oldest item to
+     * @return true if an item was taken
+     * @return false if the queue was empty
+     */
+    bool pop(T & item)
+    {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell * cell;
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (difference == 0)
+            {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (difference < 0)
+            {
+                return false; // empty
+            }
+            else
+            {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(pos + m_capacity, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief takes up to @p maxCount of the oldest items and appends them to @p items
+     *
+     * @param items target container, the items are appended to (it is not cleared)
+     * @param maxCount upper limit of items to take
+     * @return size_t number of items taken
+     */
+    size_t popBatch(std::vector<T> & items, size_t maxCount)
+    {
+        size_t popped = 0;
+        T item;
+        while (popped < maxCount && pop(item))
+        {
+            items.push_back(std::move(item));
+            ++popped;
+        }
+        return popped;
+    }
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief number of queued items. Only a snapshot, when other threads are working on the queue.
+     *
+     * @return size_t number of items
+     */
+    size_t size() const
+    {
+        size_t enqueuePos = m_enqueuePos.load(std::memory_order_acquire);
+        size_t dequeuePos = m_dequeuePos.load(std::memory_order_acquire);
+        return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+    }
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief whether the queue is empty. Only a snapshot, when other threads work on the queue.
+     *
+     * @return true if nothing is queued
+     * @return false else
+     */
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief simple getter
+     *
+     * @return size_t maximum number of items
+     */
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief one slot of the ring
+     *
+     */
+    struct Cell
+    {
+        std::atomic<size_t> sequence;   //!< position this cell is ready for (push: pos, pop: pos + 1)
+        T data;                         //!< the queued item
+    };
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief reserves the cell at the end of the queue for a producer
+     *
+     * @param pos set to the position the cell was reserved for
+     * @return Cell * the reserved cell, or nullptr if the queue is full
+     */
+    Cell * claimForPush(size_t & pos)
+    {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell * cell = &m_cells[pos & m_mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (difference == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    return cell;
+                }
+            }
+            else if (difference < 0)
+            {
+                return nullptr; // full
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief smallest power of two not smaller than @p value (and at least 2)
+     *
+     * @param value a number
+     * @return size_t the power of two
+     */
+    static size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t powerOfTwo = 2;
+        while (powerOfTwo < value) powerOfTwo <<= 1;
+        return powerOfTwo;
+    }
+
+private:
+    const size_t m_capacity;                                    //!< number of cells (power of two)
+    const size_t m_mask;                                        //!< m_capacity - 1, to map positions to cells
+    std::unique_ptr<Cell[]> m_cells;                            //!< the ring itself
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_enqueuePos;  //!< next position to push to (producers' line)
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_dequeuePos;  //!< next position to pop from (consumer's line)
+    char m_padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)]; //!< keeps neighbouring data off the consumer's line
+};
+
+#endif // MPSCRINGQUEUE_HPP
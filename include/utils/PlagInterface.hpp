@@ -23,11 +23,13 @@
 #define PLAGINTERFACE_HPP
 
 // std includes
-#include <list>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 // own includes
 #include "datagrams/Datagram.hpp"
+#include "MpscRingQueue.hpp"
 
 /**
  *-------------------------------------------------------------------------------------------------
@@ -56,15 +58,26 @@ enum PlagType : unsigned int
 class PlagInterface
 {
 public:
-    PlagInterface(PlagType type = PlagType::none);
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 4096;  //!< default number of Datagrams per queue
+
+    PlagInterface(PlagType type = PlagType::none, size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
 
     virtual void placeDatagram(const std::shared_ptr<Datagram> datagram) = 0;
+    virtual void placeDatagrams(const std::vector<std::shared_ptr<Datagram>> & datagrams);
+
+    virtual size_t getRoomFor(size_t count, const std::weak_ptr<PlagInterface> & producer);
+
+    virtual void notify() = 0;
 
     PlagType getType() const;
     
 protected:
-    std::list<std::shared_ptr<Datagram>> m_outgoingDatagrams;    //!< datagrams to be delivered to Kables very briefly live here.
-    std::list<std::shared_ptr<Datagram>> m_incommingDatagrams;   //!< datagrams translated and delivered by Kables very briefly live here.
+    MpscRingQueue<std::shared_ptr<Datagram>> m_outgoingDatagrams;   //!< datagrams to be delivered to Kables very briefly live here.
+    MpscRingQueue<std::shared_ptr<Datagram>> m_incommingDatagrams;  //!< datagrams translated and delivered by Kables very briefly live here.
+    std::atomic<uint64_t> m_droppedDatagrams;                       //!< newest datagrams lost, because a queue was full (or their transmission failed)
+    std::atomic<uint64_t> m_evictedDatagrams;                       //!< oldest datagrams lost, to make room for newer ones
+    std::atomic<uint64_t> m_coalescedDatagrams;                     //!< datagrams replaced by a newer one of the same key
+    std::atomic<uint64_t> m_blockedPushes;                          //!< times a producer was held back, as the queue had no room
 private:
     PlagType m_type;                //!< type of Plag (for convenience checking)
     bool m_streamableDataAvailable; //!< wheter or not, this can handle streamable data
@@ -0,0 +1,99 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file TimingWheel.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the TimingWheel class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef TIMINGWHEEL_HPP
+#define TIMINGWHEEL_HPP
+
+// std includes
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief The TimingWheel class is a hashed timing wheel: it hands out keys, once their deadline
+ * passed, at a cost that depends on the number of expiring keys, not on the number of scheduled
+ * ones
+ *
+ * @details Time is divided into ticks of a fixed duration. A key is kept in the slot of the tick
+ * of its deadline, modulo the number of slots. Deadlines further ahead than one turn of the wheel
+ * count the turns, that still have to pass, in their entry. expire() only visits the slots of the
+ * ticks, that passed since its last call.
+ * Keys are numbers below the keyCount given at construction, each scheduled at most once: the
+ * wheel keeps the position of each key, so that schedule() replaces an earlier deadline of the key
+ * and cancel() removes it right away. Not thread-safe.
+ */
+class TimingWheel
+{
+public:
+    TimingWheel(std::chrono::milliseconds tickDuration, size_t slotCount, size_t keyCount);
+
+    void schedule(uint64_t key, std::chrono::steady_clock::time_point deadline);
+
+    void cancel(uint64_t key);
+
+    bool isScheduled(uint64_t key) const;
+
+    size_t expire(std::chrono::steady_clock::time_point now, std::vector<uint64_t> & expired);
+
+    void clear();
+
+    size_t size() const;
+
+private:
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief one scheduled key
+     *
+     */
+    struct Entry
+    {
+        uint64_t key;       //!< what to hand out
+        uint64_t rounds;    //!< turns of the wheel to pass its slot, before it is handed out
+    };
+
+    /**
+     * ---------------------------------------------------------------------------------------------
+     * @brief where the entry of a key is
+     *
+     */
+    struct Position
+    {
+        uint32_t slot;      //!< index in m_slots (NOT_SCHEDULED: none)
+        uint32_t index;     //!< index of the entry in its slot
+    };
+
+    static constexpr uint32_t NOT_SCHEDULED = UINT32_MAX;   //!< slot of keys without an entry
+
+    uint64_t getTick(std::chrono::steady_clock::time_point timePoint) const;
+
+    void removeEntry(std::vector<Entry> & slot, size_t index);
+
+private:
+    std::chrono::milliseconds m_tickDuration;       //!< time covered by one slot
+    std::vector<std::vector<Entry>> m_slots;        //!< scheduled keys by tick (modulo slot count)
+    std::vector<Position> m_positions;              //!< position of the entry of each key
+    std::chrono::steady_clock::time_point m_origin; //!< start of tick 0
+    uint64_t m_currentTick;                         //!< first tick, that did not pass yet
+    size_t m_size;                                  //!< number of scheduled keys
+};
+
+#endif // TIMINGWHEEL_HPP
@@ -21,6 +21,8 @@
 
 // std include
 #include <iostream>
+#include <stdexcept>
+#include <thread>
 
 // own include
 #include "DatagramMqtt.hpp"
@@ -38,39 +40,84 @@ using namespace std;
  * @brief Construct a new Kable:: Kable object sets up the member values, of which Plags need to
  * connected in what order
  *
+ * @param propTree the whole config file
+ * @param rootName name of the Kable's section in @p propTree
+ * @param runtime the Runtime, queued Datagrams are delivered on
  * @param parent the source Plag, where Datagrams are from
  * @param target the target Plag, where Datagrams need to be translated to
  */
 Kable::Kable(const boost::property_tree::ptree & propTree, const string & rootName,
-             weak_ptr<PlagInterface> parent, weak_ptr<PlagInterface> target) :
+             Runtime & runtime, weak_ptr<PlagInterface> parent, weak_ptr<PlagInterface> target) :
     PropertyTreeReader(propTree, rootName),
+    m_name(rootName),
     m_parent(parent),
     m_target(target),
-    m_targetType(none)
+    m_targetType(none),
+    m_deliveryMode(SYNC_DELIVERY),
+    m_strand(boost::asio::make_strand(runtime.getIoContext())),
+    m_drainPending(false),
+    m_inDelivery(0),
+    m_sourceWaiting(false),
+    m_deliveredDatagrams(0),
+    m_droppedDatagrams(0),
+    m_totalLatency(0),
+    m_maxLatency(0),
+    m_maxBacklog(0),
+    m_ingressToEgress(new LatencyMetric())
 {
     if (!target.expired()) m_targetType = target.lock()->getType();
     readConfig();
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief evaluating and applying the settings file. Each value to set to a key of the target is
+ * compiled into a DataExpression here, so that translate() does not parse it per Datagram. Keys
+ * of source and target are resolved to FieldIds as far as their types allow. So is the
+ * gateCondition, if there is one.
+ *
+ */
 void Kable::readConfig() try
 {
+    PlagType sourceType = m_parent.expired() ? PlagType::none : m_parent.lock()->getType();
+    map<string, string> translationMap;
     vector<string> keys = getKeys();
     for (const string & key : keys)
     {
-        if (key == "sourcePlag" || key == "targetPlag")
+        if (key == "sourcePlag" || key == "targetPlag"
+            || key == "delivery" || key == "deliveryQueueCapacity")
         {
             continue;
         }
         else if (key == "gateCondition")
         {
-            //TODO: create Gates
-            continue;
+            m_gateCondition = make_shared<const GateCondition>(getParameter<string>(key), sourceType);
         }
         else
         {
-            m_translationMap.insert_or_assign(key, getParameter<string>(key));
+            translationMap.insert_or_assign(key, getParameter<string>(key));
         }
     }
+    m_translations.clear();
+    for (const pair<const string, string> & mapEntry : translationMap)
+    {
+        m_translations.push_back(Translation{ mapEntry.first, Datagram::FIELD_NONE,
+                                              DataExpression(mapEntry.second, sourceType) });
+    }
+    resolveTargetFields();
+
+    string delivery = getOptionalParameter<string>("delivery", "sync");
+    if (delivery == "sync") m_deliveryMode = SYNC_DELIVERY;
+    else if (delivery == "async") m_deliveryMode = ASYNC_DELIVERY;
+    else throw std::invalid_argument("Unknown delivery in settings: \"" + delivery + "\"");
+    if (m_deliveryMode == ASYNC_DELIVERY)
+    {
+        size_t capacity = getOptionalParameter<size_t>("deliveryQueueCapacity",
+                                                       DEFAULT_DELIVERY_QUEUE_CAPACITY);
+        m_deliveryQueue.reset(new MpscRingQueue<QueuedDatagram>(capacity));
+        m_drainBatch.reserve(MAX_DELIVERY_BATCH);
+        m_deliveryBatch.reserve(MAX_DELIVERY_BATCH);
+    }
 }
 catch (exception & e)
 {
@@ -99,6 +146,7 @@ bool Kable::assignTarget(weak_ptr<PlagInterface> target) try
     {
         m_target = target;
         m_targetType = target.lock()->getType();
+        resolveTargetFields();
     }
     return false;
 }
@@ -116,8 +164,50 @@ catch (exception & e)
  */
 void Kable::transmit(shared_ptr<Datagram> datagram) try
 {
+    chrono::steady_clock::time_point transmitTime = chrono::steady_clock::now();
     shared_ptr<Datagram> translatedDatagram = translate(datagram);
-    deliver(translatedDatagram);
+    if (!translatedDatagram) return;
+    if (m_deliveryMode == ASYNC_DELIVERY)
+    {
+        enqueue({ translatedDatagram }, transmitTime);
+    }
+    else
+    {
+        deliver(translatedDatagram);
+        countDelivery(1, transmitTime, chrono::steady_clock::now());
+    }
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened in Kable::transmit(): ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief batch version of transmit(): translates all @p datagrams first and delivers them to the
+ * target in one go afterwards (or queues them for that, with ASYNC_DELIVERY)
+ *
+ * @param datagrams Datagrams to be translated and delivered, in order
+ */
+void Kable::transmit(const vector<shared_ptr<Datagram>> & datagrams) try
+{
+    chrono::steady_clock::time_point transmitTime = chrono::steady_clock::now();
+    m_translatedBatch.clear();
+    for (const shared_ptr<Datagram> & datagram : datagrams)
+    {
+        shared_ptr<Datagram> translatedDatagram = translate(datagram);
+        if (translatedDatagram) m_translatedBatch.push_back(translatedDatagram);
+    }
+    if (m_deliveryMode == ASYNC_DELIVERY)
+    {
+        enqueue(m_translatedBatch, transmitTime);
+    }
+    else if (!m_translatedBatch.empty())
+    {
+        deliver(m_translatedBatch);
+        countDelivery(m_translatedBatch.size(), transmitTime, chrono::steady_clock::now());
+    }
+    m_translatedBatch.clear();
 }
 catch (exception & e)
 {
@@ -129,13 +219,18 @@ catch (exception & e)
  * @brief producing a Datagram the target Plag knows how to handle from the provided
  * @p sourceDatagram . Making use of the config file for the correct translation.
  *
+ * @details The gateCondition is checked first, so that a rejected Datagram costs no allocation.
+ *
  * @param sourceDatagram the Datagram of the parent
- * @return shared_ptr<Datagram> a Datagram the target Plag will understand
+ * @return shared_ptr<Datagram> a Datagram the target Plag will understand, or nullptr if
+ * @p sourceDatagram did not pass the gateCondition
  */
 shared_ptr<Datagram> Kable::translate(shared_ptr<Datagram> sourceDatagram) try
 {
+    if (m_gateCondition && !passesGate(*sourceDatagram)) return nullptr;
+
     shared_ptr<Datagram> translatedDatagram = nullptr;
-    string sourcePlag = get<string>(sourceDatagram->getData("sourcePlag"));
+    const string & sourcePlag = sourceDatagram->getSourcePlagName();
     switch (m_targetType)
     {
     case PlagType::MQTT:
@@ -153,22 +248,28 @@ shared_ptr<Datagram> Kable::translate(shared_ptr<Datagram> sourceDatagram) try
         cout << "Nothing to do here!" << endl;
         return nullptr;
     }
+    translatedDatagram->inheritIngress(*sourceDatagram, m_ingressToEgress);
 
     // working through translation table
-    for (const pair<string, string> & mapEntry : m_translationMap)
+    for (const Translation & translation : m_translations)
     {
         try
         {
-            if (mapEntry.first == "sourcePlag"
-            || mapEntry.first == "targetPlag"
-            || mapEntry.first == "gateCondition") continue;
-            translatedDatagram->setData(mapEntry.first,
-                                        sourceDatagram->getData(mapEntry.second));
+            if (translation.targetField != Datagram::FIELD_NONE)
+            {
+                translatedDatagram->setField(translation.targetField,
+                                             translation.value.evaluate(*sourceDatagram));
+            }
+            else
+            {
+                translatedDatagram->setData(translation.targetKey,
+                                            translation.value.evaluate(*sourceDatagram));
+            }
         }
         catch (std::invalid_argument & e)
         {
             cout << "Invalid argument: " << e.what();
-            cout << "  -> Key \"" << mapEntry.second << "\" will be ignored!" << endl;
+            cout << "  -> Key \"" << translation.value.getText() << "\" will be ignored!" << endl;
             continue;
         }
     }
@@ -180,6 +281,46 @@ catch (exception & e)
     throw std::runtime_error(string("Happened in Kable::translate(): ") + e.what());
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks @p datagram against m_gateCondition. A condition, that can not be evaluated for
+ * @p datagram (e.g. because of a missing key), rejects it.
+ *
+ * @param datagram the Datagram of the parent
+ * @return true if @p datagram may pass
+ * @return false else
+ */
+bool Kable::passesGate(const Datagram & datagram) const
+{
+    try
+    {
+        return m_gateCondition->evaluate(datagram);
+    }
+    catch (exception & e)
+    {
+        cout << "gateCondition \"" << m_gateCondition->getText() << "\" failed: " << e.what();
+        cout << "  -> Datagram will be rejected!" << endl;
+        return false;
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief resolves the keys of the target Datagram to FieldIds of m_targetType
+ *
+ */
+void Kable::resolveTargetFields() try
+{
+    for (Translation & translation : m_translations)
+    {
+        translation.targetField = DataExpression::lookUpFieldId(m_targetType, translation.targetKey);
+    }
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened in Kable::resolveTargetFields(): ") + e.what());
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief bringing the Datagram to the target Plag, by placing it there
@@ -197,3 +338,200 @@ catch (exception & e)
 {
     throw std::runtime_error(string("Happened in Kable::deliver(): ") + e.what());
 }
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief batch version of deliver(), checking the target only once
+ *
+ * @param datagrams the translated-for-the-target-Plag Datagrams
+ *
+ * @sa PlagInterface::placeDatagrams()
+ */
+void Kable::deliver(const vector<shared_ptr<Datagram>> & datagrams) try
+{
+    if (datagrams.empty()) return;
+    shared_ptr<PlagInterface> target = m_target.lock();
+    if (target) target->placeDatagrams(datagrams);
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened in Kable::deliver(): ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief asks the target, how many Datagrams the source may transmit now. If none, the target
+ * notifies the source, once it made room.
+ * @details With async delivery, the Datagrams waiting in the delivery queue (or being delivered
+ * from it) take their share of the room of the target first, and no more than the free slots of the queue are given. If the
+ * backlog leaves no room, drainQueue() notifies the source, once it delivered some of it.
+ *
+ * @param count number of Datagrams the source is about to transmit
+ * @return size_t up to @p count; @p count, if there is no target
+ *
+ * @sa PlagInterface::getRoomFor()
+ */
+size_t Kable::getRoomFor(size_t count) try
+{
+    shared_ptr<PlagInterface> target = m_target.lock();
+    if (!m_deliveryQueue) return target ? target->getRoomFor(count, m_parent) : count;
+
+    size_t queued = m_deliveryQueue->size();
+    size_t room = m_deliveryQueue->capacity() - min(queued, m_deliveryQueue->capacity());
+    room = min(count, room);
+    size_t backlog = queued + m_inDelivery;
+    if (target)
+    {
+        size_t targetRoom = target->getRoomFor(count + backlog, m_parent);
+        room = min(room, targetRoom > backlog ? targetRoom - backlog : 0);
+    }
+    if (room > 0 || backlog == 0) return room;
+
+    m_sourceWaiting = true;
+    // the backlog may have been delivered, before the flag was set
+    if (!m_deliveryQueue->empty() || !m_sourceWaiting.exchange(false)) return 0;
+    return target ? target->getRoomFor(count, m_parent) : count;
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened in Kable::getRoomFor(): ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief summary of the deliveries and their latencies, e.g. to print at shutdown
+ *
+ * @return std::string human readable statistics
+ */
+string Kable::getStatistics() const
+{
+    uint64_t delivered = m_deliveredDatagrams;
+    string statistics = m_name + (m_deliveryMode == ASYNC_DELIVERY ? " (async)" : " (sync)");
+    statistics += ": delivered " + to_string(delivered);
+    statistics += ", dropped " + to_string(m_droppedDatagrams);
+    statistics += ", latency avg " + to_string(delivered > 0 ? m_totalLatency / delivered : 0);
+    statistics += " us, max " + to_string(m_maxLatency) + " us";
+    if (m_deliveryQueue)
+    {
+        statistics += ", backlog " + to_string(m_deliveryQueue->size()) + "/"
+                      + to_string(m_deliveryQueue->capacity());
+        statistics += " (max " + to_string(m_maxBacklog) + ")";
+    }
+    if (m_ingressToEgress->getCount() > 0)
+    {
+        statistics += ", ingress to egress " + m_ingressToEgress->toString();
+    }
+    return statistics;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief puts translated Datagrams into the delivery queue and makes sure it is drained. A
+ * Datagram, that does not fit anymore, is dropped and counted. A slot, that drainQueue() took the
+ * Datagram from, but did not release yet, counts as free (see getRoomFor()).
+ *
+ * @param datagrams the translated Datagrams
+ * @param transmitTime when the Datagrams were handed to transmit()
+ */
+void Kable::enqueue(const vector<shared_ptr<Datagram>> & datagrams,
+                    chrono::steady_clock::time_point transmitTime) try
+{
+    if (datagrams.empty()) return;
+    for (const shared_ptr<Datagram> & datagram : datagrams)
+    {
+        while (!m_deliveryQueue->push(QueuedDatagram{ datagram, transmitTime }))
+        {
+            if (m_deliveryQueue->size() >= m_deliveryQueue->capacity())
+            {
+                m_droppedDatagrams++;
+                break;
+            }
+            this_thread::yield();
+        }
+    }
+    size_t backlog = m_deliveryQueue->size();
+    if (backlog > m_maxBacklog) m_maxBacklog = backlog;
+    notifyDelivery();
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened in Kable::enqueue(): ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief posts drainQueue() to m_strand, unless it is already pending. Safe to be called from any
+ * thread.
+ *
+ */
+void Kable::notifyDelivery()
+{
+    if (!m_drainPending.exchange(true))
+    {
+        boost::asio::post(m_strand, [this]() { drainQueue(); });
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief delivers up to MAX_DELIVERY_BATCH Datagrams from the delivery queue to the target. If
+ * more are waiting, the next drain is posted behind the other work of the Runtime.
+ *
+ */
+void Kable::drainQueue()
+{
+    m_drainPending = false;
+    m_drainBatch.clear();
+    // counted before they leave the queue, so that getRoomFor() does not miss them in between
+    m_inDelivery = min(m_deliveryQueue->size(), MAX_DELIVERY_BATCH);
+    if (m_deliveryQueue->popBatch(m_drainBatch, MAX_DELIVERY_BATCH) == 0)
+    {
+        m_inDelivery = 0;
+        return;
+    }
+    m_deliveryBatch.clear();
+    for (QueuedDatagram & queued : m_drainBatch)
+    {
+        m_deliveryBatch.push_back(move(queued.datagram));
+    }
+    try
+    {
+        deliver(m_deliveryBatch);
+        chrono::steady_clock::time_point deliveryTime = chrono::steady_clock::now();
+        for (const QueuedDatagram & queued : m_drainBatch)
+        {
+            countDelivery(1, queued.transmitTime, deliveryTime);
+        }
+    }
+    catch (exception & e)
+    {
+        cout << "Something happened while delivering by " << m_name << ": " << e.what() << endl;
+    }
+    m_deliveryBatch.clear();
+    m_drainBatch.clear();
+    m_inDelivery = 0;
+    if (m_sourceWaiting.exchange(false))
+    {
+        shared_ptr<PlagInterface> source = m_parent.lock();
+        if (source) source->notify();
+    }
+    if (!m_deliveryQueue->empty()) notifyDelivery();
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief adds delivered Datagrams to the statistics
+ *
+ * @param count number of Datagrams delivered
+ * @param transmitTime when the Datagrams were handed to transmit()
+ * @param deliveryTime when the target had them placed
+ */
+void Kable::countDelivery(size_t count, chrono::steady_clock::time_point transmitTime,
+                          chrono::steady_clock::time_point deliveryTime)
+{
+    uint64_t latency = static_cast<uint64_t>(
+        chrono::duration_cast<chrono::microseconds>(deliveryTime - transmitTime).count());
+    m_deliveredDatagrams += count;
+    m_totalLatency += latency * count;
+    if (latency > m_maxLatency) m_maxLatency = latency;
+}
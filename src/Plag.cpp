@@ -20,8 +20,8 @@
  */
 
 // std includes
+#include <algorithm>
 #include <iostream>
-#include <functional>
 
 // self include
 #include "Plag.hpp"
@@ -33,17 +33,32 @@ using namespace std;
  * @brief Construct a new Plag:: Plag object the default constructor for most subclasses simply
  * calls readConfig()
  *
+ * @param propTree the whole config file
+ * @param runtime the Runtime, this Plag and its sockets run on
+ * @param name name of the Plag
+ * @param id index of the Plag in the config file
+ * @param type type of the Plag
  * @sa Plag::readConfig()
  *
  */
-Plag::Plag(const boost::property_tree::ptree & propTree,
+Plag::Plag(const boost::property_tree::ptree & propTree, Runtime & runtime,
            const string & name, const uint64_t & id, PlagType type) :
-    PlagInterface(type),
+    PlagInterface(type, getOptionalParameter<size_t>(propTree, string("plag") + to_string(id),
+                                                     "queueCapacity", DEFAULT_QUEUE_CAPACITY)),
     PropertyTreeReader(propTree, string("plag") + to_string(id)),
     m_name(name),
     m_plagId(id),
-    m_workerThread(),
-    m_stopToken(false)
+    m_stopToken(true),
+    m_maxIdleTime(100),
+    m_maxBatch(256),
+    m_queuePolicy(DROP_NEWEST),
+    m_coalesceKey(""),
+    m_ioContext(runtime.getIoContext()),
+    m_strand(boost::asio::make_strand(m_ioContext)),
+    m_idleTimer(m_strand),
+    m_turnPending(false),
+    m_producersWaiting(false),
+    m_distributionBlocked(false)
 {
     readConfig();
 }
@@ -53,8 +68,28 @@ Plag::Plag(const boost::property_tree::ptree & propTree,
  * @brief evaluating and applying the settings file
  * 
  */
-void Plag::readConfig()
+void Plag::readConfig() try
 {
+    m_maxIdleTime = chrono::milliseconds(getOptionalParameter<unsigned int>("maxIdleTime", 100));
+    m_maxBatch = max<size_t>(getOptionalParameter<size_t>("maxBatch", 256), 1);
+    m_distributionBatch.reserve(m_maxBatch);
+
+    string policy = getOptionalParameter<string>("queuePolicy", "drop-newest");
+    if (policy == "drop-oldest") m_queuePolicy = DROP_OLDEST;
+    else if (policy == "drop-newest") m_queuePolicy = DROP_NEWEST;
+    else if (policy == "block-producer") m_queuePolicy = BLOCK_PRODUCER;
+    else if (policy == "coalesce-by-key") m_queuePolicy = COALESCE_BY_KEY;
+    else throw std::invalid_argument("Unknown queuePolicy in settings: \"" + policy + "\"");
+
+    m_coalesceKey = getOptionalParameter<string>("coalesceKey", "");
+    if (m_queuePolicy == COALESCE_BY_KEY && m_coalesceKey.empty())
+    {
+        throw std::invalid_argument("queuePolicy coalesce-by-key needs a coalesceKey in settings");
+    }
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened here:Plag::readConfig  What: ") + e.what());
 }
 
 /**
@@ -96,19 +131,22 @@ void Plag::attachKable(shared_ptr<Kable> kable)
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief creating a thread for the main execution to run. calls Plag::loop()
+ * @brief starts the worker, by posting the first turn to the Runtime. calls Plag::turn()
+ * Turns posted before (e.g. by sockets during init()) do nothing.
  *
- * @sa Plag::loop()
+ * @sa Plag::turn()
  *
  */
 void Plag::startWorker()
 {
-    m_workerThread = thread(bind(&Plag::loop, this, this->m_stopToken));
+    m_stopToken = false;
+    notify();
 }
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief accessible value setter, marking the token to stop the main thread (=worker)
+ * @brief accessible value setter, marking the token to stop the worker. The current turn is
+ * finished, but no further turn will do any work.
  * 
  */
 void Plag::stopWork()
@@ -116,58 +154,132 @@ void Plag::stopWork()
     m_stopToken = true;
 }
 
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief placeDatagram is a function to place a Datagram here. Hence this method decodes the
+ * datagram
+ *
+ * @param datagram A Datagram containing data for this Plag to interprete
+ */
+void Plag::placeDatagram(const shared_ptr<Datagram> datagram) try
+{
+    if (datagram)
+    {
+        cout << "Hello World!" << endl;
+    }
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened here:Plag::placeDatagram  What: ") + e.what());
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief loop is the regular main thread's execution envelop. It runs indefinetly, calls loopWork()
- * - an abstract method defined by each subclass - and sleeps for a millisecond afterwards if
- * loopWork() reported idleness by returning false.
- * This indefinite loop can be broken by setting the @p stopToken to true
+ * @brief with BLOCK_PRODUCER, only as many Datagrams may be placed, as there is room for in the
+ * incoming queue. Without any room, @p producer is held back and notified, once this Plag took
+ * Datagrams from the queue. Safe to be called from any thread.
  *
- * @param stopToken a reference to a boolean, that indicates whether to stop the process (=true) or
- * continue the loop (=false)
+ * @param count number of Datagrams the producer is about to place
+ * @param producer the Plag, that would place them
+ * @return size_t up to @p count; 0 if @p producer shall keep them, until it is notified
  */
-void Plag::loop(const bool & stopToken)
+size_t Plag::getRoomFor(size_t count, const weak_ptr<PlagInterface> & producer) try
 {
-    while (!stopToken)
+    if (m_queuePolicy != BLOCK_PRODUCER) return count;
+    size_t room = getIncomingRoom();
+    if (room > 0) return min(count, room);
+
     {
-        try
-        {
-            distribute();
-            if (!this->loopWork())
-            {
-                // no more work to do - worker is idle
-                this_thread::sleep_for(chrono::milliseconds(1));
-            }
-        }
-        catch (exception & e)
+        const lock_guard<mutex> lock(m_mtxProducers);
+        bool known = false;
+        for (const weak_ptr<PlagInterface> & waiting : m_waitingProducers)
         {
-            cout << "Something happened while looping: " << e.what() << endl;
-        }
-        catch (...)
-        {
-            cerr << "Caught unexpected error! Stopping this thread: " << this->getName() << endl;
-            stopWork();
+            known = known || (!waiting.owner_before(producer) && !producer.owner_before(waiting));
         }
+        if (!known) m_waitingProducers.push_back(producer);
+        m_producersWaiting = true;
     }
+    m_blockedPushes++;
+    // the worker may have made room, before the producer was registered
+    return min(count, getIncomingRoom());
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened here:Plag::getRoomFor  What: ") + e.what());
 }
 
 /**
- * -------------------------------------------------------------------------------------------------
- * @brief placeDatagram is a function to place a Datagram here. Hence this method decodes the
- * datagram
+ *-------------------------------------------------------------------------------------------------
+ * @brief wakes up the worker, if it is parked. Call this after work for this Plag was created
+ * (e.g. by a Kable placing a Datagram, or by a completed socket operation). Safe to be called from
+ * any thread.
  *
- * @param datagram A Datagram containing data for this Plag to interprete
+ * @details Wake-ups are coalesced: as long as a turn is pending, further calls do not post again.
  */
-void Plag::placeDatagram(const shared_ptr<Datagram> datagram) try
+void Plag::notify()
 {
-    if (datagram)
+    if (!m_turnPending.exchange(true))
     {
-        cout << "Hello World!" << endl;
+        boost::asio::post(m_strand, [this]() { turn(); });
     }
 }
-catch (exception & e)
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter, to let sockets and transport layers register with the Runtime's event loop
+ *
+ * @return boost::asio::io_context & the event loop of the Runtime
+ */
+boost::asio::io_context & Plag::getIoContext()
 {
-    throw std::runtime_error(string("Happened here:Plag::placeDatagram  What: ") + e.what());
+    return m_ioContext;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter, to bind completion handlers to, that touch members also used by loopWork()
+ *
+ * @return boost::asio::strand<boost::asio::io_context::executor_type> & member value
+ */
+boost::asio::strand<boost::asio::io_context::executor_type> & Plag::getStrand()
+{
+    return m_strand;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief summary of the queues and their losses, followed by the statistics of the attached
+ * Kables (one per line), e.g. to print at shutdown
+ *
+ * @return std::string human readable statistics
+ */
+string Plag::getStatistics() const
+{
+    string statistics = m_name + ": incoming " + to_string(m_incommingDatagrams.size()) + "/"
+                        + to_string(m_incommingDatagrams.capacity());
+    statistics += ", outgoing " + to_string(m_outgoingDatagrams.size()) + "/"
+                  + to_string(m_outgoingDatagrams.capacity());
+    statistics += ", dropped " + to_string(m_droppedDatagrams);
+    statistics += ", evicted " + to_string(m_evictedDatagrams);
+    statistics += ", coalesced " + to_string(m_coalescedDatagrams);
+    statistics += ", blocked " + to_string(m_blockedPushes);
+    statistics += getSpecificStatistics();
+    for (const shared_ptr<Kable> & kable : m_kables)
+    {
+        statistics += "\n    " + kable->getStatistics();
+    }
+    return statistics;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief statistics only a certain type of Plag keeps, appended to getStatistics()
+ *
+ * @return std::string e.g. ", truncated 3"; empty, if there are none
+ */
+string Plag::getSpecificStatistics() const
+{
+    return string();
 }
 
 /**
@@ -179,7 +291,8 @@ catch (exception & e)
  */
 void Plag::appendToDistribution(shared_ptr<Datagram> datagram) try
 {
-    m_outgoingDatagrams.push_back(datagram);
+    if (!m_outgoingDatagrams.push(move(datagram))) m_droppedDatagrams++;
+    notify();
 }
 catch (exception & e)
 {
@@ -188,23 +301,271 @@ catch (exception & e)
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief distribute is the method to take a message from the outgoing buffer and provide it to
- * every attached Kable.
+ * @brief put a Datagram to the incoming buffer and wake up the worker to handle it. Safe to be
+ * called from any thread, hence it is the way for Kables (via placeDatagram()) to hand over data.
+ *
+ * @details If the buffer is full, m_queuePolicy decides: DROP_NEWEST drops @p datagram,
+ * DROP_OLDEST evicts the oldest queued Datagram. BLOCK_PRODUCER drops @p datagram as well, which
+ * only happens, if several producers were given the same room by getRoomFor() at once.
+ * COALESCE_BY_KEY does not use the buffer, but replaces a waiting Datagram of the same key value.
+ * Each loss is counted.
+ *
+ * @param datagram datagram for the worker to handle
+ */
+void Plag::appendToIncoming(shared_ptr<Datagram> datagram) try
+{
+    switch (m_queuePolicy)
+    {
+    case COALESCE_BY_KEY:
+        coalesce(move(datagram));
+        break;
+    case DROP_OLDEST:
+        while (!m_incommingDatagrams.push(datagram))
+        {
+            shared_ptr<Datagram> evicted;
+            if (m_incommingDatagrams.pop(evicted)) m_evictedDatagrams++;
+        }
+        break;
+    case BLOCK_PRODUCER:
+        // deliberate fall-through, the producers are held back by getRoomFor()
+    case DROP_NEWEST:
+        // deliberate fall-through
+    default:
+        if (!m_incommingDatagrams.push(move(datagram))) m_droppedDatagrams++;
+        break;
+    }
+    notify();
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened here:Plag::appendToIncoming  What: ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief takes up to @p maxCount of the oldest Datagrams from the incoming buffer. Subclasses use
+ * this instead of accessing m_incommingDatagrams, so that the queue policy is respected and
+ * producers held back by getRoomFor() are woken up.
+ *
+ * @param datagrams target container, the Datagrams are appended to
+ * @param maxCount upper limit of Datagrams to take
+ * @return size_t number of Datagrams taken
+ */
+size_t Plag::takeFromIncoming(vector<shared_ptr<Datagram>> & datagrams, size_t maxCount) try
+{
+    if (m_queuePolicy != COALESCE_BY_KEY)
+    {
+        size_t taken = m_incommingDatagrams.popBatch(datagrams, maxCount);
+        if (taken > 0 && m_producersWaiting) wakeUpProducers();
+        return taken;
+    }
+
+    const lock_guard<mutex> lock(m_mtxCoalesce);
+    size_t taken = 0;
+    while (taken < maxCount && !m_coalesceOrder.empty())
+    {
+        auto entry = m_coalescedByKey.find(m_coalesceOrder.front());
+        datagrams.push_back(move(entry->second));
+        m_coalescedByKey.erase(entry);
+        m_coalesceOrder.pop_front();
+        taken++;
+    }
+    return taken;
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened here:Plag::takeFromIncoming  What: ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief whether a target of this Plag had no room for its Datagrams (see getRoomFor()). Plags
+ * stop reading from their end-point meanwhile, so that the backpressure reaches it, instead of
+ * filling up m_outgoingDatagrams. Safe to be called from any thread.
+ *
+ * @return true from a turn, in which distribute() was held back, until m_outgoingDatagrams is
+ * drained to half of its capacity
+ * @sa Plag::resumeIngress()
+ */
+bool Plag::isBackpressured() const
+{
+    return m_distributionBlocked;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief called on the strand, once distribute() goes on after having been held back. Plags, that
+ * stopped reading from their end-point because of isBackpressured(), restart reading here.
+ *
+ */
+void Plag::resumeIngress()
+{
+    // Plags reading in loopWork() go on by themselves
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief turn is the worker's execution envelop. It calls distribute() and loopWork() - an
+ * abstract method defined by each subclass - once. If there was work, the next turn is posted
+ * right away, behind the turns of other Plags. Otherwise the worker parks until it is woken up by
+ * notify() or latest after m_maxIdleTime.
+ * The chain of turns is broken by setting m_stopToken to true.
  *
+ * @sa Plag::park()
  */
-void Plag::distribute() try
+void Plag::turn()
 {
-    // if outgoing datagrams list is not empty: distribute
-    if (m_outgoingDatagrams.begin() != m_outgoingDatagrams.end())
+    m_turnPending = false;
+    if (m_stopToken) return;
+    try
     {
-        for (shared_ptr<Kable> kable : m_kables)
+        bool distributed = distribute();
+        if (this->loopWork() || distributed)
+        {
+            notify();
+        }
+        else
         {
-            kable->transmit(m_outgoingDatagrams.front());
+            // no more work to do - worker is idle until something happens
+            park();
         }
-        m_outgoingDatagrams.pop_front();
+    }
+    catch (exception & e)
+    {
+        cout << "Something happened while looping: " << e.what() << endl;
+        park();
+    }
+    catch (...)
+    {
+        cerr << "Caught unexpected error! Stopping this Plag: " << this->getName() << endl;
+        stopWork();
     }
 }
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief arms m_idleTimer, so that an idle worker checks for work latest after m_maxIdleTime
+ *
+ */
+void Plag::park()
+{
+    m_idleTimer.expires_after(m_maxIdleTime);
+    m_idleTimer.async_wait([this](const boost::system::error_code & error)
+                           {
+                               // aborted means: re-armed by another park()
+                               if (error != boost::asio::error::operation_aborted) notify();
+                           });
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief distribute is the method to take the messages from the outgoing buffer and provide them
+ * to every attached Kable. Up to m_maxBatch messages are handed over in one go, so that each Kable
+ * is visited once per batch instead of once per message.
+ * A target with BLOCK_PRODUCER makes the batch smaller, to what it has room for. Without any room,
+ * the messages stay in the buffer and the worker parks, until the target notifies it.
+ *
+ * @return true if messages were distributed
+ * @return false if the outgoing buffer was empty or a target has no room
+ */
+bool Plag::distribute() try
+{
+    m_distributionBatch.clear();
+    size_t count = min(m_outgoingDatagrams.size(), m_maxBatch);
+    if (count == 0) return false;
+    for (shared_ptr<Kable> & kable : m_kables)
+    {
+        count = kable->getRoomFor(count);
+        if (count == 0)
+        {
+            m_distributionBlocked = true;
+            return false;
+        }
+    }
+
+    if (m_outgoingDatagrams.popBatch(m_distributionBatch, count) == 0) return false;
+    for (shared_ptr<Kable> & kable : m_kables)
+    {
+        kable->transmit(m_distributionBatch);
+    }
+    m_distributionBatch.clear();
+    if (m_distributionBlocked && m_outgoingDatagrams.size() <= m_outgoingDatagrams.capacity() / 2)
+    {
+        m_distributionBlocked = false;
+        resumeIngress();
+    }
+    return true;
+}
 catch (exception & e)
 {
     throw std::runtime_error(string("Happened here:Plag::distribute  What: ") + e.what());
 }
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief keeps @p datagram as the latest one of its value of m_coalesceKey. A Datagram of the same
+ * value, that is still waiting, is replaced - keeping its place in the order of arrival.
+ *
+ * @param datagram datagram for the worker to handle
+ */
+void Plag::coalesce(shared_ptr<Datagram> datagram) try
+{
+    string key = convertDataTypeToString(datagram->getData(m_coalesceKey));
+    const lock_guard<mutex> lock(m_mtxCoalesce);
+    auto entry = m_coalescedByKey.find(key);
+    if (entry != m_coalescedByKey.end())
+    {
+        entry->second = move(datagram);
+        m_coalescedDatagrams++;
+    }
+    else if (m_coalesceOrder.size() >= m_incommingDatagrams.capacity())
+    {
+        m_droppedDatagrams++;
+    }
+    else
+    {
+        m_coalescedByKey.emplace(key, move(datagram));
+        m_coalesceOrder.push_back(key);
+    }
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened here:Plag::coalesce  What: ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief free cells of m_incommingDatagrams, not counting the one a pop in progress may still
+ * hold, so that a producer never gets more room than it can push right away
+ *
+ * @return size_t number of Datagrams, that fit into the incoming queue
+ */
+size_t Plag::getIncomingRoom() const
+{
+    size_t capacity = m_incommingDatagrams.capacity();
+    return capacity - min(m_incommingDatagrams.size() + 1, capacity);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief notifies the producers held back by getRoomFor(), so that they try again
+ *
+ */
+void Plag::wakeUpProducers() try
+{
+    vector<weak_ptr<PlagInterface>> producers;
+    {
+        const lock_guard<mutex> lock(m_mtxProducers);
+        m_producersWaiting = false;
+        producers.swap(m_waitingProducers);
+    }
+    for (const weak_ptr<PlagInterface> & producer : producers)
+    {
+        shared_ptr<PlagInterface> plag = producer.lock();
+        if (plag) plag->notify();
+    }
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened here:Plag::wakeUpProducers  What: ") + e.what());
+}
@@ -0,0 +1,165 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file Runtime.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Implements the Runtime class
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <iostream>
+
+// self include
+#include "Runtime.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new Runtime:: Runtime object reads the config. The threads are not started
+ * until start() is called.
+ *
+ * @param propTree the whole config file
+ */
+Runtime::Runtime(const boost::property_tree::ptree & propTree) :
+    PropertyTreeReader(propTree, "runtime"),
+    m_threadCount(MIN_THREAD_COUNT),
+    m_ioContext(),
+    m_workGuard(boost::asio::make_work_guard(m_ioContext))
+{
+    readConfig();
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Destroy the Runtime:: Runtime object stops and joins all threads, if not done yet
+ *
+ */
+Runtime::~Runtime()
+{
+    try
+    {
+        stop();
+    }
+    catch (exception & e)
+    {
+        cerr << "Could not stop Runtime, because of " << e.what() << endl;
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief evaluating and applying the settings file
+ *
+ */
+void Runtime::readConfig() try
+{
+    unsigned int cores = thread::hardware_concurrency();
+    m_threadCount = getOptionalParameter<unsigned int>("threads", cores);
+    if (m_threadCount < MIN_THREAD_COUNT) m_threadCount = MIN_THREAD_COUNT;
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened in Runtime::readConfig(): ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief starts the threads to run the event loop. Plags need the Runtime to be started, before
+ * they are initialized.
+ *
+ */
+void Runtime::start() try
+{
+    if (!m_threads.empty()) return;
+    for (unsigned int i = 0; i < m_threadCount; i++)
+    {
+        m_threads.emplace_back(&Runtime::run, this);
+    }
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened in Runtime::start(): ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief stops the event loop and waits for all threads to return. Handlers still running are
+ * finished, pending ones are dropped.
+ *
+ */
+void Runtime::stop() try
+{
+    m_workGuard.reset();
+    m_ioContext.stop();
+    for (thread & runner : m_threads)
+    {
+        if (runner.joinable()) runner.join();
+    }
+    m_threads.clear();
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened in Runtime::stop(): ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return boost::asio::io_context & the event loop to register sockets, timers and strands on
+ */
+boost::asio::io_context & Runtime::getIoContext()
+{
+    return m_ioContext;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return unsigned int number of threads, that run the event loop
+ */
+unsigned int Runtime::getThreadCount() const
+{
+    return m_threadCount;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief body of each thread: runs the event loop until stop() is called. An exception escaping a
+ * handler is reported and the thread returns to the event loop, so that one failing operation
+ * does not take all Plags down.
+ *
+ */
+void Runtime::run()
+{
+    while (!m_ioContext.stopped())
+    {
+        try
+        {
+            m_ioContext.run();
+        }
+        catch (exception & e)
+        {
+            cerr << "Something happened in a handler of the Runtime: " << e.what() << endl;
+        }
+        catch (...)
+        {
+            cerr << "Caught unexpected error in a handler of the Runtime!" << endl;
+        }
+    }
+}
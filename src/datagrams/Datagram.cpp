@@ -20,10 +20,11 @@
  */
 
 // std includes
+#include <atomic>
+#include <cstdio>
 #include <iostream>
-
-// openssl includes
-#include <openssl/evp.h>
+#include <random>
+#include <unordered_map>
 
 // boost includes
 #include <boost/algorithm/string.hpp>
@@ -43,43 +44,77 @@ using namespace std;
  * @param sourceName the name of the Plag, which created this Datagram
  */
 Datagram::Datagram(const string & sourceName) :
+    m_ownSequenceNumber(generateSequenceNumber()),
     m_sourcePlagName(sourceName),
     m_sourceDatagramId(0),
-    m_timeOfCreation(std::chrono::steady_clock::now())
+    m_timeOfCreation(std::chrono::steady_clock::now()),
+    m_timeOfIngress(m_timeOfCreation)
 {
-    //TODO: create a unique hash of some sort
-    string nowStr;
-    nowStr = getTimeAsUtcIsoStr(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
-    string feedFeed = sourceName + to_string(m_sourceDatagramId);
-    uint32_t remainder;
-    std::chrono::microseconds sinceEpoch;
-    sinceEpoch = std::chrono::duration_cast<std::chrono::microseconds>(m_timeOfCreation.time_since_epoch());
-    remainder = sinceEpoch.count() % 1000000;
-    feedFeed += nowStr;
-    feedFeed += to_string(remainder);
-
-    const unsigned char * feed = reinterpret_cast<const unsigned char *>(feedFeed.c_str());
-
-    // creating a unique identifier hash using openssl's evp
-    EVP_MD_CTX * md5Context;
-    unsigned char * md5Result;
-    unsigned int md5ResultLength = EVP_MD_size(EVP_md5());
-
-    // MD5_Init
-    md5Context = EVP_MD_CTX_new();
-    EVP_DigestInit_ex(md5Context, EVP_md5(), nullptr);
+}
 
-    // MD5_Update
-    EVP_DigestUpdate(md5Context, feed, feedFeed.size());
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief the unique id of this Datagram. It is only rendered to a string, when asked for.
+ *
+ * @details The id consists of a random prefix, chosen once per process, and the sequence number of
+ * the Datagram, both as 16 hex digits. So ids are unique within a process and - with high
+ * probability - across processes and restarts.
+ *
+ * @return string 32 hex digits
+ */
+string Datagram::getId() const
+{
+    static const uint64_t processPrefix = []()
+    {
+        random_device randomDevice;
+        return (static_cast<uint64_t>(randomDevice()) << 32) | randomDevice();
+    }();
+    char id[33];
+    snprintf(id, sizeof(id), "%016llx%016llx", static_cast<unsigned long long>(processPrefix),
+             static_cast<unsigned long long>(m_ownSequenceNumber));
+    return string(id);
+}
 
-    // MD5_Final
-    md5Result = reinterpret_cast<unsigned char *>(OPENSSL_malloc(md5ResultLength));
-    EVP_DigestFinal_ex(md5Context, md5Result, &md5ResultLength);
-    EVP_MD_CTX_free(md5Context);
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return const string & name of the Plag this Datagram originated from
+ */
+const string & Datagram::getSourcePlagName() const
+{
+    return m_sourcePlagName;
+}
 
-    m_ownId = string(reinterpret_cast<char *>(md5Result));
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief hands out a new number for each Datagram created. Safe to be called from any thread.
+ *
+ * @return uint64_t a number not handed out before within this process
+ */
+uint64_t Datagram::generateSequenceNumber()
+{
+    static atomic<uint64_t> nextSequenceNumber(1);
+    return nextSequenceNumber.fetch_add(1, memory_order_relaxed);
+}
 
-    //cout << "My ID is " << m_ownId << endl;
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief resolves the name of a field to its id. Subclasses hide this with their own version, that
+ * knows their fields on top of these.
+ *
+ * @param key name of the field, as used with getData()
+ * @return FieldId id of the field, or FIELD_NONE if @p key is no field of Datagram
+ */
+FieldId Datagram::getFieldId(const string & key)
+{
+    static const unordered_map<string, FieldId> fieldIds = {
+        { "uuid", FIELD_UUID },
+        { "sourceDatagramId", FIELD_SOURCE_DATAGRAM_ID },
+        { "sourcePlag", FIELD_SOURCE_PLAG }
+    };
+    auto fieldId = fieldIds.find(key);
+    return fieldId != fieldIds.end() ? fieldId->second : static_cast<FieldId>(FIELD_NONE);
 }
 
 /**
@@ -150,7 +185,9 @@ DataType Datagram::getData(const string & key) const try
         DataType data = this->getData(innerKey);
         vector<string> dataSplit;
         boost::split(dataSplit, convertDataTypeToString(data), boost::is_any_of(splitter));
-        if (key.at(closingBracketPos + 1) == '.' && isDigit(key.at(closingBracketPos + 2)))
+        // without an index, the SPLIT may end the key
+        if (closingBracketPos + 2 < key.size() && key.at(closingBracketPos + 1) == '.'
+            && isDigit(key.at(closingBracketPos + 2)))
         {
             size_t index = stoul(key.substr(closingBracketPos + 2), nullptr, 10) - 1;
             if (index == string::npos || index >= dataSplit.size())
@@ -161,21 +198,11 @@ DataType Datagram::getData(const string & key) const try
         }
         return dataSplit;
     }
-    else if (key == string("uuid"))
-    {
-        return m_ownId;
-    }
-    else if (key == string("sourceDatagramId"))
-    {
-        return m_sourceDatagramId;
-    }
-    else if (key == string("sourcePlag"))
-    {
-        return m_sourcePlagName;
-    }
     else
     {
-        throw std::invalid_argument(string("Invalid key \"") + key + "\"");
+        FieldId field = Datagram::getFieldId(key);
+        if (field == FIELD_NONE) throw std::invalid_argument(string("Invalid key \"") + key + "\"");
+        return Datagram::getField(field);
     }
 }
 catch (exception & e)
@@ -192,18 +219,104 @@ catch (exception & e)
  */
 void Datagram::setData(const string & key, const DataType & value) try
 {
-    if (key == string("sourceDatagramId"))
+    FieldId field = Datagram::getFieldId(key);
+    if (field == FIELD_NONE) throw std::invalid_argument(string("Invalid key \"") + key + "\"");
+    Datagram::setField(field, value);
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Datagram::setData(): ") + e.what());
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief method to access data of Datagram by the id of its field
+ *
+ * @param field id of the field, as returned by getFieldId()
+ * @return DataType value of the field
+ */
+DataType Datagram::getField(FieldId field) const
+{
+    switch (field)
     {
-        m_sourceDatagramId = convertDataTypeToUint64(value);
+    case FIELD_UUID:
+        return getId();
+    case FIELD_SOURCE_DATAGRAM_ID:
+        return m_sourceDatagramId;
+    case FIELD_SOURCE_PLAG:
+        return m_sourcePlagName;
+    default:
+        throw std::invalid_argument("Invalid field id " + to_string(field));
     }
-    else
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief method to write data of Datagram by the id of its field
+ *
+ * @param field id of the field, as returned by getFieldId()
+ * @param value value to be set for the field
+ */
+void Datagram::setField(FieldId field, const DataType & value)
+{
+    switch (field)
     {
-        throw std::invalid_argument(string("Invalid key \"") + key + "\"");
+    case FIELD_SOURCE_DATAGRAM_ID:
+        m_sourceDatagramId = convertDataTypeToUint64(value);
+        break;
+    default:
+        throw std::invalid_argument("Field id " + to_string(field) + " can not be set");
     }
 }
-catch (exception & e)
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return steady_clock::time_point when the data of this Datagram entered plag'n
+ */
+chrono::steady_clock::time_point Datagram::getTimeOfIngress() const
 {
-    throw std::runtime_error(string("Datagram::setData(): ") + e.what());
+    return m_timeOfIngress;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple setter, for Plags knowing better than the time of creation, e.g. the time the
+ * kernel received a packet
+ *
+ * @param timeOfIngress when the data of this Datagram entered plag'n
+ */
+void Datagram::setTimeOfIngress(chrono::steady_clock::time_point timeOfIngress)
+{
+    m_timeOfIngress = timeOfIngress;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief takes over the time of ingress of @p sourceDatagram , this one was translated from, so
+ * that the latency spans all Kables in between
+ *
+ * @param sourceDatagram the Datagram this one was translated from
+ * @param egressLatency where markEgress() records the latency of this Datagram
+ */
+void Datagram::inheritIngress(const Datagram & sourceDatagram,
+                              const shared_ptr<LatencyMetric> & egressLatency)
+{
+    m_timeOfIngress = sourceDatagram.m_timeOfIngress;
+    m_egressLatency = egressLatency;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief to be called by a Plag, once it handed this Datagram to the outside world (e.g. sent it).
+ * Records the latency since the time of ingress, if a Kable asked for it.
+ *
+ * @param timeOfEgress when this Datagram left plag'n
+ */
+void Datagram::markEgress(chrono::steady_clock::time_point timeOfEgress) const
+{
+    if (m_egressLatency) m_egressLatency->record(timeOfEgress - m_timeOfIngress);
 }
 
 /**
@@ -220,7 +333,7 @@ string Datagram::toString() const try
     if (m_sourceDatagramId == 0) stringRepresentation += "; newly generated";
     //TODO: string representation of time
     //stringRepresentation += ";at " + to_string(m_timeOfCreation);
-    stringRepresentation += "; with id " + m_ownId;
+    stringRepresentation += "; with id " + getId();
     stringRepresentation += "}";
     return stringRepresentation;
 }
@@ -58,6 +58,19 @@ void DatagramHttpServer::setReqId(std::string reqId)
     m_reqId = reqId;
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief resolves the name of a field to its id
+ *
+ * @param key name of the field, as used with getData()
+ * @return FieldId FIELD_REQUEST_ID for "requestId", else FIELD_NONE (see DatagramMap::getFieldId())
+ */
+FieldId DatagramHttpServer::getFieldId(const string & key)
+{
+    if (key == "requestId") return FIELD_REQUEST_ID;
+    return DatagramMap::getFieldId(key);
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief method to access data of Datagram under just one name
@@ -105,6 +118,38 @@ catch (exception & e)
     throw std::runtime_error(string("DatagramHttpServer::setData(): ") + e.what());
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief method to access data of Datagram by the id of its field
+ *
+ * @param field id of the field, as returned by getFieldId()
+ * @return DataType value of the field
+ */
+DataType DatagramHttpServer::getField(FieldId field) const
+{
+    if (field == FIELD_REQUEST_ID) return m_reqId;
+    return DatagramMap::getField(field);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief method to write data of Datagram by the id of its field
+ *
+ * @param field id of the field, as returned by getFieldId()
+ * @param value value to be set for the field
+ */
+void DatagramHttpServer::setField(FieldId field, const DataType & value)
+{
+    if (field == FIELD_REQUEST_ID)
+    {
+        setReqId(get<string>(value));
+    }
+    else // use base class implementation
+    {
+        DatagramMap::setField(field, value);
+    }
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief creates a string representation of this Datagram
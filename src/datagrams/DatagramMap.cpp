@@ -47,6 +47,20 @@ DatagramMap::DatagramMap(const string & sourcePlag, map<string, DataType> map) :
 {
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief resolves the name of a field to its id. As any key may be a key of the map, which takes
+ * precedence over the fields of Datagram, no key can be resolved in advance.
+ *
+ * @param key name of the field, as used with getData()
+ * @return FieldId always FIELD_NONE
+ */
+FieldId DatagramMap::getFieldId(const string & key)
+{
+    (void) key;
+    return FIELD_NONE;
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief method to access data of Datagram under just one name
@@ -19,6 +19,9 @@
  *
  */
 
+// std includes
+#include <unordered_map>
+
 // self include
 #include "DatagramMqtt.hpp"
 
@@ -125,6 +128,27 @@ bool DatagramMqtt::getRetainFlag() const
     return m_retain;
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief resolves the name of a field to its id
+ *
+ * @param key name of the field, as used with getData()
+ * @return FieldId id of the field, or FIELD_NONE if @p key is no field of DatagramMqtt
+ */
+FieldId DatagramMqtt::getFieldId(const string & key)
+{
+    static const unordered_map<string, FieldId> fieldIds = {
+        { "action", FIELD_ACTION },
+        { "topic", FIELD_TOPIC },
+        { "content", FIELD_CONTENT },
+        { "userInfo", FIELD_USER_INFO },
+        { "qos", FIELD_QOS },
+        { "retain", FIELD_RETAIN }
+    };
+    auto fieldId = fieldIds.find(key);
+    return fieldId != fieldIds.end() ? fieldId->second : Datagram::getFieldId(key);
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief method to access data of Datagram under just one name
@@ -134,29 +158,10 @@ bool DatagramMqtt::getRetainFlag() const
  */
 DataType DatagramMqtt::getData(const string & key) const try
 {
-    if (key == string("action"))
-    {
-        return getAction();
-    }
-    else if (key == string("topic"))
-    {
-        return getTopic();
-    }
-    else if (key == string("content"))
-    {
-        return getContent();
-    }
-    else if (key == string("userInfo"))
-    {
-        return getUserInfo();
-    }
-    else if (key == string("qos"))
-    {
-        return getQoS();
-    }
-    else if (key == string("retain"))
+    FieldId field = getFieldId(key);
+    if (field != FIELD_NONE)
     {
-        return static_cast<unsigned int>(getRetainFlag());
+        return getField(field);
     }
     else // use base class implementation
     {
@@ -181,29 +186,10 @@ catch (exception & e)
  */
 void DatagramMqtt::setData(const string & key, const DataType & value) try
 {
-    if (key == string("action"))
-    {
-        m_action = convertDataTypeToString(value);
-    }
-    else if (key == string("topic"))
-    {
-        m_topic = convertDataTypeToString(value);
-    }
-    else if (key == string("content"))
-    {
-        m_content = convertDataTypeToString(value);
-    }
-    else if (key == string("userInfo"))
-    {
-        m_userInfo = convertDataTypeToString(value);
-    }
-    else if (key == string("qos"))
-    {
-        m_qos = static_cast<uint8_t>(convertDataTypeToUint(value));
-    }
-    else if (key == string("retain"))
+    FieldId field = getFieldId(key);
+    if (field != FIELD_NONE)
     {
-        m_retain = convertDataTypeToBoolean(value);
+        setField(field, value);
     }
     else // use base class implementation
     {
@@ -219,6 +205,68 @@ catch (exception & e)
     throw std::runtime_error(string("DatagramMqtt::setData(): ") + e.what());
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief method to access data of Datagram by the id of its field
+ *
+ * @param field id of the field, as returned by getFieldId()
+ * @return DataType value of the field
+ */
+DataType DatagramMqtt::getField(FieldId field) const
+{
+    switch (field)
+    {
+    case FIELD_ACTION:
+        return m_action;
+    case FIELD_TOPIC:
+        return m_topic;
+    case FIELD_CONTENT:
+        return m_content;
+    case FIELD_USER_INFO:
+        return m_userInfo;
+    case FIELD_QOS:
+        return getQoS();
+    case FIELD_RETAIN:
+        return static_cast<unsigned int>(m_retain);
+    default: // use base class implementation
+        return Datagram::getField(field);
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief method to write data of Datagram by the id of its field
+ *
+ * @param field id of the field, as returned by getFieldId()
+ * @param value value to be set for the field
+ */
+void DatagramMqtt::setField(FieldId field, const DataType & value)
+{
+    switch (field)
+    {
+    case FIELD_ACTION:
+        m_action = convertDataTypeToString(value);
+        break;
+    case FIELD_TOPIC:
+        m_topic = convertDataTypeToString(value);
+        break;
+    case FIELD_CONTENT:
+        m_content = convertDataTypeToString(value);
+        break;
+    case FIELD_USER_INFO:
+        m_userInfo = convertDataTypeToString(value);
+        break;
+    case FIELD_QOS:
+        m_qos = static_cast<uint8_t>(convertDataTypeToUint(value));
+        break;
+    case FIELD_RETAIN:
+        m_retain = convertDataTypeToBoolean(value);
+        break;
+    default: // use base class implementation
+        Datagram::setField(field, value);
+    }
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief creates a string representation of this Datagram
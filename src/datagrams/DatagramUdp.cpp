@@ -19,6 +19,9 @@
  *
  */
 
+// std includes
+#include <unordered_map>
+
 // self include
 #include "DatagramUdp.hpp"
 
@@ -99,6 +102,25 @@ const string & DatagramUdp::getPayload() const
     return m_payload;
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief resolves the name of a field to its id
+ *
+ * @param key name of the field, as used with getData()
+ * @return FieldId id of the field, or FIELD_NONE if @p key is no field of DatagramUdp
+ */
+FieldId DatagramUdp::getFieldId(const string & key)
+{
+    static const unordered_map<string, FieldId> fieldIds = {
+        { "sender", FIELD_SENDER },
+        { "receiver", FIELD_RECEIVER },
+        { "port", FIELD_PORT },
+        { "payload", FIELD_PAYLOAD }
+    };
+    auto fieldId = fieldIds.find(key);
+    return fieldId != fieldIds.end() ? fieldId->second : Datagram::getFieldId(key);
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief method to access data of Datagram under just one name
@@ -108,21 +130,10 @@ const string & DatagramUdp::getPayload() const
  */
 DataType DatagramUdp::getData(const string & key) const try
 {
-    if (key == string("sender"))
+    FieldId field = getFieldId(key);
+    if (field != FIELD_NONE)
     {
-        return m_sender;
-    }
-    else if (key == string("receiver"))
-    {
-        return m_receiver;
-    }
-    else if (key == string("port"))
-    {
-        return m_port;
-    }
-    else if (key == string("payload"))
-    {
-        return m_payload;
+        return getField(field);
     }
     else // use base class implementation
     {
@@ -147,21 +158,10 @@ catch (exception & e)
  */
 void DatagramUdp::setData(const string & key, const DataType & value) try
 {
-    if (key == string("sender"))
-    {
-        m_sender = convertDataTypeToString(value);
-    }
-    else if (key == string("receiver"))
-    {
-        m_receiver = convertDataTypeToString(value);
-    }
-    else if (key == string("port"))
-    {
-        m_port = convertDataTypeToUint(value);
-    }
-    else if (key == string("payload"))
+    FieldId field = getFieldId(key);
+    if (field != FIELD_NONE)
     {
-        m_payload = convertDataTypeToString(value);
+        setField(field, value);
     }
     else // use base class implementation
     {
@@ -177,6 +177,58 @@ catch (exception & e)
     throw std::runtime_error(string("DatagramUdp::setData(): ") + e.what());
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief method to access data of Datagram by the id of its field
+ *
+ * @param field id of the field, as returned by getFieldId()
+ * @return DataType value of the field
+ */
+DataType DatagramUdp::getField(FieldId field) const
+{
+    switch (field)
+    {
+    case FIELD_SENDER:
+        return m_sender;
+    case FIELD_RECEIVER:
+        return m_receiver;
+    case FIELD_PORT:
+        return m_port;
+    case FIELD_PAYLOAD:
+        return m_payload;
+    default: // use base class implementation
+        return Datagram::getField(field);
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief method to write data of Datagram by the id of its field
+ *
+ * @param field id of the field, as returned by getFieldId()
+ * @param value value to be set for the field
+ */
+void DatagramUdp::setField(FieldId field, const DataType & value)
+{
+    switch (field)
+    {
+    case FIELD_SENDER:
+        m_sender = convertDataTypeToString(value);
+        break;
+    case FIELD_RECEIVER:
+        m_receiver = convertDataTypeToString(value);
+        break;
+    case FIELD_PORT:
+        m_port = convertDataTypeToUint(value);
+        break;
+    case FIELD_PAYLOAD:
+        m_payload = convertDataTypeToString(value);
+        break;
+    default: // use base class implementation
+        Datagram::setField(field, value);
+    }
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief creates a string representation of this Datagram
@@ -20,6 +20,8 @@
  */
 
 // std includes
+#include <cstring>
+#include <iostream>
 #include <system_error>
 
 // self include
@@ -35,18 +37,37 @@ using namespace std;
  * @param parent the parent Plag this TransportLayer interface reports to
  * @param serverIP the IP of the server this client connects to
  * @param port port number under whicht to connect to server
+ * @param ioBackend whether to use boost or io_uring for receiving and sending (boost, if io_uring
+ * is not available)
  */
 TcpClient::TcpClient(const std::chrono::milliseconds & timeout,
-                     const Plag & parent, const string & serverIP, uint16_t port) try :
+                     Plag & parent, const string & serverIP, uint16_t port,
+                     IoBackend ioBackend) try :
     TransportLayer(timeout),
     m_parent(parent),
     m_endpoint(boost::asio::ip::address::from_string(serverIP), port),
-    m_ioContext(),
+    m_ioContext(parent.getIoContext()),
     m_socket(nullptr),
     m_receiveBuffer(""),
-    m_isConnected(false)
+    m_isConnected(false),
+    m_isConnecting(false),
+    m_connectHandled(false),
+    m_connection(0),
+    m_ioBackend(ioBackend)
+#ifdef IORING_RECV_MULTISHOT
+    , m_ringArmed(false)
+#endif
 {
     m_type = TCP_CLIENT;
+#ifdef IORING_RECV_MULTISHOT
+    if (m_ioBackend == IO_URING_BACKEND && !IoUring::isSupported())
+#else
+    if (m_ioBackend == IO_URING_BACKEND)
+#endif
+    {
+        cout << "TcpClient cannot use io_uring on this system, using asio" << endl;
+        m_ioBackend = ASIO_BACKEND;
+    }
 }
 catch (exception & e)
 {
@@ -55,38 +76,102 @@ catch (exception & e)
 
 /**
  *--------------------------------------------------------------------------------------------------
- * @brief attempt a TCP connection using the given member data, set up at construction
- * 
- * @param timeout user may set timeout, if this takes longer than the default-value (1000 => 1s).
+ * @brief starts a TCP connection attempt using the given member data, set up at construction, and
+ * returns right away
+ * @details The async connect operation completes on the strand of the parent Plag. The attempt is
+ * over, once isConnecting() returns false.
+ *
+ * @param timeout time after which isConnecting() aborts the attempt
+ * @sa TcpClient::isConnecting()
  */
-void TcpClient::connect(const std::chrono::milliseconds & timeout) try
+void TcpClient::startConnect(const std::chrono::milliseconds & timeout) try
 {
-    if (!isConnected())
-    {
-        m_ioContext.reset();
-        m_socket.reset(new boost::asio::ip::tcp::socket(m_ioContext));
-        m_socket->async_connect(m_endpoint,
-                                boost::bind(&TcpClient::handleBoostConnect, this,
-                                            boost::placeholders::_1));
+    if (m_isConnecting || isConnected()) return;
+    m_socket.reset(new boost::asio::ip::tcp::socket(m_ioContext));
+    ++m_connection;
+    m_connectHandled = false;
+    m_connectDeadline = std::chrono::steady_clock::now() + timeout;
+    m_isConnecting = true;
+    m_socket->async_connect(m_endpoint,
+                            boost::asio::bind_executor(m_parent.getStrand(),
+                                                       boost::bind(&TcpClient::handleConnect, this,
+                                                                   boost::placeholders::_1,
+                                                                   m_connection)));
+}
+catch (exception & e)
+{
+    m_isConnecting = false;
+    throw std::runtime_error(string("Happened in TcpClient::startConnect : ") + e.what());
+}
 
-        m_ioContext.run_one_for(std::chrono::milliseconds(timeout.count()));
-        m_ioContext.poll();
-        if (!isConnected())
+/**
+ *--------------------------------------------------------------------------------------------------
+ * @brief checks on the attempt of startConnect(). Once the async connect operation returned, this
+ * completes the connection (i.e. starts the receive operation) or drops the socket. An attempt
+ * beyond its timeout is aborted.
+ *
+ * @return true while the attempt is still going on
+ * @return false once it is over (isConnected() tells the outcome), or if there is none
+ */
+bool TcpClient::isConnecting() try
+{
+    if (!m_isConnecting) return false;
+    if (!m_connectHandled)
+    {
+        if (std::chrono::steady_clock::now() >= m_connectDeadline && m_socket->is_open())
         {
-            m_socket->close();
-            m_ioContext.run_for(std::chrono::milliseconds(timeout.count()));
+            // the aborted connect operation returns soon after
+            try { m_socket->close(); }
+            catch (...) {}
         }
+        return true;
     }
+    m_isConnecting = false;
+    if (!m_connectError && m_socket->is_open())
+    {
+        m_isConnected = true;
+#ifdef IORING_RECV_MULTISHOT
+        if (m_ioBackend == IO_URING_BACKEND) initRingReceive();
+        else initBoostReceive();
+#else
+        initBoostReceive();
+#endif
+    }
+    else
+    {
+        m_socket.reset();
+    }
+    return false;
 }
 catch (exception & e)
 {
-    throw std::runtime_error(string("Happened in TcpClient::connect : ") + e.what());
+    throw std::runtime_error(string("Happened in TcpClient::isConnecting : ") + e.what());
+}
+
+/**
+ *--------------------------------------------------------------------------------------------------
+ * @brief TcpClient::handleConnect is called, when the async connect operation of startConnect()
+ * returns. It runs on the strand of the parent Plag, so it only records the outcome and wakes up
+ * the parent Plag, which takes it with its next call of isConnecting().
+ *
+ * @param error a boost error code, remarking either a successful connect or a failure
+ * @param connection number of the socket, that connected
+ */
+void TcpClient::handleConnect(const boost::system::error_code & error, unsigned int connection)
+{
+    // the socket was closed by disconnect() meanwhile
+    if (connection != m_connection) return;
+    m_connectError = error;
+    m_connectHandled = true;
+    m_parent.notify();
 }
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief closes socket, empties async interface and resets socket
- * 
+ * @brief closes socket, empties async interface and resets socket, without waiting
+ * @details The aborted receive or connect operation returns later on and its handler ignores it,
+ * as m_connection moved on. A multishot receive of the io_uring still ends with a completion:
+ * its handler holds the io_uring until then and closes it.
  */
 void TcpClient::disconnect() try
 {
@@ -98,17 +183,16 @@ void TcpClient::disconnect() try
         try { m_socket->close(); }
         catch (...) {}
 
-        try { m_ioContext.poll(); }
-        catch (...) {}
-
-        try { std::this_thread::sleep_for(std::chrono::milliseconds(100)); }
-        catch (...) {}
-
-        try { m_ioContext.poll(); }
-        catch (...) {}
-
+#ifdef IORING_RECV_MULTISHOT
+        m_ringEvents.reset();
+        m_receiveRing.reset();
+        m_sendRing.reset();
+        m_ringArmed = false;
+#endif
         m_socket.reset();
     }
+    ++m_connection;
+    m_isConnecting = false;
     m_isConnected = false;
 }
 catch (exception & e)
@@ -126,7 +210,6 @@ catch (exception & e)
  */
 bool TcpClient::isConnected() try
 {
-    m_ioContext.poll();
     if (m_socket == nullptr || !m_socket->is_open()) disconnect();
     return m_isConnected;
 }
@@ -143,7 +226,7 @@ catch (exception & e)
  */
 size_t TcpClient::getAvailableBytesCount() try
 {
-    m_ioContext.poll();
+    const lock_guard<mutex> lock(m_mtxReceiveBuffer);
     return m_receiveBuffer.size();
 }
 catch (exception & e)
@@ -176,8 +259,18 @@ string TcpClient::receiveBytes(size_t numberOfBytes) try
 
     if (this->getAvailableBytesCount() < numberOfBytes) throw std::runtime_error("Reached Timeout!");
 
-    string requestedData = m_receiveBuffer.substr(0, numberOfBytes);
-    m_receiveBuffer.erase(0, numberOfBytes);
+    const lock_guard<mutex> lock(m_mtxReceiveBuffer);
+    string requestedData;
+    // handing over the entire buffer is the common case and needs no copy
+    if (numberOfBytes == m_receiveBuffer.size())
+    {
+        requestedData.swap(m_receiveBuffer);
+    }
+    else
+    {
+        requestedData = m_receiveBuffer.substr(0, numberOfBytes);
+        m_receiveBuffer.erase(0, numberOfBytes);
+    }
 
     return requestedData;
 }
@@ -220,7 +313,15 @@ catch (exception & e)
 void TcpClient::transmit(const string & appData) try
 {
     if (!isConnected()) throw std::runtime_error("Cannot transmit, when not connected!");
-    m_socket->write_some(boost::asio::buffer(appData));
+#ifdef IORING_RECV_MULTISHOT
+    if (m_ioBackend == IO_URING_BACKEND)
+    {
+        transmitWithRing(appData);
+        return;
+    }
+#endif
+    // write_some() may stop short, which gets likely with packets written in one go
+    boost::asio::write(*m_socket, boost::asio::buffer(appData));
 }
 catch (std::runtime_error & e)
 {
@@ -233,74 +334,217 @@ catch (exception & e)
 }
 
 /**
- *-------------------------------------------------------------------------------------------------
- * @brief Gets called, when boost's connect operation returns and acts accordingly
- * @details If connect operation is successful, sets connected state to true and inits
- * receive operation. Otherwise re-throws the boost error
+ * -------------------------------------------------------------------------------------------------
+ * @brief initiates an async_receive operation on the socket, if there is a connection
+ */
+void TcpClient::initBoostReceive() try
+{
+    if (!m_isConnected) throw std::runtime_error("Cannot start receiver, when not connected");
+    m_socket->async_receive(boost::asio::buffer(m_boostsReceiveBuffer, RECEIVE_BUFFER_SIZE),
+                            boost::asio::bind_executor(m_parent.getStrand(),
+                                                       boost::bind(&TcpClient::handleBoostReceive,
+                                                                   this, boost::placeholders::_1,
+                                                                   boost::placeholders::_2,
+                                                                   m_connection)));
+}
+catch (std::runtime_error & e)
+{
+    disconnect();
+    throw std::runtime_error(string("Happened in TcpClient::initBoostReceive : ") + e.what());
+}
+catch (exception & e)
+{
+    throw std::runtime_error(string("Happened in TcpClient::initBoostReceive : ") + e.what());
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief TcpClient::handleBoostReceive is called when async_receive yields data (or fails). It
+ * runs on the strand of the parent Plag and wakes up the parent Plag to handle the data.
  *
- * @param error a boost error code, remarking either a successful return or a failure (e.g. connection rejected)
- * @sa TcpClient::intiBoostReceive()
+ * @param error a boost error code, remarking either a successful return or a failure (e.g. connection closed)
+ * @param n number of bytes received
+ * @param connection number of the socket, that received
  */
-void TcpClient::handleBoostConnect(const boost::system::error_code & error) try
+void TcpClient::handleBoostReceive(const boost::system::error_code & error, std::size_t n,
+                                   unsigned int connection) try
 {
+    // the socket was closed by disconnect() meanwhile
+    if (connection != m_connection) return;
     if (error)
     {
-        // async_connect failed
+        // the connection is gone, so let the parent reconnect
+        m_isConnected = false;
+        m_parent.notify();
+        if (error == boost::asio::error::operation_aborted
+            || error == boost::asio::error::bad_descriptor) return;
         throw boost::system::system_error(error);
     }
     else
     {
-        // async_connect was successful
-        m_isConnected = true;
-        initBoostReceive();
+        {
+            const lock_guard<mutex> lock(m_mtxReceiveBuffer);
+            m_receiveBuffer.append(m_boostsReceiveBuffer, n); // reads n bytes from async to internal buffer
+        }
+        initBoostReceive();                                  // start next receive "interval"
+        m_parent.notify();
     }
 }
 catch (exception & e)
 {
-    throw std::runtime_error(string("Happened in TcpClient::handleBoostConnect : ") + e.what());
+    throw std::runtime_error(string("Happened in TcpClient::handleBoostReceive : ") + e.what());
 }
 
+#ifdef IORING_RECV_MULTISHOT
 /**
  * -------------------------------------------------------------------------------------------------
- * @brief initiates an async_receive operation on the socket, if there is a connection
+ * @brief sets up the io_uring for receiving on a new connection, submits its multishot receive
+ * and waits for the completions on the eventfd of the io_uring
  */
-void TcpClient::initBoostReceive() try
+void TcpClient::initRingReceive() try
 {
-    if (!isConnected()) throw std::runtime_error("Cannot start receiver, when not connected");
-    m_socket->async_receive(boost::asio::buffer(m_boostsReceiveBuffer, RECEIVE_BUFFER_SIZE),
-                            boost::bind(&TcpClient::handleBoostReceive, this,
-                                        boost::placeholders::_1, boost::placeholders::_2));
+    if (!m_isConnected) throw std::runtime_error("Cannot start receiver, when not connected");
+    if (!m_receiveRing)
+    {
+        m_receiveRing.reset(new IoUring(4));
+        m_receiveRing->registerBuffers(RING_BUFFER_COUNT, RECEIVE_BUFFER_SIZE);
+        m_ringEvents.reset(new boost::asio::posix::stream_descriptor(m_ioContext,
+                                                                     m_receiveRing->openEventFd()));
+        m_ringArmed = false;
+    }
+    if (!m_ringArmed)
+    {
+        m_receiveRing->prepareReceive(m_socket->native_handle(), 0);
+        m_receiveRing->submit();
+        m_ringArmed = true;
+    }
+    awaitRingCompletions(m_receiveRing, m_ringEvents, m_connection);
 }
 catch (std::runtime_error & e)
 {
     disconnect();
-    throw std::runtime_error(string("Happened in TcpClient::initBoostReceive : ") + e.what());
+    throw std::runtime_error(string("Happened in TcpClient::initRingReceive : ") + e.what());
 }
 catch (exception & e)
 {
-    throw std::runtime_error(string("Happened in TcpClient::initBoostReceive : ") + e.what());
+    throw std::runtime_error(string("Happened in TcpClient::initRingReceive : ") + e.what());
 }
 
 /**
  * -------------------------------------------------------------------------------------------------
- * @brief TcpClient::handleBoostReceive is called when async_receive yields data (or fails)
+ * @brief TcpClient::handleRingReceive is called, when the io_uring completed receives. It takes
+ * their data, returns the buffers and wakes up the parent Plag, like handleBoostReceive(). A
+ * receive of 0 bytes or an error ends the connection; a receive ended for lack of buffers
+ * (ENOBUFS) is submitted again.
+ * Once disconnect() closed the socket, this only waits for the last completion of the multishot
+ * receive: as the handler holds the last references, the io_uring is closed after that.
  *
- * @param error a boost error code, remarking either a successful return or a failure (e.g. connection closed)
- * @param n number of bytes received
+ * @param error a boost error code of waiting for the eventfd
+ * @param receiveRing the io_uring, that completed the receives
+ * @param ringEvents the eventfd of @p receiveRing
+ * @param connection number of the socket, that received
  */
-void TcpClient::handleBoostReceive(const boost::system::error_code & error, std::size_t n) try
+void TcpClient::handleRingReceive(const boost::system::error_code & error,
+                                  std::shared_ptr<IoUring> receiveRing,
+                                  std::shared_ptr<boost::asio::posix::stream_descriptor> ringEvents,
+                                  unsigned int connection) try
 {
+    bool isCurrent = connection == m_connection;
     if (error)
     {
+        if (!isCurrent || error == boost::asio::error::operation_aborted
+            || error == boost::asio::error::bad_descriptor) return;
+        m_isConnected = false;
+        m_parent.notify();
         throw boost::system::system_error(error);
     }
-    else
+    receiveRing->clearEventFd();
+    bool connectionEnded = false;
+    bool armed = true;
     {
-        m_receiveBuffer.append(m_boostsReceiveBuffer, n); // reads n bytes from async to internal buffer
-        initBoostReceive();                              // start next receive "interval"
+        const lock_guard<mutex> lock(m_mtxReceiveBuffer);
+        receiveRing->reapCompletions([this, &receiveRing, &connectionEnded, &armed, isCurrent]
+                                     (uint64_t, int32_t result, uint32_t flags)
+        {
+            if (!(flags & IORING_CQE_F_MORE)) armed = false;
+            if (flags & IORING_CQE_F_BUFFER)
+            {
+                uint16_t bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+                if (result > 0 && isCurrent) m_receiveBuffer.append(receiveRing->getBuffer(bufferId), result);
+                receiveRing->recycleBuffer(bufferId);
+            }
+            if (result == 0 || (result < 0 && result != -ENOBUFS)) connectionEnded = true;
+        });
     }
+    if (!isCurrent)
+    {
+        if (armed) awaitRingCompletions(receiveRing, ringEvents, connection);
+        return;
+    }
+    if (!armed) m_ringArmed = false;
+    if (connectionEnded)
+    {
+        // the connection is gone, so let the parent reconnect
+        m_isConnected = false;
+        m_parent.notify();
+        // disconnect() hands a still armed receive over to this handler
+        if (armed) awaitRingCompletions(receiveRing, ringEvents, connection);
+        return;
+    }
+    initRingReceive();                                       // start next receive "interval"
+    m_parent.notify();
 }
 catch (exception & e)
 {
-    throw std::runtime_error(string("Happened in TcpClient::handleBoostReceive : ") + e.what());
+    throw std::runtime_error(string("Happened in TcpClient::handleRingReceive : ") + e.what());
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief waits for the eventfd of @p receiveRing, to call handleRingReceive() on the strand of the
+ * parent Plag. The handler holds @p receiveRing and @p ringEvents, until it returns.
+ *
+ * @param receiveRing the io_uring of the multishot receive
+ * @param ringEvents the eventfd of @p receiveRing
+ * @param connection number of the socket, that receives
+ */
+void TcpClient::awaitRingCompletions(std::shared_ptr<IoUring> receiveRing,
+                                     std::shared_ptr<boost::asio::posix::stream_descriptor> ringEvents,
+                                     unsigned int connection)
+{
+    ringEvents->async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                           boost::asio::bind_executor(m_parent.getStrand(),
+                                                      boost::bind(&TcpClient::handleRingReceive, this,
+                                                                  boost::placeholders::_1,
+                                                                  receiveRing, ringEvents,
+                                                                  connection)));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief sends all of @p appData via m_sendRing, waiting for each send to complete
+ *
+ * @param appData the data to send
+ *
+ * @throws std::system_error if a send fails
+ */
+void TcpClient::transmitWithRing(const string & appData)
+{
+    if (!m_sendRing) m_sendRing.reset(new IoUring(2));
+    size_t offset = 0;
+    while (offset < appData.size())
+    {
+        m_sendRing->prepareSend(m_socket->native_handle(), appData.data() + offset,
+                                appData.size() - offset, 0);
+        m_sendRing->submit(1);
+        int32_t sent = 0;
+        m_sendRing->reapCompletions([&sent](uint64_t, int32_t result, uint32_t)
+                                    {
+                                        sent = result;
+                                    });
+        if (sent < 0) throw system_error(-sent, generic_category(), "io_uring send");
+        if (sent == 0) throw std::runtime_error("Connection closed while sending");
+        offset += static_cast<size_t>(sent);
+    }
 }
+#endif
@@ -32,6 +32,7 @@
 #include "PlagMqtt.hpp"
 #include "PlagUdp.hpp"
 #include "PlagHttpServer.hpp"
+#include "Runtime.hpp"
 #include "Utilities.hpp"
 
 using namespace std;
@@ -118,6 +119,10 @@ int main(int argc, char * argv[])
     boost::property_tree::ptree propertyTree;
     boost::property_tree::ini_parser::read_ini(configFilePath, propertyTree);
 
+    // the event loop and its threads, shared by all Plags (must outlive them)
+    Runtime runtime(propertyTree);
+    cout << "Runtime uses " << runtime.getThreadCount() << " threads" << endl;
+
     // constructing the Plags
     map<string, shared_ptr<Plag>> allPlags;
     bool stillHasPlags = true;
@@ -134,17 +139,17 @@ int main(int argc, char * argv[])
             cout << "Found Plag at index " << index << " with type " << type << " and name " << name << endl;
             if (type == "mqtt")
             {
-                shared_ptr<Plag> sharedPlag(new PlagMqtt(propertyTree, name, index));
+                shared_ptr<Plag> sharedPlag(new PlagMqtt(propertyTree, runtime, name, index));
                 allPlags.insert_or_assign(name, sharedPlag);
             }
             else if (type == "udp")
             {
-                shared_ptr<Plag> sharedPlag(new PlagUdp(propertyTree, name, index));
+                shared_ptr<Plag> sharedPlag(new PlagUdp(propertyTree, runtime, name, index));
                 allPlags.insert_or_assign(name, sharedPlag);
             }
             else if (type == "httpserver")
             {
-                shared_ptr<Plag> sharedPlag(new PlagHttpServer(propertyTree, name, index));
+                shared_ptr<Plag> sharedPlag(new PlagHttpServer(propertyTree, runtime, name, index));
                 allPlags.insert_or_assign(name, sharedPlag);
             }
             index++;
@@ -177,6 +182,7 @@ int main(int argc, char * argv[])
             }
 
             allKables.insert_or_assign(source, shared_ptr<Kable>(new Kable(propertyTree, kableKey,
+                                                                           runtime,
                                                                            allPlags.at(source),
                                                                            allPlags.at(target))));
             allPlags.at(source)->attachKable(allKables.at(source));
@@ -190,6 +196,8 @@ int main(int argc, char * argv[])
 
     bool atLeastOneThreadRunning = true;
 
+    runtime.start();
+
     cout << "Initializing Plags..." << endl;
     for (const pair<string, shared_ptr<Plag>> & plagEntry : allPlags)
     {
@@ -234,8 +242,14 @@ int main(int argc, char * argv[])
     {
         plagEntry.second->stopWork();
     }
+    runtime.stop();
     cout << "Plags stoped." << endl;
 
+    for (const auto & plagEntry : allPlags)
+    {
+        cout << plagEntry.second->getStatistics() << endl;
+    }
+
     cout << "Done. See you World!" << endl;
 
     return 0;
@@ -23,7 +23,6 @@
 #include <iostream>
 #include <vector>
 #include <chrono>
-#include <thread>
 
 // own includes
 
@@ -90,21 +89,8 @@ int PlagHttpServerConnection::resvDatagramInterface(lua_State * L)
     auto castParentPtr = dynamic_cast<PlagHttpServer *>(m_ptrParentPlag);
 
     // some consts and variables
-    const int waitingTime = 5000; // TODO: Make this a paramter
-    auto start = std::chrono::high_resolution_clock::now();
-    auto dgram = castParentPtr->resvDatagram(m_reqIds);
-        
-    while (dgram  == nullptr)
-    {
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> elapsed = end - start;
-        if (elapsed.count() >= waitingTime)
-        {
-            break;
-        }
-        std::this_thread::sleep_for(1ms);
-        dgram = castParentPtr->resvDatagram(m_reqIds);
-    }
+    const std::chrono::milliseconds waitingTime(5000); // TODO: Make this a paramter
+    auto dgram = castParentPtr->resvDatagram(m_reqIds, waitingTime);
     
     if (dgram != nullptr)
     {
@@ -120,12 +106,28 @@ int PlagHttpServerConnection::resvDatagramInterface(lua_State * L)
 
 /**
  * -------------------------------------------------------------------------------------------------
- * @brief workingRequest Handles the request
+ * @brief workingRequest Handles the request. Answers to the Datagrams its script sent, that arrive
+ * afterwards, are dropped.
  *
  * @param req The request
  * @return HttpResponse The response
 */
 HttpResponse PlagHttpServerConnection::workingRequest(HttpRequest req)
+{
+    HttpResponse resp = runScript(req);
+    dynamic_cast<PlagHttpServer *>(m_ptrParentPlag)->closeRequests(m_reqIds);
+    m_reqIds.clear();
+    return resp;
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief runScript runs the script of the endpoint of the request
+ *
+ * @param req The request
+ * @return HttpResponse The response
+*/
+HttpResponse PlagHttpServerConnection::runScript(HttpRequest & req)
 {
     auto header = req.getHeader();
     auto params = req.getParams();
@@ -216,9 +218,11 @@ HttpResponse PlagHttpServerConnection::workingRequest(HttpRequest req)
  * @brief Construct a new Plag HttpServer:: Plag HttpServer object assigns default values
  * 
  */
-PlagHttpServer::PlagHttpServer(const boost::property_tree::ptree & propTree,
+PlagHttpServer::PlagHttpServer(const boost::property_tree::ptree & propTree, Runtime & runtime,
                  const std::string & name, const uint64_t & id) :
-    Plag(propTree, name, id, PlagType::HttpServer)
+    Plag(propTree, runtime, name, id, PlagType::HttpServer),
+    m_requestThreads(2),
+    m_closing(false)
 {
     readConfig();
 }
@@ -233,9 +237,13 @@ PlagHttpServer::~PlagHttpServer()
     if (!m_stopToken) stopWork();
     try
     {
-        m_ioContext.stop();
-        // wait until the ioService is stopped
-        while (!m_ioContext.stopped()) {}
+        {
+            const lock_guard<mutex> lock(m_mtxRecv);
+            m_closing = true;
+        }
+        m_answerPlaced.notify_all();
+        m_tcpServer.reset();
+        if (m_requestPool) m_requestPool->join();
     }
     catch (exception & e)
     {
@@ -255,6 +263,7 @@ PlagHttpServer::~PlagHttpServer()
 void PlagHttpServer::readConfig() try
 {
     m_port = getParameter<uint16_t>("port");
+    m_requestThreads = max(getOptionalParameter<unsigned int>("requestThreads", 2), 1u);
 
     size_t idx = 1;
 
@@ -331,10 +340,10 @@ catch (exception & e)
  */
 void PlagHttpServer::init() try
 {
-    m_tcpServer = shared_ptr<AsyncHttpServer<PlagHttpServerConnection>>(new AsyncHttpServer<PlagHttpServerConnection>(m_ioContext, this, m_port));
-    m_ioContextThread = shared_ptr<thread>(new thread([this]() {
-        this->m_ioContext.run();
-    }));
+    // the connections are accepted on the Runtime, but served by threads of their own, as they
+    // read blocking and their scripts wait for answers, which the Runtime has to deliver meanwhile
+    m_requestPool.reset(new boost::asio::thread_pool(m_requestThreads));
+    m_tcpServer = shared_ptr<AsyncHttpServer<PlagHttpServerConnection>>(new AsyncHttpServer<PlagHttpServerConnection>(m_ioContext, this, m_requestPool->get_executor(), m_port));
 }
 catch (exception & e)
 {
@@ -346,12 +355,35 @@ catch (exception & e)
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief PlagHttpServer::loopWork regularly reads on the socket, if data popped in or sends data
- * 
+ * @brief PlagHttpServer::loopWork files the answers from the incoming queue for the scripts
+ * waiting for them, and notifies these
+ * @details Answers may arrive in any order, so they are moved to m_pendingResponses, keyed by
+ * their reqId. An answer to a request, that is not open (anymore), is dropped, as is an older
+ * answer to the same request.
+ *
+ * @return true if answers were taken from the incoming queue
  */
 bool PlagHttpServer::loopWork() try
 {
-    // we do not need to do any work here :-)
+    // distribution is woken up by sendDatagram()
+    vector<shared_ptr<Datagram>> datagrams;
+    if (takeFromIncoming(datagrams, m_maxBatch) == 0) return false;
+    {
+        const lock_guard<mutex> lock(m_mtxRecv);
+        for (const shared_ptr<Datagram> & datagram : datagrams)
+        {
+            const shared_ptr<DatagramHttpServer> castPtr = dynamic_pointer_cast<DatagramHttpServer>(datagram);
+            if (castPtr == nullptr || m_openRequests.count(castPtr->getReqId()) == 0)
+            {
+                m_droppedDatagrams++;
+                continue;
+            }
+            shared_ptr<DatagramHttpServer> & pending = m_pendingResponses[castPtr->getReqId()];
+            if (pending != nullptr) m_droppedDatagrams++;
+            pending = castPtr;
+        }
+    }
+    m_answerPlaced.notify_all();
     return true;
 }
 catch (exception & e)
@@ -378,11 +410,15 @@ void PlagHttpServer::placeDatagram(const shared_ptr<Datagram> datagram) try
         {
             if (it->endpointDef.endpoint == castPtr->getReqId())
             {
-                it->stateDgram = castPtr;
+                {
+                    const lock_guard<mutex> lock(m_mtxRecv);
+                    it->stateDgram = castPtr;
+                }
+                m_answerPlaced.notify_all();
                 return;
             }
         }
-        m_incommingDatagrams.push_back(datagram);
+        appendToIncoming(datagram);
     }
 }
 catch (exception & e)
@@ -407,6 +443,11 @@ int PlagHttpServer::sendDatagram(std::shared_ptr<DatagramHttpServer> dgram)
     static int reqId = 0;
 
     dgram->setReqId(to_string(reqId));
+    {
+        // registered before it is sent, as the answer may arrive right away
+        const lock_guard<mutex> lock(m_mtxRecv);
+        m_openRequests.insert(dgram->getReqId());
+    }
     
     appendToDistribution(dgram);
 
@@ -415,26 +456,44 @@ int PlagHttpServer::sendDatagram(std::shared_ptr<DatagramHttpServer> dgram)
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief PlagHttpServer::resvDatagram receives a Datagram from the previous Plag in the chain
+ * @brief PlagHttpServer::resvDatagram receives a Datagram from the previous Plag in the chain. It
+ * waits for loopWork() (or placeDatagram()) to place it, without polling.
  * 
  * @param reqIds The ids of the Datagram to receive
- * @return std::shared_ptr<DatagramHttpServer> The Datagram
+ * @param timeout how long to wait at most
+ * @return std::shared_ptr<DatagramHttpServer> The Datagram, nullptr if none arrived in time
  */
-std::shared_ptr<DatagramHttpServer> PlagHttpServer::resvDatagram(const vector<string> & reqIds)
+std::shared_ptr<DatagramHttpServer> PlagHttpServer::resvDatagram(const vector<string> & reqIds,
+                                                                 std::chrono::milliseconds timeout)
 {
-    const lock_guard<mutex> lock(m_mtxRecv);
+    unique_lock<mutex> lock(m_mtxRecv);
+    shared_ptr<DatagramHttpServer> answer;
+    m_answerPlaced.wait_for(lock, timeout, [this, &reqIds, &answer]()
+    {
+        answer = takeAnswer(reqIds);
+        return answer != nullptr || m_closing;
+    });
+    return answer;
+}
 
-    for (auto dgramIt = m_incommingDatagrams.begin();
-                dgramIt != m_incommingDatagrams.end(); dgramIt++)
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief PlagHttpServer::takeAnswer takes the answer to one of @p reqIds from m_pendingResponses,
+ * or else the state Datagram of an endpoint among them. To be called with m_mtxRecv locked.
+ *
+ * @param reqIds The ids of the Datagram to receive
+ * @return std::shared_ptr<DatagramHttpServer> The Datagram, nullptr if there is none
+ */
+std::shared_ptr<DatagramHttpServer> PlagHttpServer::takeAnswer(const vector<string> & reqIds)
+{
+    for (const string & reqId : reqIds)
     {
-        const shared_ptr<DatagramHttpServer> castPtr = dynamic_pointer_cast<DatagramHttpServer>(*dgramIt);
-        for (auto reqId : reqIds)
+        auto pending = m_pendingResponses.find(reqId);
+        if (pending != m_pendingResponses.end())
         {
-            if (reqId == castPtr->getReqId())
-            {
-                m_incommingDatagrams.erase(dgramIt);
-                return castPtr;
-            }
+            shared_ptr<DatagramHttpServer> answer = move(pending->second);
+            m_pendingResponses.erase(pending);
+            return answer;
         }
     }
 
@@ -450,4 +509,21 @@ std::shared_ptr<DatagramHttpServer> PlagHttpServer::resvDatagram(const vector<st
     }
     
     return nullptr;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief PlagHttpServer::closeRequests ends the requests of a script, that finished (or timed
+ * out waiting). Answers to them, that were not picked up, are dropped, as are later ones.
+ *
+ * @param reqIds The ids the script used
+ */
+void PlagHttpServer::closeRequests(const vector<string> & reqIds)
+{
+    const lock_guard<mutex> lock(m_mtxRecv);
+    for (const string & reqId : reqIds)
+    {
+        m_openRequests.erase(reqId);
+        m_droppedDatagrams += m_pendingResponses.erase(reqId);
+    }
 }
\ No newline at end of file
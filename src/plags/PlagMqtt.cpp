@@ -40,9 +40,9 @@ using namespace std;
  * @brief Construct a new PlagMqtt::PlagMqtt object assigns default values
  * 
  */
-PlagMqtt::PlagMqtt(const boost::property_tree::ptree & propTree,
+PlagMqtt::PlagMqtt(const boost::property_tree::ptree & propTree, Runtime & runtime,
                    const std::string & name, const uint64_t & id) :
-    Plag(propTree, name, id, PlagType::MQTT)
+    Plag(propTree, runtime, name, id, PlagType::MQTT)
 {
     readConfig();
 }
@@ -92,6 +92,19 @@ void PlagMqtt::readConfig() try
 
     m_cleanSessions = getOptionalParameter<bool>("cleanSessions", false);
 
+    string ioBackend = getOptionalParameter<string>("ioBackend", "asio");
+    if (ioBackend == "asio") m_ioBackend = ASIO_BACKEND;
+    else if (ioBackend == "io_uring") m_ioBackend = IO_URING_BACKEND;
+    else throw std::invalid_argument("Unknown ioBackend in settings: \"" + ioBackend + "\"");
+
+    m_maxFlushDelay = chrono::microseconds(getOptionalParameter<unsigned int>("maxFlushDelay", 0));
+    m_maxFlushSize = max<size_t>(getOptionalParameter<size_t>("maxFlushSize", 65536), 1);
+    m_maxTopicAliases = getOptionalParameter<uint16_t>("maxTopicAliases", 1024);
+    m_maxInflight = getOptionalParameter<uint16_t>("maxInflight", 1024);
+    m_retryInterval = chrono::milliseconds(getOptionalParameter<unsigned int>("retryInterval", 5000));
+    m_minReconnectDelay = chrono::milliseconds(getOptionalParameter<unsigned int>("reconnectDelayMin", 100));
+    m_maxReconnectDelay = chrono::milliseconds(getOptionalParameter<unsigned int>("reconnectDelayMax", 30000));
+
     string subscriptionsList = getOptionalParameter<string>("subscriptions", "");
     vector<string> subscriptionsPairs;
     if (subscriptionsList.size() == 0) return;
@@ -137,11 +150,22 @@ void PlagMqtt::init() try
     {
 
         string emptyString = "";
-        m_interface = shared_ptr<MqttClientV5>(new MqttClientV5(*this, m_brokerIP, m_port, "plagn",
-                                                                0, m_userName, m_userPass,
-                                                                m_keepAliveInterval, m_cleanSessions,
-                                                                emptyString, emptyString,
-                                                                m_defaultSubscriptions));
+        shared_ptr<MqttClientV5> client(new MqttClientV5(*this, m_brokerIP, m_port, "plagn",
+                                                         0, m_userName, m_userPass,
+                                                         m_keepAliveInterval, m_cleanSessions,
+                                                         emptyString, emptyString,
+                                                         m_defaultSubscriptions));
+        client->setMaxTopicAliases(m_maxTopicAliases);
+        m_interface = client;
+    }
+    shared_ptr<MqttClient> client = dynamic_pointer_cast<MqttClient>(m_interface);
+    if (client)
+    {
+        client->setIoBackend(m_ioBackend);
+        client->setFlushLimits(m_maxFlushDelay, m_maxFlushSize);
+        client->setMaxInflight(m_maxInflight);
+        client->setRetryInterval(m_retryInterval);
+        client->setReconnectDelays(m_minReconnectDelay, m_maxReconnectDelay);
     }
     m_interface->init();
 }
@@ -165,34 +189,71 @@ bool PlagMqtt::loopWork() try
         shared_ptr<MqttClient> client = dynamic_pointer_cast<MqttClient>(m_interface);
         if (!client->isConnected())
         {
-            // try to connect, when disconnected
+            // take the next step of connecting, if due; meanwhile Datagrams wait in the incoming queue
             client->connect();
-            return true;
+            // once connected, go on right away with what queued up meanwhile
+            return client->isConnected();
         }
         else
         {
             bool somethingDone = false;
-            // send Datagrams
-            if (client->hasMessages())
+            // send Datagrams (hasMessages() polls the broker once, then the parsed ones are taken)
+            // while a target holds back the distribution, the broker's packets wait in the socket
+            if (!isBackpressured() && client->hasMessages())
             {
-                appendToDistribution(client->getMessage());
+                shared_ptr<DatagramMqtt> message;
+                for (size_t i = 0; i < m_maxBatch && (message = client->getMessage()); i++)
+                {
+                    appendToDistribution(message);
+                }
                 somethingDone = true;
             }
 
-            // send MQTT messages
-            if (m_incommingDatagrams.begin() != m_incommingDatagrams.end())
+            // send MQTT messages; what a failed loop left over goes first
+            // while PUBLISHes wait for the inflight window, the rest waits in the incoming queue
+            if (m_transmitBatch.empty() && !client->hasPendingPublishes())
             {
-                shared_ptr<DatagramMqtt> castPtr;
-                castPtr = dynamic_pointer_cast<DatagramMqtt>(m_incommingDatagrams.front());
-                if (castPtr == nullptr)
+                takeFromIncoming(m_transmitBatch, m_maxBatch);
+            }
+            if (!m_transmitBatch.empty())
+            {
+                size_t transmitted = 0;
+                try
                 {
-                    m_incommingDatagrams.pop_front();
-                    return somethingDone;
+                    for (; transmitted < m_transmitBatch.size(); transmitted++)
+                    {
+                        shared_ptr<Datagram> & datagram = m_transmitBatch[transmitted];
+                        shared_ptr<DatagramMqtt> castPtr;
+                        castPtr = dynamic_pointer_cast<DatagramMqtt>(datagram);
+                        // waiting ones are marked as egressed by the client, when sent
+                        if (castPtr == nullptr || !client->transmitDatagram(castPtr)) datagram.reset();
+                    }
+                    // everything this loop produced (including acknowledgements) goes in one write
+                    client->flushDueTransmissions();
                 }
-                client->transmitDatagram(castPtr);
-                m_incommingDatagrams.pop_front();
+                catch (exception & /*unused*/)
+                {
+                    // the failed Datagram is lost, the untransmitted rest waits for the next loop
+                    if (transmitted < m_transmitBatch.size())
+                    {
+                        m_droppedDatagrams++;
+                        ++transmitted;
+                    }
+                    m_transmitBatch.erase(m_transmitBatch.begin(), m_transmitBatch.begin() + transmitted);
+                    throw;
+                }
+                chrono::steady_clock::time_point now = chrono::steady_clock::now();
+                for (const shared_ptr<Datagram> & datagram : m_transmitBatch)
+                {
+                    if (datagram) datagram->markEgress(now);
+                }
+                m_transmitBatch.clear();
                 somethingDone = true;
             }
+            else
+            {
+                client->flushDueTransmissions();
+            }
             return somethingDone;
         }
     }
@@ -205,6 +266,24 @@ catch (exception & e)
     throw eEdited;
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief counts of the MQTT packets sent to the broker, of the writes they took and (MQTT v5) of
+ * the PUBLISHes sent with a topic alias only
+ *
+ * @return std::string ", MQTT packets sent X in Y writes[, topic alias hits Z]"
+ */
+string PlagMqtt::getSpecificStatistics() const
+{
+    shared_ptr<MqttClient> client = dynamic_pointer_cast<MqttClient>(m_interface);
+    if (!client) return "";
+    string statistics = ", MQTT packets sent " + to_string(client->getQueuedPacketCount()) + " in "
+                        + to_string(client->getWriteCount()) + " writes";
+    shared_ptr<MqttClientV5> clientV5 = dynamic_pointer_cast<MqttClientV5>(m_interface);
+    if (clientV5) statistics += ", topic alias hits " + to_string(clientV5->getTopicAliasHits());
+    return statistics;
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief placeDatagram is a function to place a Datagram here. Hence this method decodes the
@@ -217,7 +296,7 @@ void PlagMqtt::placeDatagram(const shared_ptr<Datagram> datagram) try
     const shared_ptr<DatagramMqtt> castPtr = dynamic_pointer_cast<DatagramMqtt>(datagram);
     if (castPtr != nullptr)
     {
-        m_incommingDatagrams.push_back(datagram);
+        appendToIncoming(datagram);
     }
 }
 catch (exception & e)
@@ -20,8 +20,16 @@
  */
 
 // std include
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#endif
+
 // own includes
 #include "DatagramUdp.hpp"
 
@@ -35,11 +43,34 @@ using namespace std;
  * @brief Construct a new Plag Udp:: Plag Udp object assigns default values
  * 
  */
-PlagUdp::PlagUdp(const boost::property_tree::ptree & propTree,
+PlagUdp::PlagUdp(const boost::property_tree::ptree & propTree, Runtime & runtime,
                  const std::string & name, const uint64_t & id) :
-    Plag(propTree, name, id, PlagType::UDP),
+    Plag(propTree, runtime, name, id, PlagType::UDP),
+    m_syscallBatch(32),
+    m_shardCount(1),
+    m_maxDatagramSize(MAX_DATAGRAM_SIZE),
+    m_gso(false),
+    m_gro(false),
+    m_timestamps(true),
+    m_ioBackend(ASIO_BACKEND),
+    m_rcvBuf(0),
+    m_sndBuf(0),
+    m_endpointCacheSize(256),
+    m_resolveTtl(60),
+    m_resolveFailureTtl(5),
+    m_maxHeldBack(DEFAULT_QUEUE_CAPACITY),
     m_socket(m_ioContext),
-    m_resolver(m_ioContext)
+    m_recvBufferSize(MAX_DATAGRAM_SIZE + 1),
+    m_truncatedDatagrams(0),
+    m_heldBackToRetry(0),
+    m_sendCount(0),
+    m_sentCount(0),
+    m_waitingToSend(false)
+#ifdef IORING_RECV_MULTISHOT
+    , m_ringMessages(0),
+    m_ringCompleted(0),
+    m_ringError(0)
+#endif
 {
     readConfig();
 }
@@ -66,10 +97,47 @@ PlagUdp::~PlagUdp()
     }
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new Plag Udp:: Receive Shard object, that is not receiving yet
+ *
+ * @param shardSocket socket of the shard
+ * @param shardStrand strand the receive handlers of the shard run on
+ */
+PlagUdp::ReceiveShard::ReceiveShard(
+    boost::asio::ip::udp::socket & shardSocket,
+    const boost::asio::strand<boost::asio::io_context::executor_type> & shardStrand) :
+    socket(shardSocket),
+    strand(shardStrand),
+    receiving(false),
+    kernelDrops(0)
+#ifdef IORING_RECV_MULTISHOT
+    , ringArmed(false)
+#endif
+{
+}
+
 void PlagUdp::readConfig() try
 {
     m_ip = getParameter<string>("ip");
     m_port = getParameter<uint16_t>("port");
+    m_syscallBatch = max<size_t>(getOptionalParameter<size_t>("syscallBatch", 32), 1);
+    m_shardCount = max<size_t>(getOptionalParameter<size_t>("shards", 1), 1);
+    m_maxDatagramSize = getOptionalParameter<size_t>("maxDatagramSize", MAX_DATAGRAM_SIZE);
+    m_maxDatagramSize = min(max<size_t>(m_maxDatagramSize, 1), MAX_DATAGRAM_SIZE);
+    m_gso = getOptionalParameter<bool>("gso", false);
+    m_gro = getOptionalParameter<bool>("gro", false);
+    m_timestamps = getOptionalParameter<bool>("timestamps", true);
+    string ioBackend = getOptionalParameter<string>("ioBackend", "asio");
+    if (ioBackend == "asio") m_ioBackend = ASIO_BACKEND;
+    else if (ioBackend == "io_uring") m_ioBackend = IO_URING_BACKEND;
+    else throw std::invalid_argument("Unknown ioBackend in settings: \"" + ioBackend + "\"");
+    m_rcvBuf = max(getOptionalParameter<int>("rcvBuf", 0), 0);
+    m_sndBuf = max(getOptionalParameter<int>("sndBuf", 0), 0);
+    m_endpointCacheSize = max<size_t>(getOptionalParameter<size_t>("endpointCacheSize", 256), 1);
+    m_resolveTtl = chrono::seconds(getOptionalParameter<unsigned int>("resolveTtl", 60));
+    m_resolveFailureTtl = chrono::seconds(getOptionalParameter<unsigned int>("resolveFailureTtl", 5));
+    m_maxHeldBack = getOptionalParameter<size_t>("queueCapacity", DEFAULT_QUEUE_CAPACITY);
 }
 catch (exception & e)
 {
@@ -81,22 +149,97 @@ catch (exception & e)
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief PlagUdp::init() configures the UDP socket
+ * @brief PlagUdp::init() configures the UDP sockets of all shards
  * 
  */
 void PlagUdp::init() try
 {
-
-    m_socket.open(boost::asio::ip::udp::v4());
-
-    // enable broadcast messages:
-    m_socket.set_option(boost::asio::ip::udp::socket::reuse_address(true));
-    m_socket.set_option(boost::asio::socket_base::broadcast(true));
-
+#ifndef SO_REUSEPORT
+    if (m_shardCount > 1)
+    {
+        cout << "PlagUdp " << getName() << " cannot use shards on this system, using 1" << endl;
+        m_shardCount = 1;
+    }
+#endif
+#if !defined(UDP_SEGMENT) || !defined(UDP_GRO)
+    if (m_gso || m_gro)
+    {
+        cout << "PlagUdp " << getName() << " cannot use gso or gro on this system" << endl;
+        m_gso = false;
+        m_gro = false;
+    }
+#endif
+#ifndef SO_TIMESTAMPNS
+    // Datagrams keep their time of creation as time of ingress
+    m_timestamps = false;
+#endif
+#ifdef IORING_RECV_MULTISHOT
+    if (m_ioBackend == IO_URING_BACKEND && !IoUring::isSupported())
+#else
+    if (m_ioBackend == IO_URING_BACKEND)
+#endif
+    {
+        cout << "PlagUdp " << getName() << " cannot use io_uring on this system, using asio" << endl;
+        m_ioBackend = ASIO_BACKEND;
+    }
+    // one byte more than m_maxDatagramSize, to tell larger packets from fitting ones
+    m_recvBufferSize = m_gro ? MAX_COALESCED_SIZE : m_maxDatagramSize + 1;
     m_endPoint.address(boost::asio::ip::address_v4::from_string(m_ip));
     m_endPoint.port(m_port);
-    
-    m_socket.bind(m_endPoint);
+
+    m_shards.clear();
+    for (size_t i = 0; i < m_shardCount; i++)
+    {
+        unique_ptr<ReceiveShard> shard;
+        if (i == 0)
+        {
+            shard.reset(new ReceiveShard(m_socket, m_strand));
+        }
+        else
+        {
+            unique_ptr<boost::asio::ip::udp::socket> socket;
+            socket.reset(new boost::asio::ip::udp::socket(m_ioContext));
+            shard.reset(new ReceiveShard(*socket, boost::asio::make_strand(m_ioContext)));
+            shard->ownSocket = move(socket);
+        }
+        openSocket(shard->socket);
+        prepareShard(*shard);
+        m_shards.push_back(move(shard));
+    }
+
+    m_endpointCache.reset(new EndpointCache(m_strand, m_endpointCacheSize, m_resolveTtl,
+                                            m_resolveFailureTtl,
+                                            [this]()
+                                            {
+                                                m_heldBackToRetry = m_heldBack.size();
+                                                notify();
+                                            }));
+    m_sendPayloads.resize(m_maxBatch);
+    m_sendEndpoints.resize(m_maxBatch);
+#ifdef __linux__
+    m_sendVectors.resize(m_maxBatch);
+    m_sendHeaders.assign(m_syscallBatch, mmsghdr());
+    m_sendControls.assign(m_syscallBatch * CMSG_SPACE(sizeof(uint16_t)), 0);
+    m_sendSegments.resize(m_syscallBatch);
+#endif
+#ifdef IORING_RECV_MULTISHOT
+    if (m_ioBackend == IO_URING_BACKEND)
+    {
+        m_sendRing.reset(new IoUring(static_cast<unsigned int>(m_syscallBatch)));
+        m_sendRingEvents.reset(new boost::asio::posix::stream_descriptor(getIoContext(),
+                                                                         m_sendRing->openEventFd()));
+    }
+#endif
+#ifdef UDP_SEGMENT
+    int segmentSize = 0;
+    socklen_t segmentSizeLength = sizeof(segmentSize);
+    if (m_gso && getsockopt(m_socket.native_handle(), IPPROTO_UDP, UDP_SEGMENT, &segmentSize,
+                            &segmentSizeLength) != 0)
+    {
+        cout << "PlagUdp " << getName() << " cannot use gso: " << strerror(errno) << endl;
+        m_gso = false;
+    }
+#endif
 }
 catch (exception & e)
 {
@@ -108,35 +251,141 @@ catch (exception & e)
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief PlagUdp::loopWork regularly reads on the socket, if data popped in or sends data
- * 
+ * @brief opens @p socket, sets its options and binds it to m_endPoint
+ *
+ * @param socket socket of a shard
  */
-bool PlagUdp::loopWork() try
+void PlagUdp::openSocket(boost::asio::ip::udp::socket & socket)
 {
-    // receive what can be received
-    if (m_socket.available() > 0)
+    socket.open(boost::asio::ip::udp::v4());
+
+    // enable broadcast messages:
+    socket.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+    socket.set_option(boost::asio::socket_base::broadcast(true));
+#ifdef SO_REUSEPORT
+    if (m_shardCount > 1)
     {
-        char recvBuff[1024] = { 0 };
-        boost::asio::ip::udp::endpoint senderEndpoint;
-        
-        // receive available data
-        size_t length = m_socket.receive_from(boost::asio::buffer(recvBuff, 1024), senderEndpoint);
-                
-        if (length > 0)
-        {
-            string data = string(recvBuff, length);
-            shared_ptr<DatagramUdp> dataToSend(new DatagramUdp(getName(),
-                                                               senderEndpoint.address().to_string(),
-                                                               m_port, data));
-            appendToDistribution(dataToSend);
-        }
-        sendOneFromList();
-        return true;
+        // let the kernel spread the senders over the sockets of all shards
+        typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port;
+        socket.set_option(reuse_port(true));
+    }
+#endif
+
+    // the granted sizes are the same for every shard, so the first one tells about them
+    if (m_rcvBuf > 0)
+    {
+        boost::asio::socket_base::receive_buffer_size granted;
+        socket.set_option(boost::asio::socket_base::receive_buffer_size(m_rcvBuf));
+        socket.get_option(granted);
+        if (&socket == &m_socket) checkBufferSize("rcvBuf", m_rcvBuf, granted.value());
+    }
+    if (m_sndBuf > 0)
+    {
+        boost::asio::socket_base::send_buffer_size granted;
+        socket.set_option(boost::asio::socket_base::send_buffer_size(m_sndBuf));
+        socket.get_option(granted);
+        if (&socket == &m_socket) checkBufferSize("sndBuf", m_sndBuf, granted.value());
+    }
+#ifdef __linux__
+    // let the kernel attach its count of dropped packets to every received one
+    int enable = 1;
+    if (setsockopt(socket.native_handle(), SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) != 0)
+    {
+        cout << "PlagUdp " << getName() << " cannot count kernel drops: " << strerror(errno)
+             << endl;
+    }
+#endif
+#ifdef SO_TIMESTAMPNS
+    // let the kernel attach the time it received a packet to it
+    if (m_timestamps && setsockopt(socket.native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &enable,
+                                   sizeof(enable)) != 0)
+    {
+        cout << "PlagUdp " << getName() << " cannot use timestamps: " << strerror(errno) << endl;
+        m_timestamps = false;
+    }
+#endif
+#ifdef UDP_GRO
+    if (m_gro && setsockopt(socket.native_handle(), IPPROTO_UDP, UDP_GRO, &enable,
+                            sizeof(enable)) != 0)
+    {
+        // m_recvBufferSize stays large, which does no harm
+        cout << "PlagUdp " << getName() << " cannot use gro: " << strerror(errno) << endl;
+        m_gro = false;
+    }
+#endif
+
+    socket.bind(m_endPoint);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief allocates the receive buffers of @p shard and, where recvmmsg() is available, the headers
+ * pointing to them. With the io_uring backend, sets up the io_uring of @p shard instead.
+ *
+ * @param shard the shard to prepare
+ */
+void PlagUdp::prepareShard(ReceiveShard & shard)
+{
+#ifdef IORING_RECV_MULTISHOT
+    if (m_ioBackend == IO_URING_BACKEND)
+    {
+        // the kernel receives into the buffers of the shard's io_uring instead
+        prepareRing(shard);
+        return;
     }
-    else
+#endif
+    shard.recvBuffers.assign(m_syscallBatch * m_recvBufferSize, 0);
+#ifdef __linux__
+    shard.recvControls.assign(m_syscallBatch * RECEIVE_CONTROL_SIZE, 0);
+    shard.recvEndpoints.resize(m_syscallBatch);
+    shard.recvVectors.resize(m_syscallBatch);
+    shard.recvHeaders.assign(m_syscallBatch, mmsghdr());
+    for (size_t i = 0; i < m_syscallBatch; i++)
     {
-        return sendOneFromList();
+        shard.recvVectors[i].iov_base = getReceiveBuffer(shard, i);
+        shard.recvVectors[i].iov_len = m_recvBufferSize;
+        shard.recvHeaders[i].msg_hdr.msg_iov = &shard.recvVectors[i];
+        shard.recvHeaders[i].msg_hdr.msg_iovlen = 1;
+        shard.recvHeaders[i].msg_hdr.msg_name = shard.recvEndpoints[i].data();
     }
+#endif
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief starts the worker and the receiving on the sockets of all shards
+ *
+ */
+void PlagUdp::startWorker()
+{
+    Plag::startWorker();
+    resumeIngress();
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief (re-)starts the receiving on the sockets of all shards, that do not receive right now
+ * (e.g. as they stopped because of isBackpressured())
+ *
+ */
+void PlagUdp::resumeIngress()
+{
+    for (unique_ptr<ReceiveShard> & shard : m_shards)
+    {
+        ReceiveShard * shardToStart = shard.get();
+        boost::asio::post(shard->strand, [this, shardToStart]() { startReceive(*shardToStart); });
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief PlagUdp::loopWork sends data. Receiving does not need the loop, as received packets are
+ * handed to the distribution by handleReceive(), as soon as they arrive.
+ * 
+ */
+bool PlagUdp::loopWork() try
+{
+    return sendFromList();
 }
 catch (exception & e)
 {
@@ -158,7 +407,7 @@ void PlagUdp::placeDatagram(const shared_ptr<Datagram> datagram) try
     const shared_ptr<DatagramUdp> castPtr = dynamic_pointer_cast<DatagramUdp>(datagram);
     if (castPtr != nullptr)
     {
-        m_incommingDatagrams.push_back(datagram);
+        appendToIncoming(datagram);
     }
 }
 catch (exception & e)
@@ -171,30 +420,792 @@ catch (exception & e)
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief takes one Datagram from buffer and sends its payload as set
+ * @brief starts an async_receive_from on the socket of @p shard, whose completion is handled by
+ * handleReceive() on the strand of @p shard. With m_gro or m_timestamps, it only waits for the
+ * socket to become readable. With the io_uring backend, it waits for the completions of the
+ * shard's io_uring instead (see startRingReceive()). Does nothing, if a receive is already
+ * pending or the worker is stopped. Neither while a target holds back the distribution, so that
+ * the packets wait in the socket's receive buffer instead; resumeIngress() starts again.
+ *
+ * @param shard the shard to receive on
+ */
+void PlagUdp::startReceive(ReceiveShard & shard)
+{
+    if (shard.receiving || m_stopToken || isBackpressured()) return;
+    shard.receiving = true;
+#ifdef IORING_RECV_MULTISHOT
+    if (shard.ring)
+    {
+        startRingReceive(shard);
+        return;
+    }
+#endif
+    if (m_gro || m_timestamps)
+    {
+        // coalesced packets come with their segment size and all packets with their kernel
+        // timestamp as ancillary data, which only receiveBatched() reads, so just wait for them
+        // here
+        shard.socket.async_wait(boost::asio::ip::udp::socket::wait_read,
+                                boost::asio::bind_executor(shard.strand,
+                                    [this, &shard](const boost::system::error_code & error)
+                                    {
+                                        handleReceive(shard, error, 0);
+                                    }));
+        return;
+    }
+    shard.socket.async_receive_from(boost::asio::buffer(getReceiveBuffer(shard, 0),
+                                                        m_recvBufferSize),
+                                    shard.senderEndPoint,
+                                    boost::asio::bind_executor(shard.strand,
+                                        [this, &shard](const boost::system::error_code & error,
+                                                       size_t length)
+                                        {
+                                            handleReceive(shard, error, length);
+                                        }));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief handles a completed async_receive_from: hands the packet to the distribution, takes
+ * what else is already waiting on the socket (with recvmmsg(), where available) and receives again
+ *
+ * @param shard the shard, that received
+ * @param error error of the receive operation
+ * @param length size of the received packet
+ */
+void PlagUdp::handleReceive(ReceiveShard & shard, const boost::system::error_code & error,
+                            size_t length)
+{
+    shard.receiving = false;
+    if (error == boost::asio::error::operation_aborted) return;
+    try
+    {
+        if (error)
+        {
+            cout << "PlagUdp " << getName() << " could not receive: " << error.message() << endl;
+        }
+        else if (length > 0)
+        {
+            appendReceived(getReceiveBuffer(shard, 0), length, shard.senderEndPoint,
+                           chrono::steady_clock::now());
+        }
+#ifdef __linux__
+        if (!error && (m_syscallBatch > 1 || m_gro || m_timestamps)) receiveBatched(shard);
+#endif
+    }
+    catch (exception & e)
+    {
+        cout << "Something happened while receiving: " << e.what() << endl;
+    }
+    startReceive(shard);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief wraps a received packet into a DatagramUdp and puts it to the outgoing buffer. Packets
+ * larger than m_maxDatagramSize are counted and dropped instead of being handed on truncated.
+ *
+ * @param data payload of the packet
+ * @param length size of the payload
+ * @param sender endpoint the packet came from
+ * @param timeOfIngress when the packet was received (by the kernel, if known)
+ */
+void PlagUdp::appendReceived(const char * data, size_t length,
+                             const boost::asio::ip::udp::endpoint & sender,
+                             chrono::steady_clock::time_point timeOfIngress)
+{
+    if (length > m_maxDatagramSize)
+    {
+        m_truncatedDatagrams++;
+        return;
+    }
+    shared_ptr<DatagramUdp> dataToSend(new DatagramUdp(getName(), sender.address().to_string(),
+                                                       m_port, string(data, length)));
+    dataToSend->setTimeOfIngress(timeOfIngress);
+    appendToDistribution(dataToSend);
+}
+
+#ifdef __linux__
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief receives up to m_maxBatch packets, that are already waiting on the socket of @p shard,
+ * with one recvmmsg() per m_syscallBatch packets into its buffers. Packets coalesced by GRO are
+ * split into the packets, that were sent. Each packet is stamped with the time the kernel received
+ * it, if m_timestamps. Does not block.
+ *
+ * @param shard the shard to receive on
+ * @return size_t number of packets received
+ */
+size_t PlagUdp::receiveBatched(ReceiveShard & shard)
+{
+    size_t received = 0;
+    while (received < m_maxBatch)
+    {
+        size_t wanted = min(m_syscallBatch, m_maxBatch - received);
+        for (size_t i = 0; i < wanted; i++)
+        {
+            msghdr & header = shard.recvHeaders[i].msg_hdr;
+            header.msg_namelen = shard.recvEndpoints[i].capacity();
+            header.msg_control = &shard.recvControls[i * RECEIVE_CONTROL_SIZE];
+            header.msg_controllen = RECEIVE_CONTROL_SIZE;
+        }
+        int count = recvmmsg(shard.socket.native_handle(), shard.recvHeaders.data(),
+                             static_cast<unsigned int>(wanted), MSG_DONTWAIT, nullptr);
+        if (count < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+            throw boost::system::system_error(errno, boost::system::system_category(), "recvmmsg");
+        }
+        // the kernel stamps packets with the realtime clock, this one reading of both clocks maps
+        // the stamps of the whole batch onto the steady clock, that Datagrams are timed with
+        chrono::steady_clock::time_point steadyNow = chrono::steady_clock::now();
+        chrono::system_clock::time_point systemNow = chrono::system_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            timespec kernelTime = {0, 0};
+            size_t segmentSize = readControlMessages(shard, shard.recvHeaders[i].msg_hdr,
+                                                     kernelTime);
+            size_t length = shard.recvHeaders[i].msg_len;
+            if (length == 0) continue;
+            const char * data = static_cast<const char *>(shard.recvVectors[i].iov_base);
+            shard.recvEndpoints[i].resize(shard.recvHeaders[i].msg_hdr.msg_namelen);
+            appendPacket(data, length, shard.recvEndpoints[i], segmentSize,
+                         toTimeOfIngress(kernelTime, steadyNow, systemNow));
+        }
+        received += count;
+        if (static_cast<size_t>(count) < wanted) break;
+    }
+    return received;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief hands a received packet to appendReceived(). A packet coalesced by GRO is split into the
+ * packets, that were sent.
+ *
+ * @param data payload of the packet
+ * @param length size of the payload
+ * @param sender endpoint the packet came from
+ * @param segmentSize size of the coalesced packets (0: not coalesced)
+ * @param timeOfIngress when the packet was received
+ */
+void PlagUdp::appendPacket(const char * data, size_t length,
+                           const boost::asio::ip::udp::endpoint & sender, size_t segmentSize,
+                           chrono::steady_clock::time_point timeOfIngress)
+{
+    if (segmentSize == 0 || segmentSize >= length)
+    {
+        appendReceived(data, length, sender, timeOfIngress);
+        return;
+    }
+    for (size_t offset = 0; offset < length; offset += segmentSize)
+    {
+        appendReceived(data + offset, min(segmentSize, length - offset), sender, timeOfIngress);
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief maps the time the kernel stamped a packet with (realtime clock) onto the steady clock,
+ * that Datagrams are timed with
+ *
+ * @param kernelTime the stamp of the kernel ({0, 0}: none)
+ * @param steadyNow the steady clock, read right after receiving
+ * @param systemNow the realtime clock, read at the same time
+ * @return steady_clock::time_point when the packet was received (steadyNow, if not stamped)
+ */
+chrono::steady_clock::time_point PlagUdp::toTimeOfIngress(const timespec & kernelTime,
+                                                         chrono::steady_clock::time_point steadyNow,
+                                                         chrono::system_clock::time_point systemNow)
+{
+    if (kernelTime.tv_sec == 0) return steadyNow;
+    chrono::nanoseconds sinceEpoch = chrono::seconds(kernelTime.tv_sec)
+                                     + chrono::nanoseconds(kernelTime.tv_nsec);
+    chrono::system_clock::time_point received(
+        chrono::duration_cast<chrono::system_clock::duration>(sinceEpoch));
+    // the realtime clock may have been set in between, which must not date forward
+    if (received >= systemNow) return steadyNow;
+    return steadyNow - chrono::duration_cast<chrono::steady_clock::duration>(systemNow - received);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief reads the ancillary data, the kernel attached to a received packet: the count of dropped
+ * packets (the total of the socket, so the latest one is kept), the segment size of a packet
+ * coalesced by GRO and the time the kernel received the packet
+ *
+ * @param shard the shard, that received
+ * @param header header of the received packet
+ * @param kernelTime is set to the realtime the packet was received at (left as is, if not sent)
+ * @return size_t size of the coalesced packets (0: not coalesced)
+ */
+size_t PlagUdp::readControlMessages(ReceiveShard & shard, msghdr & header, timespec & kernelTime)
+{
+    size_t segmentSize = 0;
+    for (cmsghdr * control = CMSG_FIRSTHDR(&header); control != nullptr;
+         control = CMSG_NXTHDR(&header, control))
+    {
+        if (control->cmsg_level == SOL_SOCKET && control->cmsg_type == SO_RXQ_OVFL)
+        {
+            uint32_t drops = 0;
+            memcpy(&drops, CMSG_DATA(control), sizeof(drops));
+            shard.kernelDrops = drops;
+        }
+#ifdef SO_TIMESTAMPNS
+        else if (control->cmsg_level == SOL_SOCKET && control->cmsg_type == SCM_TIMESTAMPNS)
+        {
+            memcpy(&kernelTime, CMSG_DATA(control), sizeof(kernelTime));
+        }
+#endif
+#ifdef UDP_GRO
+        else if (control->cmsg_level == IPPROTO_UDP && control->cmsg_type == UDP_GRO)
+        {
+            int size = 0;
+            memcpy(&size, CMSG_DATA(control), sizeof(size));
+            segmentSize = static_cast<size_t>(max(size, 0));
+        }
+#endif
+    }
+    return segmentSize;
+}
+#endif
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief takes up to m_maxBatch Datagrams from buffer and sends their payloads as set. Receivers
+ * are looked up in m_endpointCache: Datagrams to a hostname being resolved are held back (up to
+ * m_maxHeldBack) and go first, once a resolve completed. Datagrams to an unresolvable hostname are
+ * dropped. Uses sendmmsg(), where available and m_syscallBatch is greater
+ * than 1. Marks the egress of each sent Datagram (see Datagram::markEgress()).
+ * If the socket takes no more, the rest of the batch is kept and sent first, once it is writable
+ * again (see waitUntilWritable()). With m_sendRing, the batch is kept until its sends completed.
  * 
  * @return true if there was data to send
- * @return false if the buffer was empty
+ * @return false if the buffer was empty or the socket takes no more
+ */
+bool PlagUdp::sendFromList()
+{
+    if (m_waitingToSend) return false;
+    if (m_sendCount > 0) return sendPrepared();
+
+    m_sendBatch.clear();
+    size_t retried = min(m_heldBackToRetry, m_maxBatch);
+    m_sendBatch.insert(m_sendBatch.end(), m_heldBack.begin(), m_heldBack.begin() + retried);
+    m_heldBack.erase(m_heldBack.begin(), m_heldBack.begin() + retried);
+    m_heldBackToRetry -= retried;
+    takeFromIncoming(m_sendBatch, m_maxBatch - retried);
+    if (m_sendBatch.empty()) return false;
+    size_t count = 0;
+    for (size_t i = 0; i < m_sendBatch.size(); i++)
+    {
+        const DatagramUdp & dataToSend = static_cast<const DatagramUdp &>(*m_sendBatch[i]);
+        uint16_t port = static_cast<uint16_t>(dataToSend.getPort());
+        EndpointCache::Resolution resolution
+            = m_endpointCache->lookUp(dataToSend.getReceiver(), port, m_sendEndpoints[count]);
+        // a receiver being resolved must not keep the rest of the batch from being sent
+        if (resolution == EndpointCache::RESOLVING && m_heldBack.size() < m_maxHeldBack)
+        {
+            m_heldBack.push_back(m_sendBatch[i]);
+            continue;
+        }
+        if (resolution != EndpointCache::RESOLVED)
+        {
+            m_droppedDatagrams++;
+            continue;
+        }
+        m_sendPayloads[count] = dataToSend.getPayload();
+        // keep the Datagrams to send at the front, to mark them, once sent
+        if (count != i) m_sendBatch[count] = m_sendBatch[i];
+        count++;
+    }
+    m_sendCount = count;
+    m_sentCount = 0;
+    sendPrepared();
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief sends the payloads of m_sendPayloads from m_sentCount up to m_sendCount. Once all are
+ * sent, the egress of their Datagrams is marked.
+ *
+ * @return true as there was data to send
+ */
+bool PlagUdp::sendPrepared()
+{
+#ifdef IORING_RECV_MULTISHOT
+    if (m_syscallBatch > 1 || m_sendRing) sendBatched(m_sendCount);
+    else sendSingle(m_sendCount);
+#elif defined(__linux__)
+    if (m_syscallBatch > 1) sendBatched(m_sendCount);
+    else sendSingle(m_sendCount);
+#else
+    sendSingle(m_sendCount);
+#endif
+    if (m_sentCount < m_sendCount) return true;
+
+    chrono::steady_clock::time_point timeOfEgress = chrono::steady_clock::now();
+    for (size_t i = 0; i < m_sendCount; i++)
+    {
+        m_sendBatch[i]->markEgress(timeOfEgress);
+    }
+    m_sendBatch.clear();
+    m_sendCount = 0;
+    m_sentCount = 0;
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief sends m_sendPayloads from m_sentCount up to @p count with one send_to() each
+ *
+ * @details A packet failing is dropped, so that the rest is sent with the next loop, and the error
+ * is thrown. send_to() waits for the socket to become writable itself.
+ *
+ * @param count number of packets to send
+ */
+void PlagUdp::sendSingle(size_t count)
+{
+    while (m_sentCount < count)
+    {
+        boost::system::error_code error;
+        m_socket.send_to(boost::asio::buffer(m_sendPayloads[m_sentCount]),
+                         m_sendEndpoints[m_sentCount], 0, error);
+        m_sentCount++;
+        if (error)
+        {
+            m_droppedDatagrams++;
+            throw boost::system::system_error(error, "send_to");
+        }
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief waits on the strand for m_socket to become writable and notifies the worker then, to send
+ * the rest of the batch. sendFromList() does nothing meanwhile.
+ *
+ */
+void PlagUdp::waitUntilWritable()
+{
+    m_waitingToSend = true;
+    m_socket.async_wait(boost::asio::ip::udp::socket::wait_write,
+                        boost::asio::bind_executor(m_strand,
+                            [this](const boost::system::error_code & error)
+                            {
+                                m_waitingToSend = false;
+                                // aborted means: the socket is closed
+                                if (error != boost::asio::error::operation_aborted) notify();
+                            }));
+}
+
+#ifdef __linux__
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief sends m_sendPayloads from m_sentCount up to @p count with one sendmmsg() (or one
+ * submission to m_sendRing) per m_syscallBatch messages
+ *
+ * @details The socket is non-blocking (boost::asio sets it so). If it takes no more (EAGAIN), the
+ * rest stays for waitUntilWritable(). A message failing otherwise is dropped, so that the rest is
+ * sent with the next loop, and the error is thrown.
+ * A submission to m_sendRing returns right away: handleSendCompletions() counts its messages as
+ * sent, once they completed, and the rest is sent with the next loop.
+ *
+ * @param count number of packets to send
+ */
+void PlagUdp::sendBatched(size_t count)
+{
+    while (m_sentCount < count)
+    {
+        size_t messages = prepareMessages(m_sentCount, count);
+        size_t done = 0;
+#ifdef IORING_RECV_MULTISHOT
+        if (m_sendRing)
+        {
+            sendWithRing(messages);
+            return;
+        }
+        else
+#endif
+        {
+            while (done < messages)
+            {
+                int sentNow = sendmmsg(m_socket.native_handle(), &m_sendHeaders[done],
+                                       static_cast<unsigned int>(messages - done), 0);
+                if (sentNow < 0)
+                {
+                    if (errno == EINTR) continue;
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                    int error = errno;
+                    for (size_t i = 0; i <= done; i++)
+                    {
+                        m_sentCount += m_sendSegments[i];
+                    }
+                    m_droppedDatagrams += m_sendSegments[done];
+                    throw boost::system::system_error(error, boost::system::system_category(),
+                                                      "sendmmsg");
+                }
+                done += sentNow;
+            }
+        }
+        for (size_t i = 0; i < done; i++)
+        {
+            m_sentCount += m_sendSegments[i];
+        }
+        if (done < messages)
+        {
+            waitUntilWritable();
+            return;
+        }
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief puts up to m_syscallBatch messages together in m_sendHeaders, starting with the payload
+ * @p first of m_sendPayloads. With m_gso, a run of payloads to the same receiver is one message,
+ * that the kernel segments into the packets (UDP_SEGMENT).
+ *
+ * @param first index of the first payload to send
+ * @param count number of payloads in m_sendPayloads
+ * @return size_t number of messages; m_sendSegments tells the payloads of each
  */
-bool PlagUdp::sendOneFromList()
+size_t PlagUdp::prepareMessages(size_t first, size_t count)
 {
-    if (m_incommingDatagrams.begin() != m_incommingDatagrams.end())
+    const size_t controlSize = CMSG_SPACE(sizeof(uint16_t));
+    size_t messages = 0;
+    for (size_t next = first; messages < m_syscallBatch && next < count; messages++)
     {
-        shared_ptr<DatagramUdp> dataToSend;
-        dataToSend = dynamic_pointer_cast<DatagramUdp>(m_incommingDatagrams.front());
-        m_incommingDatagrams.pop_front();
+        size_t segments = m_gso ? countSegments(next, count) : 1;
+        msghdr & header = m_sendHeaders[messages].msg_hdr;
+        for (size_t i = next; i < next + segments; i++)
+        {
+            m_sendVectors[i].iov_base = &m_sendPayloads[i][0];
+            m_sendVectors[i].iov_len = m_sendPayloads[i].size();
+        }
+        header.msg_iov = &m_sendVectors[next];
+        header.msg_iovlen = segments;
+        header.msg_name = m_sendEndpoints[next].data();
+        header.msg_namelen = m_sendEndpoints[next].size();
+        header.msg_control = nullptr;
+        header.msg_controllen = 0;
+#ifdef UDP_SEGMENT
+        if (segments > 1)
+        {
+            header.msg_control = &m_sendControls[messages * controlSize];
+            header.msg_controllen = controlSize;
+            cmsghdr * control = CMSG_FIRSTHDR(&header);
+            control->cmsg_level = IPPROTO_UDP;
+            control->cmsg_type = UDP_SEGMENT;
+            control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t segmentSize = static_cast<uint16_t>(m_sendPayloads[next].size());
+            memcpy(CMSG_DATA(control), &segmentSize, sizeof(segmentSize));
+        }
+#endif
+        m_sendSegments[messages] = segments;
+        next += segments;
+    }
+    return messages;
+}
 
-        boost::asio::ip::udp::resolver resolver(m_ioContext);
-        boost::asio::ip::address_v4 ipAddress;
-        ipAddress.from_string(dataToSend->getReceiver());
-        boost::asio::ip::udp::endpoint target(ipAddress,
-                                              static_cast<uint16_t>(dataToSend->getPort()));
-        boost::asio::ip::udp::resolver::iterator iter = resolver.resolve(target);
-        string payload = dataToSend->getPayload();
-        m_socket.send_to(boost::asio::buffer(payload, payload.size()), iter->endpoint());
-        
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief counts the payloads from @p first on, that can be sent as one segmented message: they go
+ * to the same receiver and have the size of the first one, only the last one may be smaller
+ *
+ * @param first index of the first payload in m_sendPayloads
+ * @param count number of payloads in m_sendPayloads
+ * @return size_t number of payloads in the message (at least 1)
+ */
+size_t PlagUdp::countSegments(size_t first, size_t count) const
+{
+    size_t segmentSize = m_sendPayloads[first].size();
+    if (segmentSize == 0 || segmentSize > MAX_SEGMENT_SIZE) return 1;
+    size_t segments = 1;
+    size_t totalSize = segmentSize;
+    for (size_t i = first + 1; i < count && segments < MAX_SEGMENTS; i++)
+    {
+        size_t size = m_sendPayloads[i].size();
+        if (size == 0 || size > segmentSize || totalSize + size > MAX_DATAGRAM_SIZE
+            || !(m_sendEndpoints[i] == m_sendEndpoints[first]))
+        {
+            break;
+        }
+        segments++;
+        totalSize += size;
+        if (size < segmentSize) break;
+    }
+    return segments;
+}
+#endif
 
-        return true;
+#ifdef IORING_RECV_MULTISHOT
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief sets up the io_uring of @p shard with 2 * m_syscallBatch (at least 16) registered
+ * buffers, each taking the sender, the ancillary data and a payload of m_recvBufferSize bytes,
+ * and the eventfd, its strand waits on
+ *
+ * @param shard the shard to prepare
+ */
+void PlagUdp::prepareRing(ReceiveShard & shard)
+{
+    memset(&shard.ringHeader, 0, sizeof(shard.ringHeader));
+    shard.ringHeader.msg_namelen = shard.senderEndPoint.capacity();
+    shard.ringHeader.msg_controllen = RECEIVE_CONTROL_SIZE;
+    size_t bufferSize = sizeof(io_uring_recvmsg_out) + shard.ringHeader.msg_namelen
+                        + shard.ringHeader.msg_controllen + m_recvBufferSize;
+    shard.ring.reset(new IoUring(4));
+    shard.ring->registerBuffers(static_cast<unsigned int>(max<size_t>(2 * m_syscallBatch, 16)),
+                                bufferSize);
+    shard.ringEvents.reset(new boost::asio::posix::stream_descriptor(shard.strand,
+                                                                     shard.ring->openEventFd()));
+    shard.ringArmed = false;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief submits the multishot receive of @p shard , unless it is still pending, and waits for
+ * its completions on the strand of @p shard
+ *
+ * @param shard the shard to receive on
+ */
+void PlagUdp::startRingReceive(ReceiveShard & shard)
+{
+    if (!shard.ringArmed)
+    {
+        shard.ring->prepareReceiveMessages(shard.socket.native_handle(), &shard.ringHeader, 0);
+        shard.ring->submit();
+        shard.ringArmed = true;
     }
-    return false;
-}
\ No newline at end of file
+    shard.ringEvents->async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                                 boost::asio::bind_executor(shard.strand,
+                                     [this, &shard](const boost::system::error_code & error)
+                                     {
+                                         handleRingCompletions(shard, error);
+                                     }));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief handles the completions of the io_uring of @p shard : hands the received packets to the
+ * distribution, returns their buffers and receives again. A multishot receive ends, e.g. when all
+ * buffers were taken (ENOBUFS); the packets then wait in the socket for the next one.
+ *
+ * @param shard the shard, that received
+ * @param error error of waiting for the eventfd
+ */
+void PlagUdp::handleRingCompletions(ReceiveShard & shard, const boost::system::error_code & error)
+{
+    shard.receiving = false;
+    if (error == boost::asio::error::operation_aborted) return;
+    try
+    {
+        if (error)
+        {
+            cout << "PlagUdp " << getName() << " could not receive: " << error.message() << endl;
+        }
+        else
+        {
+            shard.ring->clearEventFd();
+            chrono::steady_clock::time_point steadyNow = chrono::steady_clock::now();
+            chrono::system_clock::time_point systemNow = chrono::system_clock::now();
+            shard.ring->reapCompletions(
+                [this, &shard, steadyNow, systemNow](uint64_t, int32_t result, uint32_t flags)
+                {
+                    if (!(flags & IORING_CQE_F_MORE)) shard.ringArmed = false;
+                    if (!(flags & IORING_CQE_F_BUFFER))
+                    {
+                        if (result < 0 && result != -ENOBUFS && result != -ECANCELED)
+                        {
+                            cout << "PlagUdp " << getName() << " could not receive: "
+                                 << strerror(-result) << endl;
+                        }
+                        return;
+                    }
+                    uint16_t bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+                    try
+                    {
+                        appendRingMessage(shard, bufferId, static_cast<size_t>(max(result, 0)),
+                                          steadyNow, systemNow);
+                    }
+                    catch (...)
+                    {
+                        shard.ring->recycleBuffer(bufferId);
+                        throw;
+                    }
+                    shard.ring->recycleBuffer(bufferId);
+                });
+        }
+    }
+    catch (exception & e)
+    {
+        cout << "Something happened while receiving: " << e.what() << endl;
+    }
+    startReceive(shard);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief hands the packet, the io_uring of @p shard received into buffer @p bufferId , to the
+ * distribution
+ *
+ * @param shard the shard, that received
+ * @param bufferId id of the buffer
+ * @param length number of bytes received into the buffer
+ * @param steadyNow the steady clock, read right after the completion
+ * @param systemNow the realtime clock, read at the same time
+ */
+void PlagUdp::appendRingMessage(ReceiveShard & shard, uint16_t bufferId, size_t length,
+                                chrono::steady_clock::time_point steadyNow,
+                                chrono::system_clock::time_point systemNow)
+{
+    IoUring::ReceivedMessage message;
+    if (!IoUring::parseMessage(shard.ring->getBuffer(bufferId), length, shard.ringHeader, message))
+    {
+        return;
+    }
+    if (message.truncated)
+    {
+        m_truncatedDatagrams++;
+        return;
+    }
+    msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_control = message.control;
+    header.msg_controllen = message.controlLength;
+    timespec kernelTime = {0, 0};
+    size_t segmentSize = readControlMessages(shard, header, kernelTime);
+    memcpy(shard.senderEndPoint.data(), message.name, message.nameLength);
+    shard.senderEndPoint.resize(message.nameLength);
+    appendPacket(message.payload, message.payloadLength, shard.senderEndPoint, segmentSize,
+                 toTimeOfIngress(kernelTime, steadyNow, systemNow));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief submits the first @p messages of m_sendHeaders to m_sendRing, without waiting for them.
+ * Until they completed, sendFromList() does nothing, as the kernel reads their payloads.
+ *
+ * @param messages number of messages to send
+ */
+void PlagUdp::sendWithRing(size_t messages)
+{
+    for (size_t i = 0; i < messages; i++)
+    {
+        m_sendRing->prepareSendMessage(m_socket.native_handle(), &m_sendHeaders[i].msg_hdr, i);
+    }
+    m_sendRing->submit();
+    m_ringMessages = messages;
+    m_ringCompleted = 0;
+    m_ringError = 0;
+    m_waitingToSend = true;
+    awaitSendCompletions();
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief waits on the strand for the eventfd of m_sendRing, to call handleSendCompletions()
+ *
+ */
+void PlagUdp::awaitSendCompletions()
+{
+    m_sendRingEvents->async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                                 boost::asio::bind_executor(m_strand,
+                                     [this](const boost::system::error_code & error)
+                                     {
+                                         handleSendCompletions(error);
+                                     }));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief takes the completions of the sends of sendWithRing(). Once all of them completed, their
+ * payloads count as sent, the failed ones as dropped, and the worker is notified to go on.
+ *
+ * @param error a boost error code of waiting for the eventfd
+ */
+void PlagUdp::handleSendCompletions(const boost::system::error_code & error)
+{
+    // aborted means: the Plag is closed
+    if (error) return;
+    m_sendRing->clearEventFd();
+    m_ringCompleted += m_sendRing->reapCompletions([this](uint64_t message, int32_t result, uint32_t)
+                                                   {
+                                                       if (result >= 0 || message >= m_ringMessages) return;
+                                                       m_droppedDatagrams += m_sendSegments[message];
+                                                       if (m_ringError == 0) m_ringError = -result;
+                                                   });
+    if (m_ringCompleted < m_ringMessages)
+    {
+        awaitSendCompletions();
+        return;
+    }
+    for (size_t i = 0; i < m_ringMessages; i++)
+    {
+        m_sentCount += m_sendSegments[i];
+    }
+    m_ringMessages = 0;
+    m_waitingToSend = false;
+    if (m_ringError != 0)
+    {
+        cout << "PlagUdp " << getName() << " drops Datagrams: io_uring sendmsg: "
+             << strerror(m_ringError) << endl;
+    }
+    notify();
+}
+#endif
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief tells, if the kernel granted a smaller socket buffer than configured
+ *
+ * @param optionName name of the config parameter, for the message
+ * @param size wanted size in bytes
+ * @param granted size in bytes, the socket reports
+ */
+void PlagUdp::checkBufferSize(const string & optionName, int size, int granted)
+{
+    // boost already undoes the doubling of Linux; the kernel caps at net.core.rmem_max/wmem_max
+    if (granted < size)
+    {
+        cout << "PlagUdp " << getName() << " got " << granted << " bytes instead of " << size
+             << " for " << optionName << ", as the system allows no more" << endl;
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @param shard the shard owning the buffer
+ * @param slot index of the buffer in the pool of @p shard (less than m_syscallBatch)
+ * @return char * start of the receive buffer
+ */
+char * PlagUdp::getReceiveBuffer(ReceiveShard & shard, size_t slot) const
+{
+    return shard.recvBuffers.data() + slot * m_recvBufferSize;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief counts of the packets, that were lost while receiving, and of the endpoint lookups
+ *
+ * @return std::string ", truncated X, kernel drops Y, endpoint cache hits Z, misses W"
+ */
+string PlagUdp::getSpecificStatistics() const
+{
+    uint64_t kernelDrops = 0;
+    for (const unique_ptr<ReceiveShard> & shard : m_shards)
+    {
+        kernelDrops += shard->kernelDrops;
+    }
+    string statistics = ", truncated " + to_string(m_truncatedDatagrams) + ", kernel drops "
+                        + to_string(kernelDrops);
+    if (m_endpointCache)
+    {
+        statistics += ", endpoint cache hits " + to_string(m_endpointCache->getHits())
+                      + ", misses " + to_string(m_endpointCache->getMisses());
+    }
+    return statistics;
+}
@@ -20,6 +20,7 @@
  */
 
 // std includes
+#include <algorithm>
 #include <iostream>
 
 // own includes
@@ -41,14 +42,14 @@ using namespace std;
  * @param defaultQoS a default QoS level
  * @param userName username to supply to broker
  * @param userPass password to supply alongside username
- * @param keepAliveInterval keepalive interval in ms
+ * @param keepAliveInterval keepalive interval in s
  * @param cleanSessions flag, whether to start on a new session (true), or not (false)
  * @param willTopic topic of the testament
  * @param willMessage content of the testament
  * @param defaultSubscriptions default list of subsrciptions
  * @param version MQTT version of the client implementation
  */
-MqttClient::MqttClient(const Plag & parent, const string & brokerIP, unsigned int brokerPort,
+MqttClient::MqttClient(Plag & parent, const string & brokerIP, unsigned int brokerPort,
                            const string & clientId, uint8_t defaultQoS, const string & userName,
                            const string & userPass, unsigned int keepAliveInterval,
                            bool cleanSessions, const string & willTopic, const string willMessage,
@@ -64,20 +65,100 @@ MqttClient::MqttClient(const Plag & parent, const string & brokerIP, unsigned in
     m_willTopic(willTopic),
     m_willMessage(willMessage),
     m_defaultSubscriptions(defaultSubscriptions),
-    m_protocolVersion(version)
+    m_ioBackend(ASIO_BACKEND),
+    m_protocolVersion(version),
+    m_maxFlushDelay(0),
+    m_maxFlushSize(65536),
+    m_flushTimer(parent.getStrand()),
+    m_queuedPackets(0),
+    m_writes(0),
+    m_maxInflight(1024),
+    m_inflightWindow(1024),
+    m_connectState(CONNECT_IDLE),
+    m_connectTimeout(2500),
+    m_minReconnectDelay(100),
+    m_maxReconnectDelay(30000),
+    m_connectAttempts(0),
+    m_connectTimer(parent.getStrand()),
+    m_random(std::random_device()())
 {
 }
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief MqttClient::init() configures the TransportLayer
+ * @brief simple setter, to be called before init()
+ *
+ * @param ioBackend what the TransportLayer serves its socket with
+ */
+void MqttClient::setIoBackend(IoBackend ioBackend)
+{
+    m_ioBackend = ioBackend;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple setter for when the output buffer is written to the TransportLayer
+ *
+ * @param maxFlushDelay longest time a packet waits in the output buffer (0: until the parent is
+ * done with its current loop)
+ * @param maxFlushSize number of bytes, at which the output buffer is written right away
+ */
+void MqttClient::setFlushLimits(std::chrono::microseconds maxFlushDelay, size_t maxFlushSize)
+{
+    m_maxFlushDelay = maxFlushDelay;
+    m_maxFlushSize = maxFlushSize;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple setter, to be called before init()
+ *
+ * @param maxInflight most QoS 1 and 2 PUBLISHes to await acknowledgement for at a time (at least
+ * 1). Less are used, if the broker announces a lower Receive Maximum.
+ */
+void MqttClient::setMaxInflight(uint16_t maxInflight)
+{
+    m_maxInflight = max<uint16_t>(maxInflight, 1);
+    m_inflightWindow = m_maxInflight;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple setter
+ *
+ * @param retryInterval time to wait for the acknowledgement of a packet, before resending it (at
+ * least 1 ms)
+ */
+void MqttClient::setRetryInterval(std::chrono::milliseconds retryInterval)
+{
+    m_retryInterval = max(retryInterval, std::chrono::milliseconds(1));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple setter for the exponential backoff of reconnect attempts
+ *
+ * @param minDelay delay before the first reconnect attempt (at least 1 ms); it doubles with every
+ * failed attempt
+ * @param maxDelay longest delay between attempts (at least @p minDelay)
+ */
+void MqttClient::setReconnectDelays(std::chrono::milliseconds minDelay,
+                                    std::chrono::milliseconds maxDelay)
+{
+    m_minReconnectDelay = max(minDelay, std::chrono::milliseconds(1));
+    m_maxReconnectDelay = max(maxDelay, m_minReconnectDelay);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief MqttClient::init() configures the TransportLayer and starts to connect
  *
  */
 void MqttClient::init() try
 {
     
     m_transportLayer.reset(new TcpClient(std::chrono::milliseconds(1000),
-                                         m_parent, m_brokerIP, m_brokerPort));
+                                         m_parent, m_brokerIP, m_brokerPort, m_ioBackend));
     connect();
 }
 catch (exception & e)
@@ -96,11 +177,7 @@ catch (exception & e)
 void MqttClient::poll() try
 {
     resendOldData();
-    if (m_transportLayer->getAvailableBytesCount() > 0)
-    {
-        m_transportBuffer += m_transportLayer->receiveBytes();
-    }
-    if (m_transportBuffer.size() > 0) parseIncomingBuffer(m_transportBuffer);
+    receiveFromTransportLayer();
 }
 catch (exception & e)
 {
@@ -113,17 +190,26 @@ catch (exception & e)
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief transmits the Datagram to the broker
- * 
+ * @details PUBLISHes with QoS 1 or 2 are only sent, while less than m_inflightWindow of them await
+ * their acknowledgement. Otherwise they, and all PUBLISHes after them, wait in m_pendingPublishes,
+ * until acknowledgements free slots of the window.
+ *
  * @param datagram a Datagram from parent
+ * @return true if @p datagram was sent (or is written with the next flush)
+ * @return false if it waits for a free slot. It is marked as egressed, once sent.
  */
-void MqttClient::transmitDatagram(shared_ptr<DatagramMqtt> datagram) try
+bool MqttClient::transmitDatagram(shared_ptr<DatagramMqtt> datagram) try
 {
     string action = datagram->getAction();
     if (action == "publish")
     {
-        uint8_t flags = (datagram->getQoS() & 0x03) << 1;
-        flags |= datagram->getRetainFlag();
-        transmitPublish(datagram->getTopic(), datagram->getContent(), flags);
+        bool windowFull = m_inflightPublishes.size() >= m_inflightWindow;
+        if (!m_pendingPublishes.empty() || (windowFull && (datagram->getQoS() & 0x03) > 0))
+        {
+            m_pendingPublishes.push_back(datagram);
+            return false;
+        }
+        publishDatagram(datagram);
     }
     else if (action == "subscribe")
     {
@@ -133,6 +219,7 @@ void MqttClient::transmitDatagram(shared_ptr<DatagramMqtt> datagram) try
     {
         transmitUnsubscribe(datagram->getTopic());
     }
+    return true;
 }
 catch (exception & e)
 {
@@ -144,49 +231,186 @@ catch (exception & e)
 
 /**
  *-------------------------------------------------------------------------------------------------
- * @brief generalized connect sequence
- * 
+ * @brief generalized connect sequence, that never blocks
+ * @details Each call takes the next step, as far as it is due: start the TCP connect, send the
+ * CONNECT once the TransportLayer is connected, and complete the connection once the CONNACK
+ * accepted it. A failed step is retried after a delay, that doubles with each failed attempt up to
+ * m_maxReconnectDelay, with a random jitter of up to half of it. A lost connection is retried right
+ * away, if it held for m_maxReconnectDelay at least, else it counts as failed attempt.
+ * m_connectTimer wakes up the parent, when the next step is due.
  */
 void MqttClient::connect() try
 {
-    m_transportLayer->connect(std::chrono::milliseconds(2500));
-    if (!m_transportLayer->isConnected()) throw std::runtime_error("Could not connect as TCP client!");
-
-    m_transportLayer->transmit(createConnectMessage());
-    m_lastTimeOfSent = std::chrono::steady_clock::now();
-    // wait for CONNACK to happen
-    if (!m_transportLayer->isConnected()) throw std::runtime_error("Could not connect as TCP client!");
-    string connAckMsg = "";
-    connAckMsg = m_transportLayer->receiveBytes(4);
-    if (connAckMsg.at(0) == static_cast<char>(CONNACK << 4))
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    switch (m_connectState)
     {
-        uint8_t offset;
-        unsigned int neededLength = readMqttVarInt(connAckMsg, offset, 1);
-        if (neededLength > 2) connAckMsg += m_transportLayer->receiveBytes(neededLength - 2);
-        parseConnAck(connAckMsg);
-        if (!m_brokerConnected)
+    case CONNECT_IDLE:
+        if (m_brokerConnected)
         {
+            // the connection got lost
+            m_brokerConnected = false;
             m_transportLayer->disconnect();
-            cout << "Diconnected because of CONNACK failure!" << endl;
-        }
-        else
-        {
-            m_lastTimeReceived = std::chrono::steady_clock::now();
-            for (const std::pair<string, uint8_t> & subscription : m_defaultSubscriptions)
+            if (now - m_timeOfConnect < m_maxReconnectDelay)
             {
-                transmitSubscribe(subscription.first, subscription.second);
+                scheduleReconnect("Connection to broker lost");
+                return;
             }
+            m_connectAttempts = 0;
+        }
+        if (now < m_nextConnectAttempt) return;
+        // packets of a previous connection are resent from m_nonAckedData, once connected
+        m_outputBuffer.clear();
+        m_transportBuffer.clear();
+        // the CONNACK of MQTT v5 may lower this to the Receive Maximum of the broker
+        m_inflightWindow = m_maxInflight;
+        m_transportLayer->startConnect(m_connectTimeout);
+        m_connectState = CONNECT_TCP;
+        wakeUpAt(now + m_connectTimeout);
+        break;
+    case CONNECT_TCP:
+        if (m_transportLayer->isConnecting()) return;
+        if (!m_transportLayer->isConnected())
+        {
+            scheduleReconnect("Could not connect as TCP client");
+            return;
         }
+        m_transportLayer->transmit(createConnectMessage());
+        m_lastTimeOfSent = now;
+        m_lastTimeReceived = now;
+        m_connectDeadline = now + m_connectTimeout;
+        m_connectState = CONNECT_AWAITING_CONNACK;
+        wakeUpAt(m_connectDeadline);
+        break;
+    case CONNECT_AWAITING_CONNACK:
+        // the CONNACK is parsed like any other packet, setting m_brokerConnected if accepting
+        receiveFromTransportLayer();
+        if (m_brokerConnected)
+        {
+            completeConnect();
+        }
+        else if (!m_transportLayer->isConnected() || now >= m_connectDeadline)
+        {
+            m_transportLayer->disconnect();
+            scheduleReconnect("No accepting CONNACK from broker");
+        }
+        break;
+    }
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttClient::connect()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief last step of the connect sequence, once the CONNACK accepted the connection: resends
+ * what the previous connection left unacknowledged (PUBLISHes, and PUBRELs of QoS 2 PUBLISHes, that
+ * got their PUBREC), subscribes to the default subscriptions and
+ * sends the waiting PUBLISHes
+ *
+ */
+void MqttClient::completeConnect() try
+{
+    m_connectState = CONNECT_IDLE;
+    m_timeOfConnect = std::chrono::steady_clock::now();
+    m_lastTimeReceived = m_timeOfConnect;
+    m_connectTimer.cancel();
+    // whatever the previous connection left unacknowledged is due right away
+    m_dueIdentifiers.clear();
+    collectNonAcknowledged(m_dueIdentifiers);
+    for (uint64_t identifier : m_dueIdentifiers)
+    {
+        m_retransmitWheel.schedule(identifier, m_timeOfConnect);
     }
-    else
+    // only PUBLISHes (or their PUBRELs), that are resent, keep their slot of the inflight window
+    for (auto it = m_inflightPublishes.begin(); it != m_inflightPublishes.end();)
     {
-        cout << "Error in CONNACK message: " << getBinStringAsAsciiHex(connAckMsg) << endl;
+        if (isNonAcknowledged(*it)) ++it;
+        else it = m_inflightPublishes.erase(it);
     }
+    for (const std::pair<string, uint8_t> & subscription : m_defaultSubscriptions)
+    {
+        transmitSubscribe(subscription.first, subscription.second);
+    }
+    // PUBLISHes parked while disconnected take the free slots of the inflight window
+    transmitPendingPublishes();
+    flushTransmissions();
 }
 catch (exception & e)
 {
     string errorMsg = e.what();
-    errorMsg += "\nSomething happened in MqttClient::connect()";
+    errorMsg += "\nSomething happened in MqttClient::completeConnect()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief counts a failed connect attempt and determines, when to try the next one: the delay
+ * doubles with each failed attempt, from m_minReconnectDelay up to m_maxReconnectDelay, and a
+ * random part of up to half of it spreads the attempts of many clients
+ *
+ * @param reason what failed, for the log
+ */
+void MqttClient::scheduleReconnect(const string & reason)
+{
+    m_connectState = CONNECT_IDLE;
+    std::chrono::milliseconds delay = m_maxReconnectDelay;
+    // beyond 2^20 times the minimum any sensible maximum is reached
+    if (m_connectAttempts < 20)
+    {
+        delay = min(m_minReconnectDelay * (1u << m_connectAttempts), m_maxReconnectDelay);
+    }
+    ++m_connectAttempts;
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter(0, delay.count() / 2);
+    delay = delay - delay / 2 + std::chrono::milliseconds(jitter(m_random));
+    m_nextConnectAttempt = std::chrono::steady_clock::now() + delay;
+    wakeUpAt(m_nextConnectAttempt);
+    cout << reason << ", attempt " << m_connectAttempts << " to reconnect in " << delay.count()
+         << " ms" << endl;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief arms m_connectTimer to wake up the parent at @p timePoint, as it may park until then
+ *
+ * @param timePoint when the next step of the connect sequence is due
+ */
+void MqttClient::wakeUpAt(std::chrono::steady_clock::time_point timePoint)
+{
+    m_connectTimer.expires_at(timePoint);
+    m_connectTimer.async_wait([this](const boost::system::error_code & error)
+                              {
+                                  // aborted means: re-armed or connected
+                                  if (error != boost::asio::error::operation_aborted)
+                                  {
+                                      m_parent.notify();
+                                  }
+                              });
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief takes what the TransportLayer received and parses all complete packets of it
+ *
+ */
+void MqttClient::receiveFromTransportLayer() try
+{
+    if (m_transportLayer->getAvailableBytesCount() > 0)
+    {
+        // an empty buffer takes over the received bytes, instead of copying them
+        if (m_transportBuffer.empty()) m_transportBuffer = m_transportLayer->receiveBytes();
+        else m_transportBuffer += m_transportLayer->receiveBytes();
+    }
+    if (m_transportBuffer.size() > 0) parseIncomingBuffer(m_transportBuffer);
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttClient::receiveFromTransportLayer()";
     runtime_error eEdited(errorMsg);
     throw eEdited;
 }
@@ -200,11 +424,14 @@ catch (exception & e)
  */
 bool MqttClient::isConnected() try
 {
-    if (m_lastTimeReceived < m_lastTimeOfSent
+    if (m_brokerConnected && m_lastTimeReceived < m_lastTimeOfSent
         && m_lastTimeOfSent - m_lastTimeReceived > std::chrono::seconds(2 * m_keepAliveInterval))
     {
-        cout << "Disconnect because of timeout" << endl;
-        disconnect();
+        // the broker does not answer, so a DISCONNECT would not get through either
+        m_outputBuffer.clear();
+        m_brokerConnected = false;
+        m_transportLayer->disconnect();
+        scheduleReconnect("Disconnect because of timeout");
     }
     bool isConnected = m_transportLayer->isConnected() && m_brokerConnected;
     if (isConnected
@@ -229,8 +456,14 @@ catch (exception & e)
  */
 void MqttClient::disconnect() try
 {
-    if (m_transportLayer->isConnected()) this->transmitDisconnect();
+    if (m_transportLayer->isConnected())
+    {
+        this->transmitDisconnect();
+    }
+    m_outputBuffer.clear();
     m_brokerConnected = false;
+    m_connectState = CONNECT_IDLE;
+    m_connectTimer.cancel();
     m_transportLayer->disconnect();
 }
 catch (exception & e)
@@ -254,7 +487,7 @@ void MqttClient::transmitPingReq() try
 
     prepareFixedHeader(PINGREQ, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -270,29 +503,235 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief convenvience function to resend packets in the loop, where the time demands it
  * @details some packets (those with QoS > 0) require acknowledgements and should be resent, if
- * that acknowledgement fails to come. Therefore we'll hold that packet with current time information
- * in a map, tied to its identifier, for quick access. This function checks the map's items' time
- * points, whether a resend is in order. If so, it does resend it and updates the time point.
+ * that acknowledgement fails to come. Therefore we'll hold that packet in an array, indexed by its
+ * identifier, for quick access. The identifiers are scheduled on a timing wheel as well, so this
+ * function only looks at the packets, whose resend is due (acknowledged ones were cancelled). They
+ * are resent (PUBLISHes with the DUP flag) and scheduled again.
  * @sa MqttInterface::addNonAcknowledgedData()
  * @sa MqttInterface::hasMessages()
  */
 void MqttClient::resendOldData() try
 {
     std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-    // keyValPair is a pair of types uint16_t and a pair of string and time_point
-    for (auto & keyValPair : m_nonAckedData)
+    m_dueIdentifiers.clear();
+    if (m_retransmitWheel.expire(now, m_dueIdentifiers) == 0) return;
+    for (uint64_t identifier : m_dueIdentifiers)
+    {
+        string & packet = m_nonAckedData[identifier];
+        if ((static_cast<uint8_t>(packet.at(0)) >> 4) == PUBLISH) packet[0] |= '\x08';
+        queueTransmission(packet);
+        m_retransmitWheel.schedule(identifier, now + m_retryInterval);
+    }
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttClient::resendOldData()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief appends an MQTT packet to the output buffer, instead of writing it right away
+ * @details All packets produced while the parent handles one loop (e.g. a batch of PUBLISHes and
+ * the PUBACKs for received ones) are written with a single write by flushDueTransmissions(). The
+ * output buffer is written earlier, once it holds m_maxFlushSize bytes. With a m_maxFlushDelay
+ * the packets may wait for later loops, and m_flushTimer wakes up the parent, when they are due.
+ *
+ * @param packet the complete MQTT packet
+ */
+void MqttClient::queueTransmission(const string & packet) try
+{
+    if (!m_transportLayer->isConnected()) throw std::runtime_error("Cannot transmit, when not connected!");
+    if (m_outputBuffer.empty())
     {
-        if (now > keyValPair.second.second + std::chrono::milliseconds(m_keepAliveInterval))
+        m_timeOfFirstQueued = std::chrono::steady_clock::now();
+        if (m_maxFlushDelay.count() > 0)
         {
-            m_transportLayer->transmit(keyValPair.second.first);
-            keyValPair.second.second = std::chrono::steady_clock::now();
+            m_flushTimer.expires_after(m_maxFlushDelay);
+            m_flushTimer.async_wait([this](const boost::system::error_code & error)
+                                    {
+                                        // aborted means: re-armed for a newer packet
+                                        if (error != boost::asio::error::operation_aborted)
+                                        {
+                                            m_parent.notify();
+                                        }
+                                    });
         }
     }
+    m_outputBuffer += packet;
+    ++m_queuedPackets;
+    if (m_outputBuffer.size() >= m_maxFlushSize) flushTransmissions();
 }
 catch (exception & e)
 {
     string errorMsg = e.what();
-    errorMsg += "\nSomething happened in MqttClient::resendOldData()";
+    errorMsg += "\nSomething happened in MqttClient::queueTransmission()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief writes the output buffer, if its oldest packet waited for m_maxFlushDelay. To be called
+ * by the parent at the end of each loop.
+ *
+ */
+void MqttClient::flushDueTransmissions() try
+{
+    if (m_outputBuffer.empty()) return;
+    if (std::chrono::steady_clock::now() - m_timeOfFirstQueued >= m_maxFlushDelay)
+    {
+        flushTransmissions();
+    }
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttClient::flushDueTransmissions()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief writes all packets of the output buffer to the TransportLayer with a single write
+ *
+ */
+void MqttClient::flushTransmissions() try
+{
+    if (m_outputBuffer.empty()) return;
+    ++m_writes;
+    m_transportLayer->transmit(m_outputBuffer);
+    m_outputBuffer.clear();
+}
+catch (exception & e)
+{
+    m_outputBuffer.clear();
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttClient::flushTransmissions()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return uint64_t number of packets queued for transmission so far
+ */
+uint64_t MqttClient::getQueuedPacketCount() const
+{
+    return m_queuedPackets;
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return uint64_t number of writes to the TransportLayer, the queued packets took
+ */
+uint64_t MqttClient::getWriteCount() const
+{
+    return m_writes;
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return true if PUBLISHes wait for a free slot of the inflight window
+ * @return false else
+ */
+bool MqttClient::hasPendingPublishes() const
+{
+    return !m_pendingPublishes.empty();
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief limits the inflight window to the Receive Maximum, the broker announced
+ *
+ * @param receiveMaximum most QoS 1 and 2 PUBLISHes the broker accepts to be unacknowledged
+ */
+void MqttClient::setInflightWindow(uint16_t receiveMaximum) try
+{
+    m_inflightWindow = max<uint16_t>(min(m_maxInflight, receiveMaximum), 1);
+    transmitPendingPublishes();
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttClient::setInflightWindow()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief frees the slot of the inflight window, a QoS 1 or 2 PUBLISH took, and sends waiting
+ * PUBLISHes. To be called, when the PUBACK (QoS 1) or PUBCOMP (QoS 2) arrived.
+ *
+ * @param identifier packet identifier of the acknowledged PUBLISH
+ */
+void MqttClient::releaseInflight(uint16_t identifier) try
+{
+    if (m_inflightPublishes.erase(identifier) == 0) return;
+    transmitPendingPublishes();
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttClient::releaseInflight()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief sends waiting PUBLISHes in order, as long as the inflight window has free slots
+ *
+ */
+void MqttClient::transmitPendingPublishes() try
+{
+    if (m_pendingPublishes.empty() || !m_brokerConnected) return;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    while (!m_pendingPublishes.empty())
+    {
+        shared_ptr<DatagramMqtt> datagram = m_pendingPublishes.front();
+        bool windowFull = m_inflightPublishes.size() >= m_inflightWindow;
+        if (windowFull && (datagram->getQoS() & 0x03) > 0) break;
+        m_pendingPublishes.pop_front();
+        publishDatagram(datagram);
+        datagram->markEgress(now);
+    }
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttClient::transmitPendingPublishes()";
     runtime_error eEdited(errorMsg);
     throw eEdited;
-}
\ No newline at end of file
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief sends @p datagram as PUBLISH and takes a slot of the inflight window, if its QoS is 1 or 2
+ *
+ * @param datagram a Datagram with the action "publish"
+ */
+void MqttClient::publishDatagram(const shared_ptr<DatagramMqtt> & datagram) try
+{
+    uint8_t flags = (datagram->getQoS() & 0x03) << 1;
+    flags |= datagram->getRetainFlag();
+    uint16_t identifier = transmitPublish(datagram->getTopic(), datagram->getContent(), flags);
+    if (identifier != 0) m_inflightPublishes.insert(identifier);
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttClient::publishDatagram()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
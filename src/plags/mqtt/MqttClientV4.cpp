@@ -41,14 +41,14 @@ using namespace std;
  * @param defaultQoS a default QoS level
  * @param userName username to supply to broker
  * @param userPass password to supply alongside username
- * @param keepAliveInterval keepalive interval in ms
+ * @param keepAliveInterval keepalive interval in s
  * @param cleanSessions flag, whether to start on a new session (true), or not (false)
  * @param willTopic topic of the testament
  * @param willMessage content of the testament
  * @param defaultSubscriptions default list of subsrciptions
  * @sa MqttClient::MqttClient()  
  */
-MqttClientV4::MqttClientV4(const Plag & parent, const string & brokerIP, unsigned int brokerPort,
+MqttClientV4::MqttClientV4(Plag & parent, const string & brokerIP, unsigned int brokerPort,
                            const string & clientId, uint8_t defaultQoS, const string & userName,
                            const string & userPass, unsigned int keepAliveInterval,
                            bool cleanSessions, const string & willTopic, const string willMessage,
@@ -124,7 +124,7 @@ catch (exception & e)
  * 
  * @param content ignored content of the CONNECT request
  */
-void MqttClientV4::parseConnect(const string & content) try
+void MqttClientV4::parseConnect(string_view content) try
 {
     cout << "This is a client, and therefore cannot be connected to!" << endl;
 }
@@ -140,25 +140,22 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a connection acknowledgment (conn ack) message and acts upon it
  *
- * @param content the complete message
+ * @param content the variable header of the message
  */
-void MqttClientV4::parseConnAck(const string & content) try
+void MqttClientV4::parseConnAck(string_view content) try
 {
     if (content.size() < 2) return;
-    if (content.at(0) != static_cast<char>(CONNACK << 4))
-    {
-        cerr << "Called MqttClientV4::parseConnAck from non-CONNACK message!" << endl;
-        cerr << "CONNACK message was: " << getBinStringAsAsciiHex(content) << endl;
-        return;
-    }
-    if (content.at(1) != char(0x02))
+    if (content.size() != 2)
     {
         cout << "Unknown CONNACK format. Will continue to parse." << endl;
-        cout << "CONNACK message was: " << getBinStringAsAsciiHex(content) << endl;
+        cout << "CONNACK message was: " << getBinStringAsAsciiHex(string(content)) << endl;
     }
-    m_brokerConnected = (content.at(2) == static_cast<char>(0x01));
+    // the first byte only tells, whether the broker kept a session; the second byte decides
+    m_brokerConnected = (content.at(1) == '\x00');
+    // without a session, the broker does not resend PUBLISHes awaiting their PUBREL
+    if (m_brokerConnected && content.at(0) != '\x01') m_receivedQoS2 = IdentifierBitmap();
     string ackMessage;
-    switch (static_cast<unsigned char>(content.at(3)))
+    switch (static_cast<unsigned char>(content.at(1)))
     {
     case 0:
         cout << "Connected to broker!" << endl;
@@ -259,7 +256,7 @@ catch (exception & e)
  *
  * @param content
  */
-void MqttClientV4::parseDisconnect(const std::string & content) try
+void MqttClientV4::parseDisconnect(string_view content) try
 {
     if (content.size() > 0) cout << "Protocol error, as disconnect should be empty" << endl;
     m_brokerConnected = false;
@@ -280,7 +277,7 @@ catch (exception & e)
  * @param firstByte the first byte of the fixed header of the MQTT message
  * @param content the variable header and payload of the MQTT message
  */
-void MqttClientV4::parsePublish(uint8_t firstByte, string & content) try
+void MqttClientV4::parsePublish(uint8_t firstByte, string_view content) try
 {
     if (((firstByte & 0xF0) >> 4) != PUBLISH)
     {
@@ -295,16 +292,14 @@ void MqttClientV4::parsePublish(uint8_t firstByte, string & content) try
     uint8_t qos = (flags & 0x06) >> 1;
     bool retain = flags & 0x01;
 
-    string topic = extractMqttString(content);
+    size_t pos = 0;
+    string_view topic = readMqttString(content, pos);
     string identifier;
     if (qos > 0)
     {
-        identifier = content.substr(0, 2);
-        content = content.substr(2);
+        identifier = content.substr(pos, 2);
+        pos += 2;
     }
-    string msgContent = "";
-
-    msgContent = content;
 
     if (qos == 1)
     {
@@ -313,9 +308,15 @@ void MqttClientV4::parsePublish(uint8_t firstByte, string & content) try
     else if (qos == 2)
     {
         transmitPubRec(identifier);
+        // the broker numbers its PUBLISHes on its own; a resent one, forwarded already, is not again
+        uint16_t packetIdentifier = readMqttIdentifier(identifier);
+        if (m_receivedQoS2.isUsed(packetIdentifier)) return;
+        m_receivedQoS2.markUsed(packetIdentifier);
     }
+    // only topic and payload of the Datagram are copied out of the receive buffer
     shared_ptr<DatagramMqtt> datagram(new DatagramMqtt(m_parent.getName(), action,
-                                                       topic, msgContent, qos, retain));
+                                                       string(topic), string(content.substr(pos)),
+                                                       qos, retain));
     m_incomingBuffer.push_back(datagram);
 }
 catch (exception & e)
@@ -330,16 +331,16 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a PUBACK (publish acknowledgment) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV4::parsePubAck(const string & content) try
+void MqttClientV4::parsePubAck(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
+    uint16_t identifier = readMqttIdentifier(content);
 
     removeNonAcknowledgedData(identifier);
+    releaseInflight(identifier);
 }
 catch (exception & e)
 {
@@ -353,18 +354,15 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a PUBREC (publish received) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV4::parsePubRec(const string & content) try
+void MqttClientV4::parsePubRec(string_view content) try
 {
-    if (content.size() < 4) return;
-
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
-    string identifierAsStr = content.substr(2, 2);
+    if (content.size() < 2) return;
 
-    removeNonAcknowledgedData(identifier);
+    string identifierAsStr(content.substr(0, 2));
 
+    // the PUBREL takes the place of the PUBLISH, the identifier stays reserved until the PUBCOMP
     tranmitPubRel(identifierAsStr);
 }
 catch (exception & e)
@@ -379,17 +377,17 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a PUBREL (publish release) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV4::parsePubRel(const string & content) try
+void MqttClientV4::parsePubRel(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
-    string identifierAsStr = content.substr(2, 2);
+    uint16_t identifier = readMqttIdentifier(content);
+    string identifierAsStr(content.substr(0, 2));
 
-    removeNonAcknowledgedData(identifier);
+    // a PUBLISH of the broker with this identifier is a new one from now on
+    m_receivedQoS2.markFree(identifier);
 
     transmitPubComp(identifierAsStr);
 }
@@ -405,16 +403,16 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parases a PUBCOMP (publish complete) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV4::parsePubComp(const string & content) try
+void MqttClientV4::parsePubComp(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
+    uint16_t identifier = readMqttIdentifier(content);
 
     removeNonAcknowledgedData(identifier);
+    releaseInflight(identifier);
 }
 catch (exception & e)
 {
@@ -428,18 +426,17 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a SUBACK (subscription acknowledgment) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV4::parseSubAck(const string & content) try
+void MqttClientV4::parseSubAck(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 3) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
+    uint16_t identifier = readMqttIdentifier(content);
 
     removeNonAcknowledgedData(identifier);
 
-    uint8_t flags = content.at(3);
+    uint8_t flags = content.at(2);
 
     if (flags >= 0x80)
     {
@@ -464,14 +461,13 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses an UNSUBACK (unsubscribe acknowledgment) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV4::parseUnsubAck(const string & content) try
+void MqttClientV4::parseUnsubAck(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
+    uint16_t identifier = readMqttIdentifier(content);
 
     removeNonAcknowledgedData(identifier);
 }
@@ -490,7 +486,7 @@ catch (exception & e)
  *
  * @param content 
  */
-void MqttClientV4::parseAuth(const string & content) try
+void MqttClientV4::parseAuth(string_view content) try
 {
     cout << "AUTH is not a part of the MQTT v3.1.1 spec. Adapt version!" << endl;
 }
@@ -531,7 +527,9 @@ void MqttClientV4::transmitDisconnect() try
 
     prepareFixedHeader(DISCONNECT, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
+    // the DISCONNECT has to be out, before the connection is closed below
+    flushTransmissions();
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 
@@ -553,8 +551,9 @@ catch (exception & e)
  * @param topic the topic under which the @p content is published
  * @param content the content to publish (may be values, may be text)
  * @param flags the 4-bit flags (qos, retain, and dup). dup is currently unused and should not be set by the user
+ * @return uint16_t packet identifier of the PUBLISH (0 with qos 0)
  */
-void MqttClientV4::transmitPublish(const string & topic, const string & content, uint8_t flags) try
+uint16_t MqttClientV4::transmitPublish(const string & topic, const string & content, uint8_t flags) try
 {
     string data = makeMqttString(topic);
 
@@ -572,11 +571,13 @@ void MqttClientV4::transmitPublish(const string & topic, const string & content,
 
     prepareFixedHeader(PUBLISH, flags, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     if (identifier != 0) addNonAcknowledgedData(identifier, data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
+
+    return identifier;
 }
 catch (exception & e)
 {
@@ -599,7 +600,7 @@ void MqttClientV4::transmitPubAck(const string & identifier, char reasonCode) tr
 
     prepareFixedHeader(PUBACK, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -624,7 +625,7 @@ void MqttClientV4::transmitPubRec(const string & identifier, char reasonCode) tr
 
     prepareFixedHeader(PUBREC, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -639,7 +640,8 @@ catch (exception & e)
 /**
  * -------------------------------------------------------------------------------------------------
  * @brief creates and sends a PUBREL (publish release) message
- * @details these need to be sent, when this receives a PUBREC message
+ * @details these need to be sent, when this receives a PUBREC message. The PUBREL replaces the
+ * PUBLISH in m_nonAckedData, so that it is resent until the PUBCOMP arrives.
  * @param identifier identifier of the received PUBREC message
  * @param reasonCode MQTT v.5 adds a reason code, to convey more info. this is ignored
  */
@@ -649,7 +651,11 @@ void MqttClientV4::tranmitPubRel(const string & identifier, char reasonCode) try
 
     prepareFixedHeader(PUBREL, 2, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
+
+    // resent until the PUBCOMP, unless the identifier is not (or no more) in use by a PUBLISH
+    uint16_t packetIdentifier = readMqttIdentifier(identifier);
+    if (isNonAcknowledged(packetIdentifier)) addNonAcknowledgedData(packetIdentifier, data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -674,7 +680,7 @@ void MqttClientV4::transmitPubComp(const string & identifier, char reasonCode) t
 
     prepareFixedHeader(PUBCOMP, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -708,7 +714,7 @@ void MqttClientV4::transmitSubscribe(const string & topic, uint8_t qos) try
 
     cout << "Subscribe to " << topic << endl;
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     addNonAcknowledgedData(identifier, data);
 
@@ -740,7 +746,7 @@ void MqttClientV4::transmitUnsubscribe(const string & topic) try
 
     prepareFixedHeader(UNSUBSCRIBE, 2, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     addNonAcknowledgedData(identifier, data);
 
@@ -27,16 +27,40 @@
 
 using namespace std;
 
-MqttClientV5::MqttClientV5(const Plag & parent, const string & brokerIP, unsigned int brokerPort,
+MqttClientV5::MqttClientV5(Plag & parent, const string & brokerIP, unsigned int brokerPort,
                            const string & clientId, uint8_t defaultQoS, const string & userName,
                            const string & userPass, unsigned int keepAliveInterval,
                            bool cleanSessions, const string & willTopic, const string willMessage,
                            const vector<std::pair<string, uint8_t>> & defaultSubscriptions) :
     MqttClient(parent, brokerIP, brokerPort, clientId, defaultQoS, userName, userPass,
-               keepAliveInterval, cleanSessions, willTopic, willMessage, defaultSubscriptions, 5)
+               keepAliveInterval, cleanSessions, willTopic, willMessage, defaultSubscriptions, 5),
+    m_maxTopicAliases(0)
 {
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple setter, to be called before init()
+ *
+ * @param maxTopicAliases most topic aliases to use for PUBLISHes (0: none). Less are used, if the
+ * broker allows less.
+ */
+void MqttClientV5::setMaxTopicAliases(uint16_t maxTopicAliases)
+{
+    m_maxTopicAliases = maxTopicAliases;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return uint64_t PUBLISHes of the current connection, that were sent with an alias only
+ */
+uint64_t MqttClientV5::getTopicAliasHits() const
+{
+    return m_topicAliases.getHits();
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief reads properties from prepared string containing only the properties
@@ -44,10 +68,10 @@ MqttClientV5::MqttClientV5(const Plag & parent, const string & brokerIP, unsigne
  * @param content entire properties string, minus properties length indicator bytes
  * @return map<MqttPropertyType, string> 
  */
-map<MqttPropertyType, string> MqttClientV5::readProperties(const std::string & content = 0) const
+map<MqttPropertyType, string> MqttClientV5::readProperties(string_view content) const
 {
     map<MqttPropertyType, string> properties;
-    string remainingProperties = content;
+    string_view remainingProperties = content;
     string extracted;
     size_t extractedLength = 0;
     do
@@ -72,8 +96,8 @@ map<MqttPropertyType, string> MqttClientV5::readProperties(const std::string & c
                  || type == RECEIVE_MAX)
         {
             unsigned int number = 0;
-            number = static_cast<int>(remainingProperties.at(1)) << 8;
-            number |= static_cast<int>(remainingProperties.at(2));
+            number = static_cast<uint8_t>(remainingProperties.at(1)) << 8;
+            number |= static_cast<uint8_t>(remainingProperties.at(2));
             extracted = to_string(number);
             extractedLength = 3;
         }
@@ -100,7 +124,7 @@ map<MqttPropertyType, string> MqttClientV5::readProperties(const std::string & c
         }
         else if (type == CORRELATION_DATA)
         {
-            extracted = remainingProperties.substr(1);
+            extracted = string(remainingProperties.substr(1));
             extractedLength = remainingProperties.size();
         }
         else if (type == USER_PROPERTY)
@@ -115,8 +139,8 @@ map<MqttPropertyType, string> MqttClientV5::readProperties(const std::string & c
         }
         else
         {
-            extracted = extractMqttString(remainingProperties, 1);
-            extractedLength = extracted.size() + 3;
+            extractedLength = 1;
+            extracted = string(readMqttString(remainingProperties, extractedLength));
         }
 
         properties.insert_or_assign(static_cast<MqttPropertyType>(type), extracted);
@@ -143,11 +167,9 @@ map<string, string> MqttClientV5::convertUserPropertiesToMap(const map<MqttPrope
     size_t currentPos = 0;
     do
     {
-        propKey = extractMqttString(userPropsAsStr, currentPos);
-        currentPos += propKey.size() + 2;
+        propKey = readMqttString(userPropsAsStr, currentPos);
         if (currentPos >= userPropsAsStr.size()) throw std::invalid_argument("No key-value pair!");
-        propValue = extractMqttString(userPropsAsStr, currentPos);
-        currentPos += propValue.size() + 2;
+        propValue = readMqttString(userPropsAsStr, currentPos);
         userProps.insert_or_assign(propKey, propValue);
     } while (currentPos < userPropsAsStr.size());
     return userProps;
@@ -346,7 +368,7 @@ catch (exception & e)
  *
  * @param content ignored content of the CONNECT request
  */
-void MqttClientV5::parseConnect(const string & content) try
+void MqttClientV5::parseConnect(string_view content) try
 {
     cout << "This is a client, and therefore cannot be connected to!" << endl;
 }
@@ -362,23 +384,20 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a connection acknowledgment (conn ack) message and acts upon it
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV5::parseConnAck(const string & content) try
+void MqttClientV5::parseConnAck(string_view content) try
 {
     if (content.size() < 2) return;
-    if (content.at(0) != static_cast<char>(CONNACK << 4))
-    {
-        cerr << "Called MqttClientV5::parseConnAck from non-CONNACK message!" << endl;
-        return;
-    }
-    bool sessionReconnect = (content.at(2) == static_cast<char>(0x01));
+    bool sessionReconnect = (content.at(0) == static_cast<char>(0x01));
     if (sessionReconnect) cout << "Broker revived previous session" << endl;
 
-    m_brokerConnected = static_cast<unsigned char>(content.at(3)) == 0x00;
+    m_brokerConnected = static_cast<unsigned char>(content.at(1)) == 0x00;
+    // without a session, the broker does not resend PUBLISHes awaiting their PUBREL
+    if (m_brokerConnected && !sessionReconnect) m_receivedQoS2 = IdentifierBitmap();
 
     string ackMessage;
-    switch (static_cast<unsigned char>(content.at(3)))
+    switch (static_cast<unsigned char>(content.at(1)))
     {
     case 0:
         cout << "Connected to broker!" << endl;
@@ -464,12 +483,26 @@ void MqttClientV5::parseConnAck(const string & content) try
     default:
         cout << "Unknown error!" << endl;
     }
-    uint8_t offset;
-    unsigned int size = readMqttVarInt(content, offset, 4);
-    if (size > 0)
+    // topic aliases are valid for one connection only, receive maximum defaults to 65535
+    uint16_t maxTopicAliases = 0;
+    unsigned long receiveMaximum = UINT16_MAX;
+    if (content.size() > 2)
     {
-        map<MqttPropertyType, string> properties = readProperties(content.substr(4 + offset, size));
+        uint8_t offset;
+        unsigned int size = readMqttVarInt(content, offset, 2);
+        if (size > 0)
+        {
+            map<MqttPropertyType, string> properties = readProperties(content.substr(2 + offset, size));
+            if (properties.count(TOPIC_ALIAS_MAX) > 0)
+            {
+                unsigned long brokerMaximum = stoul(properties.at(TOPIC_ALIAS_MAX));
+                maxTopicAliases = min<unsigned long>(brokerMaximum, m_maxTopicAliases);
+            }
+            if (properties.count(RECEIVE_MAX) > 0) receiveMaximum = stoul(properties.at(RECEIVE_MAX));
+        }
     }
+    m_topicAliases.reset(maxTopicAliases);
+    setInflightWindow(static_cast<uint16_t>(receiveMaximum));
 }
 catch (exception & e)
 {
@@ -485,16 +518,22 @@ catch (exception & e)
  * 
  * @param content 
  */
-void MqttClientV5::parseDisconnect(const std::string & content) try
+void MqttClientV5::parseDisconnect(string_view content) try
 {
-    uint8_t reason = static_cast<uint8_t>(content.at(0));
-    if (reason & 0x80) cout << "Disconnect because of error: " << std::hex << static_cast<int>(reason) << endl;
-
-    uint8_t offset;
-    unsigned int size = readMqttVarInt(content, offset, 1);
-    if (size > 0)
+    // reason and properties may be omitted, if it is a normal disconnection
+    if (content.size() > 0)
+    {
+        uint8_t reason = static_cast<uint8_t>(content.at(0));
+        if (reason & 0x80) cout << "Disconnect because of error: " << std::hex << static_cast<int>(reason) << endl;
+    }
+    if (content.size() > 1)
     {
-        map<MqttPropertyType, string> properties = readProperties(content.substr(1 + offset, size));
+        uint8_t offset;
+        unsigned int size = readMqttVarInt(content, offset, 1);
+        if (size > 0)
+        {
+            map<MqttPropertyType, string> properties = readProperties(content.substr(1 + offset, size));
+        }
     }
 
     m_brokerConnected = false;
@@ -515,7 +554,7 @@ catch (exception & e)
  * @param firstByte the first byte of the fixed header of the MQTT message
  * @param content the variable header and payload of the MQTT message
  */
-void MqttClientV5::parsePublish(uint8_t firstByte, string & content) try
+void MqttClientV5::parsePublish(uint8_t firstByte, string_view content) try
 {
     if (((firstByte & 0xF0) >> 4) != PUBLISH)
     {
@@ -530,25 +569,22 @@ void MqttClientV5::parsePublish(uint8_t firstByte, string & content) try
     uint8_t qos = (flags & 0x06) >> 1;
     bool retain = flags & 0x01;
 
-    string topic = extractMqttString(content);
+    size_t pos = 0;
+    string_view topic = readMqttString(content, pos);
     string identifier;
     if (qos > 0)
     {
-        identifier = content.substr(0, 2);
-        content = content.substr(2);
+        identifier = content.substr(pos, 2);
+        pos += 2;
     }
 
     uint8_t offset;
-    unsigned int size = readMqttVarInt(content, offset);
+    unsigned int size = readMqttVarInt(content, offset, pos);
     if (size > 0)
     {
-        map<MqttPropertyType, string> properties = readProperties(content.substr(offset, size));
+        map<MqttPropertyType, string> properties = readProperties(content.substr(pos + offset, size));
     }
-    content = content.substr(offset + size);
-
-    string msgContent = "";
-    
-    msgContent = content;
+    pos += offset + size;
 
     if (qos == 1)
     {
@@ -557,10 +593,16 @@ void MqttClientV5::parsePublish(uint8_t firstByte, string & content) try
     else if (qos == 2)
     {
         transmitPubRec(identifier);
+        // the broker numbers its PUBLISHes on its own; a resent one, forwarded already, is not again
+        uint16_t packetIdentifier = readMqttIdentifier(identifier);
+        if (m_receivedQoS2.isUsed(packetIdentifier)) return;
+        m_receivedQoS2.markUsed(packetIdentifier);
     }
 
+    // only topic and payload of the Datagram are copied out of the receive buffer
     shared_ptr<DatagramMqtt> datagram(new DatagramMqtt(m_parent.getName(), action,
-                                                       topic, msgContent, qos, retain));
+                                                       string(topic), string(content.substr(pos)),
+                                                       qos, retain));
     m_incomingBuffer.push_back(datagram);
 }
 catch (exception & e)
@@ -575,26 +617,32 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a PUBACK (publish acknowledgment) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV5::parsePubAck(const string & content) try
+void MqttClientV5::parsePubAck(string_view content) try
 {
-    if (content.size() < 4) return;
-
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
+    if (content.size() < 2) return;
 
-    uint8_t reason = static_cast<uint8_t>(content.at(4));
-    if (reason & 0x80) cout << "Error in PUBACK: " << std::hex << reason << endl;
+    uint16_t identifier = readMqttIdentifier(content);
 
-    uint8_t offset;
-    unsigned int size = readMqttVarInt(content, offset, 5);
-    if (size > 0)
+    // reason and properties may be omitted, if everything is ok
+    if (content.size() > 2)
     {
-        map<MqttPropertyType, string> properties = readProperties(content.substr(5 + offset, size));
+        uint8_t reason = static_cast<uint8_t>(content.at(2));
+        if (reason & 0x80) cout << "Error in PUBACK: " << std::hex << reason << endl;
+    }
+    if (content.size() > 3)
+    {
+        uint8_t offset;
+        unsigned int size = readMqttVarInt(content, offset, 3);
+        if (size > 0)
+        {
+            map<MqttPropertyType, string> properties = readProperties(content.substr(3 + offset, size));
+        }
     }
 
     removeNonAcknowledgedData(identifier);
+    releaseInflight(identifier);
 }
 catch (exception & e)
 {
@@ -608,32 +656,45 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a PUBREC (publish received) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV5::parsePubRec(const string & content) try
+void MqttClientV5::parsePubRec(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
-    string identifierAsStr = content.substr(2, 2);
+    uint16_t identifier = readMqttIdentifier(content);
+    string identifierAsStr(content.substr(0, 2));
+    bool failed = false;
 
     // reason and properties may be omitted, if everything is ok
-    if (content.size() > 4)
+    if (content.size() > 2)
+    {
+        uint8_t reason = static_cast<uint8_t>(content.at(2));
+        if (reason & 0x80)
+        {
+            cout << "Error in PUBREC: " << std::hex << reason << endl;
+            failed = true;
+        }
+    }
+    if (content.size() > 3)
     {
-        uint8_t reason = static_cast<uint8_t>(content.at(4));
-        if (reason & 0x80) cout << "Error in PUBREC: " << std::hex << reason << endl;
-
         uint8_t offset;
-        unsigned int size = readMqttVarInt(content, offset, 5);
+        unsigned int size = readMqttVarInt(content, offset, 3);
         if (size > 0)
         {
-            map<MqttPropertyType, string> properties = readProperties(content.substr(5 + offset, size));
+            map<MqttPropertyType, string> properties = readProperties(content.substr(3 + offset, size));
         }
     }
 
-    removeNonAcknowledgedData(identifier);
+    if (failed)
+    {
+        // a failed PUBREC ends the flow, neither PUBREL nor PUBCOMP are going to follow
+        removeNonAcknowledgedData(identifier);
+        releaseInflight(identifier);
+        return;
+    }
 
+    // the PUBREL takes the place of the PUBLISH, the identifier stays reserved until the PUBCOMP
     tranmitPubRel(identifierAsStr);
 }
 catch (exception & e)
@@ -648,31 +709,33 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a PUBREL (publish release) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV5::parsePubRel(const string & content) try
+void MqttClientV5::parsePubRel(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
-    string identifierAsStr = content.substr(2, 2);
+    uint16_t identifier = readMqttIdentifier(content);
+    string identifierAsStr(content.substr(0, 2));
 
     // reason and properties may be omitted, if everything is ok
-    if (content.size() > 4)
+    if (content.size() > 2)
     {
-        uint8_t reason = static_cast<uint8_t>(content.at(4));
+        uint8_t reason = static_cast<uint8_t>(content.at(2));
         if (reason & 0x80) cout << "Error in PUBREL: " << std::hex << reason << endl;
-
+    }
+    if (content.size() > 3)
+    {
         uint8_t offset;
-        unsigned int size = readMqttVarInt(content, offset, 5);
+        unsigned int size = readMqttVarInt(content, offset, 3);
         if (size > 0)
         {
-            map<MqttPropertyType, string> properties = readProperties(content.substr(5 + offset, size));
+            map<MqttPropertyType, string> properties = readProperties(content.substr(3 + offset, size));
         }
     }
 
-    removeNonAcknowledgedData(identifier);
+    // a PUBLISH of the broker with this identifier is a new one from now on
+    m_receivedQoS2.markFree(identifier);
 
     transmitPubComp(identifierAsStr);
 }
@@ -688,30 +751,32 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parases a PUBCOMP (publish complete) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV5::parsePubComp(const string & content) try
+void MqttClientV5::parsePubComp(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
+    uint16_t identifier = readMqttIdentifier(content);
 
     // reason and properties may be omitted, if everything is ok
-    if (content.size() > 4)
+    if (content.size() > 2)
     {
-        uint8_t reason = static_cast<uint8_t>(content.at(4));
+        uint8_t reason = static_cast<uint8_t>(content.at(2));
         if (reason & 0x80) cout << "Error in PUBCOMP: " << std::hex << reason << endl;
-
+    }
+    if (content.size() > 3)
+    {
         uint8_t offset;
-        unsigned int size = readMqttVarInt(content, offset, 5);
+        unsigned int size = readMqttVarInt(content, offset, 3);
         if (size > 0)
         {
-            map<MqttPropertyType, string> properties = readProperties(content.substr(5 + offset, size));
+            map<MqttPropertyType, string> properties = readProperties(content.substr(3 + offset, size));
         }
     }
 
     removeNonAcknowledgedData(identifier);
+    releaseInflight(identifier);
 }
 catch (exception & e)
 {
@@ -725,30 +790,29 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses a SUBACK (subscription acknowledgment) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV5::parseSubAck(const string & content) try
+void MqttClientV5::parseSubAck(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
+    uint16_t identifier = readMqttIdentifier(content);
 
     removeNonAcknowledgedData(identifier);
 
     uint8_t offset;
-    unsigned int size = readMqttVarInt(content, offset, 4);
+    unsigned int size = readMqttVarInt(content, offset, 2);
 
     if (size > 0)
     {
-        map<MqttPropertyType, string> properties = readProperties(content.substr(4 + offset, size));
+        map<MqttPropertyType, string> properties = readProperties(content.substr(2 + offset, size));
     }
 
-    string flags = content.substr(4 + offset + size);
+    string_view flags = content.substr(2 + offset + size);
 
     for (const char & flag : flags)
     {
-        if (flag >= 0x80)
+        if (static_cast<uint8_t>(flag) >= 0x80)
         {
             //TODO: implement fail-behaviour
             cout << "Failed subscription: " << to_string(identifier) << endl;
@@ -772,29 +836,28 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses an UNSUBACK (unsubscribe acknowledgment) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV5::parseUnsubAck(const string & content) try
+void MqttClientV5::parseUnsubAck(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
+    uint16_t identifier = readMqttIdentifier(content);
 
     removeNonAcknowledgedData(identifier);
 
     uint8_t offset;
-    unsigned int size = readMqttVarInt(content, offset, 4);
+    unsigned int size = readMqttVarInt(content, offset, 2);
     if (size > 0)
     {
-        map<MqttPropertyType, string> properties = readProperties(content.substr(4 + offset, size));
+        map<MqttPropertyType, string> properties = readProperties(content.substr(2 + offset, size));
     }
 
-    string flags = content.substr(4 + offset + size);
+    string_view flags = content.substr(2 + offset + size);
 
     for (const char & flag : flags)
     {
-        if (flag >= 0x80)
+        if (static_cast<uint8_t>(flag) >= 0x80)
         {
             //TODO: implement fail-behaviour
             cout << "Failed subscription: " << to_string(identifier) << endl;
@@ -818,14 +881,13 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief parses an AUTH (unsubscribe acknowledgment) MQTT message
  *
- * @param content the complete message
+ * @param content the variable header and payload of the message
  */
-void MqttClientV5::parseAuth(const string & content) try
+void MqttClientV5::parseAuth(string_view content) try
 {
-    if (content.size() < 4) return;
+    if (content.size() < 2) return;
 
-    uint16_t identifier = static_cast<uint16_t>(content.at(2)) << 8;
-    identifier |= static_cast<uint16_t>(content.at(3));
+    uint16_t identifier = readMqttIdentifier(content);
 
     removeNonAcknowledgedData(identifier);
 }
@@ -860,7 +922,7 @@ void MqttClientV5::transmitAuth(bool reauthenticate) try
 
     prepareFixedHeader(AUTH, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -889,7 +951,9 @@ void MqttClientV5::transmitDisconnect() try
 
     prepareFixedHeader(DISCONNECT, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
+    // the DISCONNECT has to be out, before the connection is closed below
+    flushTransmissions();
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 
@@ -911,34 +975,53 @@ catch (exception & e)
  * @param topic the topic under which the @p content is published
  * @param content the content to publish (may be values, may be text)
  * @param flags the 4-bit flags (qos, retain, and dup). dup is currently unused and should not be set by the user
+ * @return uint16_t packet identifier of the PUBLISH (0 with qos 0)
  */
-void MqttClientV5::transmitPublish(const string & topic, const string & content, uint8_t flags) try
+uint16_t MqttClientV5::transmitPublish(const string & topic, const string & content, uint8_t flags) try
 {
-    string data = makeMqttString(topic);
+    // once the broker knows the alias of the topic, the topic is left out
+    uint16_t alias = 0;
+    bool aliasKnown = m_topicAliases.lookUp(topic, alias);
+    string data = makeMqttString(aliasKnown ? string() : topic);
 
     // identifier is only present on qos larger 0
     uint16_t identifier = 0;
-    
+    string identifierAsStr;
+
     if (((flags & 0x06) >> 1) > 0)
     {
         identifier = this->generateIdentifier();
 
-        data += static_cast<char>((identifier & 0xFF00) >> 8);
-        data += static_cast<char>(identifier & 0x00FF);
+        identifierAsStr += static_cast<char>((identifier & 0xFF00) >> 8);
+        identifierAsStr += static_cast<char>(identifier & 0x00FF);
+        data += identifierAsStr;
     }
 
-    // add zero properties (for now)
-    data += static_cast<char>(int(0));
+    // add the topic alias as the only property, if any
+    string properties = (alias != 0) ? makeProperty(TOPIC_ALIAS, static_cast<unsigned int>(alias)) : string();
+    data += makeMqttVarInt(properties.size()) + properties;
 
     data += content;
 
     prepareFixedHeader(PUBLISH, flags, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
-    if (identifier != 0) addNonAcknowledgedData(identifier, data);
+    if (identifier != 0 && alias != 0)
+    {
+        // a resend must not rely on the alias, which is gone after a reconnect
+        string resend = makeMqttString(topic) + identifierAsStr + static_cast<char>(0) + content;
+        prepareFixedHeader(PUBLISH, flags, resend);
+        addNonAcknowledgedData(identifier, resend);
+    }
+    else if (identifier != 0)
+    {
+        addNonAcknowledgedData(identifier, data);
+    }
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
+
+    return identifier;
 }
 catch (exception & e)
 {
@@ -966,7 +1049,7 @@ void MqttClientV5::transmitPubAck(const string & identifier, char reasonCode) tr
 
     prepareFixedHeader(PUBACK, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -996,7 +1079,7 @@ void MqttClientV5::transmitPubRec(const string & identifier, char reasonCode) tr
 
     prepareFixedHeader(PUBREC, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -1011,7 +1094,8 @@ catch (exception & e)
 /**
  * -------------------------------------------------------------------------------------------------
  * @brief creates and sends a PUBREL (publish release) message
- * @details these need to be sent, when this receives a PUBREC message
+ * @details these need to be sent, when this receives a PUBREC message. The PUBREL replaces the
+ * PUBLISH in m_nonAckedData, so that it is resent until the PUBCOMP arrives.
  * @param identifier identifier of the received PUBREC message
  * @param reasonCode MQTT v.5 adds a reason code, to convey more info. this is that
  */
@@ -1026,7 +1110,11 @@ void MqttClientV5::tranmitPubRel(const string & identifier, char reasonCode) try
 
     prepareFixedHeader(PUBREL, 2, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
+
+    // resent until the PUBCOMP, unless the identifier is not (or no more) in use by a PUBLISH
+    uint16_t packetIdentifier = readMqttIdentifier(identifier);
+    if (isNonAcknowledged(packetIdentifier)) addNonAcknowledgedData(packetIdentifier, data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -1056,7 +1144,7 @@ void MqttClientV5::transmitPubComp(const string & identifier, char reasonCode) t
 
     prepareFixedHeader(PUBCOMP, 0, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     m_lastTimeOfSent = std::chrono::steady_clock::now();
 }
@@ -1099,7 +1187,7 @@ void MqttClientV5::transmitSubscribe(const string & topic, uint8_t qos) try
 
     prepareFixedHeader(SUBSCRIBE, 2, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     addNonAcknowledgedData(identifier, data);
 
@@ -1135,7 +1223,7 @@ void MqttClientV5::transmitUnsubscribe(const string & topic) try
 
     prepareFixedHeader(UNSUBSCRIBE, 2, data);
 
-    m_transportLayer->transmit(data);
+    queueTransmission(data);
 
     addNonAcknowledgedData(identifier, data);
 
@@ -33,10 +33,15 @@ using namespace std;
  * 
  * @param parent the Plag this is a child item of
  */
-MqttInterface::MqttInterface(const Plag & parent, const string & brokerIP, unsigned int brokerPort) :
+MqttInterface::MqttInterface(Plag & parent, const string & brokerIP, unsigned int brokerPort) :
     m_parent(parent),
     m_brokerIP(brokerIP),
-    m_brokerPort(brokerPort)
+    m_brokerPort(brokerPort),
+    m_currentIdentifier(0),
+    m_nonAckedData(65536),
+    m_retryInterval(5000),
+    // 10 ms ticks and a turn of about 5 s: the default m_retryInterval is served without rounds
+    m_retransmitWheel(std::chrono::milliseconds(10), 512, 65536)
 {
 }
 
@@ -130,9 +135,46 @@ catch (exception & e)
     throw eEdited;
 }
 
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief reads an MQTT string from @p data without copying it
+ * @details contrary to extractMqttString() @p data stays untouched. Instead @p pos is moved
+ *          behind the MQTT string, so the next item can be read from there.
+ * @param data the raw data received from an MQTT broker (may be longer than needed)
+ * @param pos where the MQTT string starts. Will point behind it afterwards
+ * @return string_view the content of the MQTT string (or everything after the first two bytes,
+ *         should length not match). Only valid as long as @p data is.
+ */
+string_view MqttInterface::readMqttString(string_view data, size_t & pos) const try
+{
+    uint16_t size = static_cast<uint8_t>(data.at(pos + 1));
+    size |= static_cast<uint16_t>(static_cast<uint8_t>(data.at(pos))) << 8;
+    string_view content;
+    if (data.size() - 2 - pos < size)
+    {
+        cout << "Received MQTT string, that is smaller than indicated: " << data << endl;
+        content = data.substr(2 + pos);
+    }
+    else
+    {
+        content = data.substr(2 + pos, size);
+    }
+    pos += 2 + content.size();
+    return content;
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttInterface::readMqttString()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
 /**
  *-------------------------------------------------------------------------------------------------
  * @brief creates a string of up to four bytes representing an MQTT variable integer
+ * @details see chapter 1.5.5 (MQTT v.5 doc): 7 bit per byte, least significant first, the highest
+ *          bit tells, that another byte follows
  * 
  * @param value a number of up to 28 bit size
  * @return string 
@@ -141,10 +183,13 @@ string MqttInterface::makeMqttVarInt(unsigned int value) const try
 {
     string varInt;
     value &= 0x0FFFFFFF;
-    if (value > 0x001FFFFF) varInt += static_cast<char>(((value & 0x0FE00000) >> 21) | 0x80);
-    if (value > 0x00003FFF) varInt += static_cast<char>(((value & 0x001FC000) >> 14) | 0x80);
-    if (value > 0x0000007F) varInt += static_cast<char>(((value & 0x00003F80) >> 7) | 0x80);
     varInt += static_cast<char>(value & 0x7F);
+    while (value > 0x7F)
+    {
+        varInt.back() |= 0x80;
+        value >>= 7;
+        varInt += static_cast<char>(value & 0x7F);
+    }
     return varInt;
 }
 catch (exception & e)
@@ -165,21 +210,15 @@ catch (exception & e)
  * @param offset number of bytes read
  * @param pos Where to start reading in @p data
  * @return unsigned int
+ * @sa MqttInterface::decodeMqttVarInt()
  */
-unsigned int MqttInterface::readMqttVarInt(const string & data, uint8_t & offset, size_t pos) const try
+unsigned int MqttInterface::readMqttVarInt(string_view data, uint8_t & offset, size_t pos) const try
 {
-    size_t initPos = pos;
-    uint8_t byte;
-    offset = 0;
     unsigned int number = 0;
-    do
+    if (!decodeMqttVarInt(data, pos, number, offset))
     {
-        byte = static_cast<unsigned char>(data.at(pos++));
-        number |= byte & 0x7F;
-        if (byte & 0x80) number <<= 7;
-        ++offset;
-    } while (byte & 0x80 && pos - initPos <= 4);
-    if (pos - initPos >= 5) throw std::invalid_argument("VarInts have a max size of 4 bytes!");
+        throw std::out_of_range("VarInt exceeds the data!");
+    }
     return number;
 }
 catch (exception & e)
@@ -190,6 +229,57 @@ catch (exception & e)
     throw eEdited;
 }
 
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief decodes a variable int (e.g. the remaining length or the length of properties)
+ * @details see chapter 1.5.5 (MQTT v.5 doc): 7 bit per byte, least significant first, the highest
+ *          bit tells, that another byte follows
+ *
+ * @param data raw bytes, containing the variable int
+ * @param startPos where the variable int starts in @p data
+ * @param value the decoded number
+ * @param length number of bytes the variable int takes
+ * @return true if the variable int was complete
+ * @return false if @p data ends before the last byte of the variable int
+ */
+bool MqttInterface::decodeMqttVarInt(string_view data, size_t startPos, unsigned int & value,
+                                     uint8_t & length)
+{
+    value = 0;
+    length = 0;
+    while (startPos + length < data.size())
+    {
+        if (length >= 4) throw std::invalid_argument("VarInts have a max size of 4 bytes!");
+        uint8_t byte = static_cast<uint8_t>(data[startPos + length]);
+        value |= static_cast<unsigned int>(byte & 0x7F) << (length * 7);
+        ++length;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief reads a packet identifier (two byte integer, MSB first) from @p data
+ *
+ * @param data the raw data, from which to read the identifier
+ * @param pos Where to start reading in @p data
+ * @return uint16_t the packet identifier
+ */
+uint16_t MqttInterface::readMqttIdentifier(string_view data, size_t pos) const try
+{
+    uint16_t identifier = static_cast<uint16_t>(static_cast<uint8_t>(data.at(pos))) << 8;
+    identifier |= static_cast<uint8_t>(data.at(pos + 1));
+    return identifier;
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttInterface::readMqttIdentifier()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
 /**
  * -------------------------------------------------------------------------------------------------
  * @brief generates the fixed header of an MQTT telegram and prepends it to @p content .
@@ -209,19 +299,8 @@ void MqttInterface::prepareFixedHeader(MqttMessageType type, uint8_t flags, stri
     header += firstByte;
 
     // we are allowd a maxium of 28 bit of length
-    uint32_t length = content.size() & 0x0FFFFFFF;
+    header += makeMqttVarInt(static_cast<unsigned int>(content.size()));
 
-    // starting with LSB append current "byte"
-    header += static_cast<char>(length & 0x7F);
-    while (length > 0x7F)
-    {
-        // mask the first bit of the last byte, as we know, that there is data following
-        header.back() |= 0x80;
-        // we already wrote 7 bit (either before or last loop), so we'll jump ahead
-        length >>= 7;
-        // append the current byte
-        header += static_cast<char>(length & 0x7F);
-    }
     // prepend the first byte (which means, that we are done)
     content.insert(0, header);
 }
@@ -236,116 +315,58 @@ catch (exception & e)
 /**
  * -------------------------------------------------------------------------------------------------
  * @brief evaluates buffer for complete MQTT telegrams and calls appropriate parsers.
- * @details this not only evaluates @p inBuffer , but also shortens it by the evaluated part
+ * @details this not only evaluates @p inBuffer , but also shortens it by the evaluated part.
+ *          The fixed headers are decoded in place and the parsers get views into @p inBuffer ,
+ *          so no packet is copied. The evaluated part is erased once, after all complete
+ *          telegrams were parsed, which keeps a burst of many small telegrams linear.
  *
  * @param inBuffer the buffer to evaluate and shorten (if appropriate)
- * @return 0, if buffer contained a complete message
+ * @return 0, if buffer contained only complete messages
  * @return number of bytes until message is complete, else
  */
 size_t MqttInterface::parseIncomingBuffer(string & inBuffer) try
 {
-    // data too litte to contain anything
-    if (inBuffer.size() < 2) return 0;
-    while (inBuffer.size() > 2)
+    string_view buffer(inBuffer);
+    size_t parsedBytes = 0;
+    size_t missingBytes = 0;
+    while (buffer.size() - parsedBytes >= 2)
     {
-        size_t currentBytePos = 0;
-        uint8_t firstHalfByte = (inBuffer.at(currentBytePos) & 0xF0) >> 4;
-        MqttMessageType msgType = static_cast<MqttMessageType>(firstHalfByte);
-        uint8_t flags = inBuffer.at(currentBytePos) & 0x0F;
-        size_t packetLength = inBuffer.at(++currentBytePos) & 0x7F;
-        while ((inBuffer.at(currentBytePos) & 0x80) == 0x80
-               && inBuffer.size() > currentBytePos + 1
-               && currentBytePos < 5)
-        {
-            currentBytePos++;
-            packetLength |= static_cast<size_t>(inBuffer.at(currentBytePos) & 0x7F)
-                            << (currentBytePos - 1) * 7;
-        }
+        string_view packet = buffer.substr(parsedBytes);
+        // remaining length: a variable int right after the first byte
+        unsigned int remainingLength = 0;
+        uint8_t lengthBytes = 0;
         // data does not contain entire package -> wait
-        if (inBuffer.size() <= currentBytePos + packetLength)
+        if (!decodeMqttVarInt(packet, 1, remainingLength, lengthBytes))
         {
-            return currentBytePos + packetLength - inBuffer.size() + 1;
+            missingBytes = 1;
+            break;
         }
-        uint8_t packetType = (inBuffer.at(0) & 0xF0) >> 4;
-        switch (packetType)
+        size_t headerLength = 1 + lengthBytes;
+        size_t packetLength = remainingLength;
+        if (packet.size() < headerLength + packetLength)
         {
-        case CONNECT:
-            {
-                string connect = inBuffer.substr(2, packetLength + 2);
-                parseConnect(connect);
-            }
-            break;
-        case CONNACK:
-            {
-                string connack = inBuffer.substr(0, packetLength + 2);
-                parseConnAck(connack);
-            }
-            break;
-        case PUBLISH:
-            {
-                string publish = inBuffer.substr(2, packetLength + 2);
-                uint8_t firstByte = inBuffer.at(0);
-                parsePublish(firstByte, publish);
-            }
+            missingBytes = headerLength + packetLength - packet.size();
             break;
-        case PUBACK:
-            {
-                string puback = inBuffer.substr(0, packetLength + 2);
-                parsePubAck(puback);
-            }
-            break;
-        case PUBREC:
-            {
-                string pubRec = inBuffer.substr(0, packetLength + 2);
-                parsePubRec(pubRec);
-            }
-            break;
-        case PUBREL:
-            {
-                string pubRel = inBuffer.substr(0, packetLength + 2);
-                parsePubRel(pubRel);
-            }
-            break;
-        case PUBCOMP:
-            {
-                string pubComplete = inBuffer.substr(0, packetLength + 2);
-                parsePubComp(pubComplete);
-            }
-            break;
-        case SUBACK:
-            {
-                string suback = inBuffer.substr(0, packetLength + 2);
-                parseSubAck(suback);
-            }
-            break;
-        case UNSUBACK:
-            {
-                string unsuback = inBuffer.substr(0, packetLength + 2);
-                parseUnsubAck(unsuback);
-            }
-            break;
-        case DISCONNECT:
-            {
-                string disconnect = inBuffer.substr(2, packetLength + 2);
-                parseDisconnect(disconnect);
-            }
-            break;
-        case AUTH:
-            {
-                string auth = inBuffer.substr(2, packetLength + 2);
-                parseAuth(auth);
-            }
-            break;
-        case PINGREP:
-            if (packetLength != 0) cout << "Unexpected packet length for PINGREP" << endl;
-            break;
-        default:
-            cout << "Unknown packet type: " + to_string(packetType) << endl;
         }
+        try
+        {
+            dispatchPacket(packet[0], packet.substr(headerLength, packetLength));
+        }
+        catch (exception & e)
+        {
+            // drop what was parsed, including the faulty telegram, so it is not parsed again
+            inBuffer.erase(0, parsedBytes + headerLength + packetLength);
+            throw;
+        }
+        parsedBytes += headerLength + packetLength;
+    }
+    if (parsedBytes > 0)
+    {
         m_lastTimeReceived = std::chrono::steady_clock::now();
-        inBuffer = (inBuffer.size() > packetLength + 2) ? inBuffer.substr(packetLength + 2) : "";
+        inBuffer.erase(0, parsedBytes);
     }
-    return 0;
+    if (missingBytes == 0 && inBuffer.size() == 1) missingBytes = 1;
+    return missingBytes;
 }
 catch (exception & e)
 {
@@ -355,21 +376,79 @@ catch (exception & e)
     throw eEdited;
 }
 
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief calls the parser appropriate for the type of a complete MQTT telegram
+ *
+ * @param firstByte the first byte of the fixed header (type and flags)
+ * @param content the variable header and payload of the telegram (fixed header stripped)
+ */
+void MqttInterface::dispatchPacket(uint8_t firstByte, string_view content) try
+{
+    uint8_t packetType = (firstByte & 0xF0) >> 4;
+    switch (packetType)
+    {
+    case CONNECT:
+        parseConnect(content);
+        break;
+    case CONNACK:
+        parseConnAck(content);
+        break;
+    case PUBLISH:
+        parsePublish(firstByte, content);
+        break;
+    case PUBACK:
+        parsePubAck(content);
+        break;
+    case PUBREC:
+        parsePubRec(content);
+        break;
+    case PUBREL:
+        parsePubRel(content);
+        break;
+    case PUBCOMP:
+        parsePubComp(content);
+        break;
+    case SUBACK:
+        parseSubAck(content);
+        break;
+    case UNSUBACK:
+        parseUnsubAck(content);
+        break;
+    case DISCONNECT:
+        parseDisconnect(content);
+        break;
+    case AUTH:
+        parseAuth(content);
+        break;
+    case PINGREP:
+        if (content.size() != 0) cout << "Unexpected packet length for PINGREP" << endl;
+        break;
+    default:
+        cout << "Unknown packet type: " + to_string(packetType) << endl;
+    }
+}
+catch (exception & e)
+{
+    string errorMsg = e.what();
+    errorMsg += "\nSomething happened in MqttInterface::dispatchPacket()";
+    runtime_error eEdited(errorMsg);
+    throw eEdited;
+}
+
 /**
  * -------------------------------------------------------------------------------------------------
  * @brief convenience function to generate correct packet identifier
  * @details an identifier is an unsigned 16 bit integer. it may not be a duplicate of an identifier
- * that is assigned to a currently handled packet. This function hence counts the identifier up
- * and avoids the 0, as it is not allowed, and any identifiers, that still might be in the loop
+ * that is assigned to a currently handled packet. This function hence looks for the next identifier
+ * after the last one, that is not marked in m_usedIdentifiers.
  * @return uint16_t a value between 1 and 65535, that is currently free
+ *
+ * @throws std::runtime_error if all identifiers are in use
  */
 uint16_t MqttInterface::generateIdentifier() try
 {
-    do
-    {
-        ++m_currentIdentifier;
-    } while (m_nonAckedData.count(m_currentIdentifier) > 0 || m_currentIdentifier == 0);
-
+    m_currentIdentifier = m_usedIdentifiers.findFreeAfter(m_currentIdentifier);
     return m_currentIdentifier;
 }
 catch (exception & e)
@@ -384,8 +463,9 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief convenience function to keep a sent packet in the loop until it is resolved
  * @details some packets (definitely NOT all) require acknowledgements and should be resent, if
- * that acknowledgement fails to come. Therefore we'll hold that packet with current time information
- * in a map, tied to its identifier, for quick access. This function adds the packet to the map.
+ * that acknowledgement fails to come. Therefore we'll hold that packet in an array, indexed by its
+ * identifier, for quick access. This function adds the packet to the array, marks the identifier
+ * as used and schedules its resend m_retryInterval from now.
  * @param identifier packet identifier the broker knows this packet by
  * @param data the raw binary data, that was handed to TcpClient, as to avoid regenerating it
  * @sa MqttInterface::generateIdentifier()
@@ -394,10 +474,9 @@ catch (exception & e)
  */
 void MqttInterface::addNonAcknowledgedData(uint16_t identifier, const string & data) try
 {
-    //ATTENTION: using namespace for brevity
-    using namespace std::chrono;
-    std::pair<string, steady_clock::time_point> value(data, steady_clock::now());
-    m_nonAckedData.insert_or_assign(identifier, value);
+    m_nonAckedData[identifier] = data;
+    m_usedIdentifiers.markUsed(identifier);
+    m_retransmitWheel.schedule(identifier, std::chrono::steady_clock::now() + m_retryInterval);
 }
 catch (exception & e)
 {
@@ -411,17 +490,19 @@ catch (exception & e)
  * -------------------------------------------------------------------------------------------------
  * @brief convenience function to remove a packet from the loop, assuming it was resolved
  * @details some packets (those with QoS > 0) require acknowledgements and should be resent, if
- * that acknowledgement fails to come. Therefore we'll hold that packet with current time information
- * in a map, tied to its identifier, for quick access. This function removes the packet from the map.
+ * that acknowledgement fails to come. Therefore we'll hold that packet in an array, indexed by its
+ * identifier, for quick access. This function removes the packet from the array, cancels its
+ * resend and frees the identifier.
  * @param identifier packet identifier the broker knows this packet by
  * @sa MqttInterface::addNonAcknowledgedData()
  */
 void MqttInterface::removeNonAcknowledgedData(uint16_t identifier) try
 {
-    if (m_nonAckedData.count(identifier) > 0)
-    {
-        m_nonAckedData.erase(identifier);
-    }
+    if (!isNonAcknowledged(identifier)) return;
+    m_usedIdentifiers.markFree(identifier);
+    m_retransmitWheel.cancel(identifier);
+    // release the memory, as packets may be large and there are many identifiers
+    string().swap(m_nonAckedData[identifier]);
 }
 catch (exception & e)
 {
@@ -429,4 +510,29 @@ catch (exception & e)
     errorMsg += "\nSomething happened in MqttInterface::removeNonAcknowledgedData()";
     runtime_error eEdited(errorMsg);
     throw eEdited;
-}
\ No newline at end of file
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief checks, whether a packet with @p identifier awaits its acknowledgement
+ *
+ * @param identifier packet identifier
+ * @return true, if m_nonAckedData holds a packet for @p identifier
+ * @return false, else
+ */
+bool MqttInterface::isNonAcknowledged(uint16_t identifier) const
+{
+    return m_usedIdentifiers.isUsed(identifier);
+}
+
+/**
+ * -------------------------------------------------------------------------------------------------
+ * @brief appends the identifiers of all packets, that await their acknowledgement, in ascending
+ * order
+ *
+ * @param identifiers the identifiers are appended here
+ */
+void MqttInterface::collectNonAcknowledged(vector<uint64_t> & identifiers) const
+{
+    m_usedIdentifiers.collectUsed(identifiers);
+}
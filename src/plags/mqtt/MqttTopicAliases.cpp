@@ -0,0 +1,117 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file MqttTopicAliases.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Implements the MqttTopicAliases class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// self include
+#include "MqttTopicAliases.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new MqttTopicAliases:: MqttTopicAliases object, that uses no aliases, until
+ * reset() with the maximum of the broker
+ *
+ */
+MqttTopicAliases::MqttTopicAliases() :
+    m_maximum(0),
+    m_hits(0)
+{
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief forgets all aliases, as needed for a new connection
+ *
+ * @param maximum most aliases to use from now on (0: none)
+ */
+void MqttTopicAliases::reset(uint16_t maximum)
+{
+    m_maximum = maximum;
+    m_entries.clear();
+    m_index.clear();
+    m_index.reserve(m_maximum);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief finds the alias of @p topic. Unknown topics get the next free alias, or the one of the
+ * least recently used topic, if all are taken.
+ *
+ * @param topic the topic to publish to
+ * @param alias the alias to send along (0: no alias, as getMaximum() is 0)
+ * @return true if the broker knows @p alias already, so the topic may be left out
+ * @return false if the topic needs to be sent along with @p alias
+ */
+bool MqttTopicAliases::lookUp(const string & topic, uint16_t & alias)
+{
+    alias = 0;
+    if (m_maximum == 0) return false;
+    list<Entry>::iterator entry = m_entries.begin();
+    // consecutive PUBLISHes mostly go to the same topic, which needs no hashing
+    if (entry == m_entries.end() || entry->topic != topic)
+    {
+        unordered_map<string, list<Entry>::iterator>::iterator found = m_index.find(topic);
+        if (found == m_index.end())
+        {
+            if (m_entries.size() < m_maximum)
+            {
+                m_entries.push_front(Entry{ topic, static_cast<uint16_t>(m_entries.size() + 1) });
+            }
+            else
+            {
+                // reassign the alias of the least recently used topic
+                m_entries.splice(m_entries.begin(), m_entries, prev(m_entries.end()));
+                m_index.erase(m_entries.front().topic);
+                m_entries.front().topic = topic;
+            }
+            m_index.emplace(topic, m_entries.begin());
+            alias = m_entries.front().alias;
+            return false;
+        }
+        entry = found->second;
+        m_entries.splice(m_entries.begin(), m_entries, entry);
+    }
+    m_hits++;
+    alias = entry->alias;
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return uint16_t most aliases in use (0: none)
+ */
+uint16_t MqttTopicAliases::getMaximum() const
+{
+    return m_maximum;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return uint64_t PUBLISHes, that could leave out the topic
+ */
+uint64_t MqttTopicAliases::getHits() const
+{
+    return m_hits;
+}
@@ -0,0 +1,253 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file DataExpression.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Implements the DataExpression class
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <stdexcept>
+#include <vector>
+
+// boost includes
+#include <boost/algorithm/string.hpp>
+
+// own includes
+#include "DatagramHttpServer.hpp"
+#include "DatagramMqtt.hpp"
+#include "DatagramUdp.hpp"
+
+// self include
+#include "DataExpression.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new DataExpression:: DataExpression object parses @p expression
+ *
+ * @param expression the text of the expression, as found in the config file
+ * @param sourceType type of the Plag, the evaluated Datagrams come from (none: not known)
+ *
+ * @throws std::invalid_argument if @p expression is a malformed SPLIT
+ */
+DataExpression::DataExpression(const string & expression, PlagType sourceType) :
+    m_type(KEY),
+    m_text(expression),
+    m_field(Datagram::FIELD_NONE),
+    m_index(0)
+{
+    if (expression.empty())
+    {
+        m_type = LITERAL;
+        m_literal = string();
+    }
+    else if (isDigit(expression.front()))
+    {
+        m_type = LITERAL;
+        m_literal = expression;
+    }
+    else if (expression.size() >= 2 && startsWith('\"', expression) && endsWith('\"', expression))
+    {
+        m_type = LITERAL;
+        m_literal = expression.substr(1, expression.size() - 2);
+    }
+    else if (expression.find("SPLIT(") == 0)
+    {
+        m_type = SPLIT;
+        parseSplit(sourceType);
+    }
+    else
+    {
+        m_key = expression;
+        m_field = lookUpFieldId(sourceType, m_key);
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief resolves @p key to the FieldId of the Datagrams a Plag of @p plagType creates
+ *
+ * @param plagType type of the Plag
+ * @param key name of the field
+ * @return FieldId id of the field, or Datagram::FIELD_NONE if it needs to be accessed by name
+ */
+FieldId DataExpression::lookUpFieldId(PlagType plagType, const string & key)
+{
+    switch (plagType)
+    {
+    case PlagType::UDP:
+        return DatagramUdp::getFieldId(key);
+    case PlagType::MQTT:
+        return DatagramMqtt::getFieldId(key);
+    case PlagType::HttpServer:
+        return DatagramHttpServer::getFieldId(key);
+    case PlagType::none:
+        //deliberate fall-through
+    default:
+        return Datagram::FIELD_NONE;
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief computes the value of this expression for @p datagram
+ *
+ * @param datagram the Datagram to read keys from
+ * @return DataType the value; a SPLIT without index returns all parts as vector<string>
+ *
+ * @throws std::invalid_argument if the index of a SPLIT exceeds the number of parts
+ */
+DataType DataExpression::evaluate(const Datagram & datagram) const
+{
+    switch (m_type)
+    {
+    case LITERAL:
+        return m_literal;
+    case KEY:
+        if (m_field != Datagram::FIELD_NONE) return datagram.getField(m_field);
+        return datagram.getData(m_key);
+    case SPLIT:
+    {
+        string value = convertDataTypeToString(m_inner->evaluate(datagram));
+        if (m_index == 0)
+        {
+            vector<string> parts;
+            boost::split(parts, value, boost::is_any_of(m_separators));
+            return parts;
+        }
+        // walk to the wanted part, instead of splitting all of them
+        size_t partStart = 0;
+        for (size_t part = 1; part < m_index; part++)
+        {
+            partStart = value.find_first_of(m_separators, partStart);
+            if (partStart == string::npos)
+            {
+                throw std::invalid_argument("Index invalid in " + m_text
+                                            + ". Hint: indices in config file start at 1");
+            }
+            ++partStart;
+        }
+        size_t partEnd = value.find_first_of(m_separators, partStart);
+        if (partEnd == string::npos) partEnd = value.size();
+        return value.substr(partStart, partEnd - partStart);
+    }
+    default:
+        throw std::invalid_argument("Unknown type of DataExpression " + m_text);
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return ExpressionType what kind of expression this is
+ */
+DataExpression::ExpressionType DataExpression::getType() const
+{
+    return m_type;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return const string & the expression as configured
+ */
+const string & DataExpression::getText() const
+{
+    return m_text;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return const DataType & the value of a LITERAL (empty for other types)
+ */
+const DataType & DataExpression::getLiteral() const
+{
+    return m_literal;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief splits m_text of the form SPLIT(inner,separators).index into its parts. Brackets and
+ * commas inside of quotes or of nested brackets belong to the inner expression.
+ *
+ * @param sourceType type of the Plag, the evaluated Datagrams come from (none: not known)
+ */
+void DataExpression::parseSplit(PlagType sourceType)
+{
+    size_t openBracketCount = 0;
+    size_t closingBracketPos = 0;
+    size_t argumentSeparatorPos = 0;
+    bool escaping = false;
+    bool inLiteral = false;
+    for (size_t i = 6; i < m_text.size(); i++)
+    {
+        if (m_text.at(i) == '\"' && inLiteral && !escaping)
+        {
+            inLiteral = false;
+        }
+        else if (m_text.at(i) == '\"' && !inLiteral && !escaping)
+        {
+            inLiteral = true;
+        }
+        else if (m_text.at(i) == '\\' && inLiteral)
+        {
+            escaping = true;
+        }
+        else if (m_text.at(i) == '(' && !inLiteral)
+        {
+            ++openBracketCount;
+        }
+        else if (m_text.at(i) == ')' && !inLiteral && openBracketCount > 0)
+        {
+            --openBracketCount;
+        }
+        else if (m_text.at(i) == ')' && !inLiteral)
+        {
+            closingBracketPos = i;
+            break;
+        }
+        else if (m_text.at(i) == ',' && !inLiteral && openBracketCount == 0)
+        {
+            argumentSeparatorPos = i;
+        }
+        else
+        {
+            escaping = false;
+        }
+    }
+    if (closingBracketPos == 0) throw std::invalid_argument("Need closing bracket in " + m_text);
+    if (argumentSeparatorPos == 0) throw std::invalid_argument("Need \",\" in " + m_text);
+    m_inner = make_shared<const DataExpression>(m_text.substr(6, argumentSeparatorPos - 6),
+                                                sourceType);
+    size_t separatorsLength = closingBracketPos - argumentSeparatorPos - 1;
+    m_separators = m_text.substr(argumentSeparatorPos + 1, separatorsLength);
+    if (closingBracketPos + 2 < m_text.size() && m_text.at(closingBracketPos + 1) == '.'
+        && isDigit(m_text.at(closingBracketPos + 2)))
+    {
+        m_index = stoul(m_text.substr(closingBracketPos + 2), nullptr, 10);
+        if (m_index == 0)
+        {
+            throw std::invalid_argument("Index invalid in " + m_text
+                                        + ". Hint: indices in config file start at 1");
+        }
+    }
+}
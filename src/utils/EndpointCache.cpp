@@ -0,0 +1,229 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file EndpointCache.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Implements the EndpointCache class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+
+// std includes
+#include <iostream>
+#include <stdexcept>
+
+// self include
+#include "EndpointCache.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new EndpointCache:: EndpointCache object, that is empty
+ *
+ * @param strand strand the lookups run on, resolves complete on it as well
+ * @param capacity most entries to keep (at least 1)
+ * @param timeToLive how long a resolved hostname is used, before it is resolved again
+ * @param failureTimeToLive how long a hostname, that could not be resolved, is not tried again
+ * @param onResolved called on @p strand, whenever a resolve completed, so that Datagrams waiting
+ * for it are looked up again
+ */
+EndpointCache::EndpointCache(boost::asio::strand<boost::asio::io_context::executor_type> & strand,
+                             size_t capacity, chrono::seconds timeToLive,
+                             chrono::seconds failureTimeToLive, function<void()> onResolved) :
+    m_strand(strand),
+    m_resolver(strand),
+    m_capacity(max<size_t>(capacity, 1)),
+    m_timeToLive(timeToLive),
+    m_failureTimeToLive(failureTimeToLive),
+    m_onResolved(move(onResolved)),
+    m_hits(0),
+    m_misses(0)
+{
+    m_index.reserve(m_capacity);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief finds the endpoint to send to @p receiver at @p port. Unknown receivers are parsed, or
+ * resolved in the background if they are no IPv4 address, and cached. Never blocks.
+ *
+ * @param receiver IPv4 address or hostname
+ * @param port port to send to
+ * @param endpoint set to the endpoint, if it is RESOLVED
+ * @return Resolution RESOLVED, RESOLVING (look up again, once the handler given to the
+ * constructor was called) or UNRESOLVABLE
+ */
+EndpointCache::Resolution EndpointCache::lookUp(const string & receiver, uint16_t port,
+                                                boost::asio::ip::udp::endpoint & endpoint)
+{
+    list<Entry>::iterator entry = m_entries.begin();
+    // consecutive Datagrams mostly go to the same receiver, which needs no hashing
+    if (entry == m_entries.end() || entry->port != port || entry->host != receiver)
+    {
+        makeKey(receiver, port);
+        unordered_map<string, list<Entry>::iterator>::iterator found = m_index.find(m_key);
+        if (found == m_index.end())
+        {
+            m_misses++;
+            insert(receiver, port);
+        }
+        else
+        {
+            m_hits++;
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+        }
+        entry = m_entries.begin();
+    }
+    else
+    {
+        m_hits++;
+    }
+    if (entry->isHostname && !entry->resolving && chrono::steady_clock::now() >= entry->expiry)
+    {
+        startResolve(*entry);
+    }
+    if (entry->resolution == RESOLVED) endpoint = entry->endpoint;
+    return entry->resolution;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return uint64_t lookups answered by an entry
+ */
+uint64_t EndpointCache::getHits() const
+{
+    return m_hits;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return uint64_t lookups that needed a new entry
+ */
+uint64_t EndpointCache::getMisses() const
+{
+    return m_misses;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief writes the key of @p receiver and @p port to m_key, reusing its memory
+ *
+ * @param receiver IPv4 address or hostname
+ * @param port port to send to
+ */
+void EndpointCache::makeKey(const string & receiver, uint16_t port)
+{
+    m_key.assign(receiver);
+    m_key.push_back(':');
+    m_key.append(to_string(port));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief creates the entry for m_key as the most recently used one, evicting the least recently
+ * used one, if the cache is full. A hostname is RESOLVING and due to be resolved right away.
+ *
+ * @param receiver IPv4 address or hostname
+ * @param port port to send to
+ * @return Entry & the new entry
+ */
+EndpointCache::Entry & EndpointCache::insert(const string & receiver, uint16_t port)
+{
+    Entry entry;
+    entry.key = m_key;
+    entry.host = receiver;
+    entry.port = port;
+    entry.resolving = false;
+    boost::system::error_code error;
+    boost::asio::ip::address_v4 address = boost::asio::ip::make_address_v4(receiver, error);
+    entry.isHostname = static_cast<bool>(error);
+    if (entry.isHostname)
+    {
+        entry.resolution = RESOLVING;
+        entry.expiry = chrono::steady_clock::time_point::min();
+    }
+    else
+    {
+        entry.resolution = RESOLVED;
+        entry.endpoint = boost::asio::ip::udp::endpoint(address, port);
+    }
+
+    if (m_entries.size() >= m_capacity)
+    {
+        m_index.erase(m_entries.back().key);
+        m_entries.pop_back();
+    }
+    m_entries.push_front(move(entry));
+    m_index[m_entries.front().key] = m_entries.begin();
+    return m_entries.front();
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief starts to resolve the hostname of @p entry. Until it completes, a known endpoint is used,
+ * else the entry is RESOLVING. If it fails, a known endpoint is used for another time to live,
+ * else the entry is UNRESOLVABLE for m_failureTimeToLive.
+ *
+ * @param entry entry with a new or expired hostname
+ */
+void EndpointCache::startResolve(Entry & entry)
+{
+    entry.resolving = true;
+    if (entry.resolution == UNRESOLVABLE) entry.resolution = RESOLVING;
+    string key = entry.key;
+    m_resolver.async_resolve(boost::asio::ip::udp::v4(), entry.host, to_string(entry.port),
+        boost::asio::bind_executor(m_strand,
+            [this, key](const boost::system::error_code & error,
+                        boost::asio::ip::udp::resolver::results_type results)
+            {
+                if (error == boost::asio::error::operation_aborted) return;
+                // the entry may have been evicted meanwhile
+                unordered_map<string, list<Entry>::iterator>::iterator found = m_index.find(key);
+                if (found != m_index.end())
+                {
+                    Entry & resolved = *found->second;
+                    resolved.resolving = false;
+                    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+                    string reason = error ? error.message() : "no IPv4 address found";
+                    if (!error && !results.empty())
+                    {
+                        resolved.endpoint = results.begin()->endpoint();
+                        resolved.resolution = RESOLVED;
+                        resolved.expiry = now + m_timeToLive;
+                    }
+                    else if (resolved.resolution == RESOLVED)
+                    {
+                        cout << "Could not resolve " << resolved.host << " again, keeping "
+                             << resolved.endpoint << ": " << reason << endl;
+                        resolved.expiry = now + m_timeToLive;
+                    }
+                    else
+                    {
+                        cout << "Could not resolve " << resolved.host
+                             << ", dropping Datagrams to it for " << m_failureTimeToLive.count()
+                             << " s: " << reason << endl;
+                        resolved.resolution = UNRESOLVABLE;
+                        resolved.expiry = now + m_failureTimeToLive;
+                    }
+                }
+                // the Datagrams waiting are looked up again, even for an evicted entry
+                if (m_onResolved) m_onResolved();
+            }));
+}
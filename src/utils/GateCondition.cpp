@@ -0,0 +1,500 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file GateCondition.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Implements the GateCondition class
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <cstdlib>
+#include <stdexcept>
+
+// self include
+#include "GateCondition.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new GateCondition:: GateCondition object parses @p condition
+ *
+ * @param condition the text of the condition, as found in the config file
+ * @param sourceType type of the Plag, the evaluated Datagrams come from (none: not known)
+ *
+ * @throws std::invalid_argument if @p condition is malformed
+ */
+GateCondition::GateCondition(const string & condition, PlagType sourceType) :
+    m_text(condition),
+    m_sourceType(sourceType)
+{
+    size_t pos = 0;
+    m_root = parseOr(pos);
+    skipSpaces(pos);
+    if (pos < m_text.size())
+    {
+        throw std::invalid_argument("Unexpected \"" + m_text.substr(pos) + "\" in gateCondition "
+                                    + m_text);
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks whether @p datagram may pass
+ *
+ * @param datagram the Datagram to check
+ * @return true if the condition is true for @p datagram
+ * @return false else
+ */
+bool GateCondition::evaluate(const Datagram & datagram) const
+{
+    return evaluateNode(m_root, datagram);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return const string & the condition as configured
+ */
+const string & GateCondition::getText() const
+{
+    return m_text;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief parses conditions joined by "||"
+ *
+ * @param pos position in m_text to start at; set to the position after the parsed part
+ * @return Node the compiled part
+ */
+GateCondition::Node GateCondition::parseOr(size_t & pos) const
+{
+    Node node = parseAnd(pos);
+    while (consume(pos, "||"))
+    {
+        if (node.operation != OR)
+        {
+            Node orNode{ OR, { move(node) }, {}, 0., 0., nullptr };
+            node = move(orNode);
+        }
+        node.children.push_back(parseAnd(pos));
+    }
+    return node;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief parses conditions joined by "&&"
+ *
+ * @param pos position in m_text to start at; set to the position after the parsed part
+ * @return Node the compiled part
+ */
+GateCondition::Node GateCondition::parseAnd(size_t & pos) const
+{
+    Node node = parseUnary(pos);
+    while (consume(pos, "&&"))
+    {
+        if (node.operation != AND)
+        {
+            Node andNode{ AND, { move(node) }, {}, 0., 0., nullptr };
+            node = move(andNode);
+        }
+        node.children.push_back(parseUnary(pos));
+    }
+    return node;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief parses a negation, a bracketed condition, a function or a comparison
+ *
+ * @param pos position in m_text to start at; set to the position after the parsed part
+ * @return Node the compiled part
+ */
+GateCondition::Node GateCondition::parseUnary(size_t & pos) const
+{
+    skipSpaces(pos);
+    if (pos + 1 < m_text.size() && m_text.at(pos) == '!' && m_text.at(pos + 1) != '=')
+    {
+        ++pos;
+        return Node{ NOT, { parseUnary(pos) }, {}, 0., 0., nullptr };
+    }
+    else if (consume(pos, "("))
+    {
+        Node node = parseOr(pos);
+        if (!consume(pos, ")")) throw std::invalid_argument("Need closing bracket in " + m_text);
+        return node;
+    }
+    else if (m_text.compare(pos, 7, "PREFIX(") == 0)
+    {
+        return parseFunction(pos, PREFIX, 7);
+    }
+    else if (m_text.compare(pos, 6, "MATCH(") == 0)
+    {
+        return parseFunction(pos, MATCH, 6);
+    }
+    else if (m_text.compare(pos, 6, "RANGE(") == 0)
+    {
+        return parseFunction(pos, RANGE, 6);
+    }
+    return parseComparison(pos);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief parses the arguments of PREFIX(), MATCH() or RANGE() and checks, that they fit
+ *
+ * @param pos position of the function's name in m_text; set to the position after the ")"
+ * @param operation which function it is
+ * @param nameLength length of the name, including the "("
+ * @return Node the compiled function
+ */
+GateCondition::Node GateCondition::parseFunction(size_t & pos, Operation operation,
+                                                 size_t nameLength) const
+{
+    Node node{ operation, {}, {}, 0., 0., nullptr };
+    pos += nameLength;
+    do
+    {
+        node.operands.push_back(parseOperand(pos));
+    }
+    while (consume(pos, ","));
+    if (!consume(pos, ")")) throw std::invalid_argument("Need closing bracket in " + m_text);
+
+    size_t expectedCount = operation == RANGE ? 3 : 2;
+    if (node.operands.size() != expectedCount)
+    {
+        throw std::invalid_argument("Wrong number of arguments in " + m_text);
+    }
+    if (operation == MATCH)
+    {
+        const Operand & patternOperand = node.operands.at(1);
+        if (!patternOperand.isConstant || patternOperand.isNumber)
+        {
+            throw std::invalid_argument("MATCH needs a quoted regex in " + m_text);
+        }
+        node.pattern = make_shared<const regex>(get<string>(patternOperand.constant),
+                                                regex::optimize);
+        node.operands.pop_back();
+    }
+    else if (operation == RANGE)
+    {
+        if (!node.operands.at(1).isNumber || !node.operands.at(2).isNumber)
+        {
+            throw std::invalid_argument("RANGE needs numbers as bounds in " + m_text);
+        }
+        node.lowerBound = get<double>(node.operands.at(1).constant);
+        node.upperBound = get<double>(node.operands.at(2).constant);
+        node.operands.resize(1);
+    }
+    return node;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief parses a comparison of two operands, or a sole operand
+ *
+ * @param pos position in m_text to start at; set to the position after the parsed part
+ * @return Node the compiled comparison
+ */
+GateCondition::Node GateCondition::parseComparison(size_t & pos) const
+{
+    Node node{ TRUTHY, {}, { parseOperand(pos) }, 0., 0., nullptr };
+    // longer operators first, so that "<=" is not taken for "<"
+    if (consume(pos, "==")) node.operation = EQUAL;
+    else if (consume(pos, "!=")) node.operation = NOT_EQUAL;
+    else if (consume(pos, "<=")) node.operation = LESS_EQUAL;
+    else if (consume(pos, ">=")) node.operation = GREATER_EQUAL;
+    else if (consume(pos, "<")) node.operation = LESS;
+    else if (consume(pos, ">")) node.operation = GREATER;
+    if (node.operation != TRUTHY) node.operands.push_back(parseOperand(pos));
+    return node;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief parses an operand: a number or anything DataExpression understands. It ends at a space,
+ * an operator, a "," or a ")", that are not part of quotes or brackets.
+ *
+ * @param pos position in m_text to start at; set to the position after the operand
+ * @return Operand the compiled operand
+ */
+GateCondition::Operand GateCondition::parseOperand(size_t & pos) const
+{
+    skipSpaces(pos);
+    size_t start = pos;
+    size_t openBracketCount = 0;
+    bool inLiteral = false;
+    bool escaping = false;
+    for (; pos < m_text.size(); pos++)
+    {
+        char c = m_text.at(pos);
+        if (inLiteral)
+        {
+            if (escaping) escaping = false;
+            else if (c == '\\') escaping = true;
+            else if (c == '\"') inLiteral = false;
+        }
+        else if (c == '\"')
+        {
+            inLiteral = true;
+        }
+        else if (c == '(')
+        {
+            ++openBracketCount;
+        }
+        else if (c == ')' && openBracketCount > 0)
+        {
+            --openBracketCount;
+        }
+        else if (openBracketCount == 0 && string(" \t=!<>&|,)").find(c) != string::npos)
+        {
+            break;
+        }
+    }
+    if (pos == start) throw std::invalid_argument("Missing operand in " + m_text);
+
+    string text = m_text.substr(start, pos - start);
+    Operand operand{ nullptr, DataType(), false, false };
+    double number = 0.;
+    if (parseNumber(text, number))
+    {
+        operand.constant = number;
+        operand.isConstant = true;
+        operand.isNumber = true;
+    }
+    else
+    {
+        operand.expression = make_shared<const DataExpression>(text, m_sourceType);
+        if (operand.expression->getType() == DataExpression::LITERAL)
+        {
+            operand.constant = operand.expression->getLiteral();
+            operand.isConstant = true;
+        }
+    }
+    return operand;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief advances @p pos past spaces and tabs
+ *
+ * @param pos position in m_text
+ */
+void GateCondition::skipSpaces(size_t & pos) const
+{
+    while (pos < m_text.size() && (m_text.at(pos) == ' ' || m_text.at(pos) == '\t')) ++pos;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief advances @p pos past @p token , if it follows (after spaces)
+ *
+ * @param pos position in m_text
+ * @param token the expected text
+ * @return true if @p token was found and skipped
+ * @return false else (@p pos only skipped the spaces)
+ */
+bool GateCondition::consume(size_t & pos, const string & token) const
+{
+    skipSpaces(pos);
+    if (m_text.compare(pos, token.size(), token) != 0) return false;
+    pos += token.size();
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief evaluates one node of the compiled condition. AND and OR stop at the first child, that
+ * decides the result.
+ *
+ * @param node the node to evaluate
+ * @param datagram the Datagram to read values from
+ * @return bool result of the node
+ */
+bool GateCondition::evaluateNode(const Node & node, const Datagram & datagram) const
+{
+    switch (node.operation)
+    {
+    case AND:
+        for (const Node & child : node.children)
+        {
+            if (!evaluateNode(child, datagram)) return false;
+        }
+        return true;
+    case OR:
+        for (const Node & child : node.children)
+        {
+            if (evaluateNode(child, datagram)) return true;
+        }
+        return false;
+    case NOT:
+        return !evaluateNode(node.children.front(), datagram);
+    case PREFIX:
+    {
+        DataType textValue, prefixValue;
+        string textStorage, prefixStorage;
+        const string & text = toText(getValue(node.operands.at(0), datagram, textValue),
+                                     textStorage);
+        const string & prefix = toText(getValue(node.operands.at(1), datagram, prefixValue),
+                                       prefixStorage);
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+    case MATCH:
+    {
+        DataType value;
+        string storage;
+        const string & text = toText(getValue(node.operands.front(), datagram, value), storage);
+        return regex_search(text, *node.pattern);
+    }
+    case RANGE:
+    {
+        DataType value;
+        double number = 0.;
+        if (!toNumber(getValue(node.operands.front(), datagram, value), number)) return false;
+        return number >= node.lowerBound && number <= node.upperBound;
+    }
+    case TRUTHY:
+    {
+        DataType value;
+        return convertDataTypeToBoolean(getValue(node.operands.front(), datagram, value));
+    }
+    default:
+        return compare(node, datagram);
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief evaluates a comparison, numerically if possible (see class description)
+ *
+ * @param node the comparing node
+ * @param datagram the Datagram to read values from
+ * @return bool result of the comparison
+ */
+bool GateCondition::compare(const Node & node, const Datagram & datagram) const
+{
+    const Operand & leftOperand = node.operands.at(0);
+    const Operand & rightOperand = node.operands.at(1);
+    DataType leftStorage, rightStorage;
+    const DataType & left = getValue(leftOperand, datagram, leftStorage);
+    const DataType & right = getValue(rightOperand, datagram, rightStorage);
+    int result = 0;
+    if (leftOperand.isNumber || rightOperand.isNumber
+        || (left.index() <= plagn::DOUBLE && right.index() <= plagn::DOUBLE))
+    {
+        double leftNumber = 0.;
+        double rightNumber = 0.;
+        if (!toNumber(left, leftNumber) || !toNumber(right, rightNumber)) return false;
+        result = leftNumber < rightNumber ? -1 : (leftNumber > rightNumber ? 1 : 0);
+    }
+    else
+    {
+        string leftText, rightText;
+        result = toText(left, leftText).compare(toText(right, rightText));
+    }
+    switch (node.operation)
+    {
+    case EQUAL:
+        return result == 0;
+    case NOT_EQUAL:
+        return result != 0;
+    case LESS:
+        return result < 0;
+    case LESS_EQUAL:
+        return result <= 0;
+    case GREATER:
+        return result > 0;
+    case GREATER_EQUAL:
+        return result >= 0;
+    default:
+        return false;
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief reads the value of @p operand . Constants are not copied.
+ *
+ * @param operand the operand
+ * @param datagram the Datagram to read from
+ * @param storage keeps the value, if it is read from @p datagram
+ * @return const DataType & the value (a double for numbers)
+ */
+const DataType & GateCondition::getValue(const Operand & operand, const Datagram & datagram,
+                                         DataType & storage)
+{
+    if (operand.isConstant) return operand.constant;
+    storage = operand.expression->evaluate(datagram);
+    return storage;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief gives the string representation of @p value , without a copy, if it is a string
+ *
+ * @param value any value
+ * @param storage keeps the converted value, if @p value is no string
+ * @return const string & the string representation
+ */
+const string & GateCondition::toText(const DataType & value, string & storage)
+{
+    const string * text = get_if<string>(&value);
+    if (text) return *text;
+    storage = convertDataTypeToString(value);
+    return storage;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief converts @p value to a number, without throwing for values, that are none
+ *
+ * @param value any value
+ * @param number set to the numeric value of @p value
+ * @return true if @p value is or holds a number
+ * @return false else
+ */
+bool GateCondition::toNumber(const DataType & value, double & number)
+{
+    if (value.index() <= plagn::DOUBLE)
+    {
+        number = convertDataTypeToDouble(value);
+        return true;
+    }
+    const string * text = get_if<string>(&value);
+    return text != nullptr && parseNumber(*text, number);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief parses @p text as a number, if it is nothing else but a number
+ *
+ * @param text text to parse
+ * @param number set to the parsed number
+ * @return true if all of @p text is a number
+ * @return false else
+ */
+bool GateCondition::parseNumber(const string & text, double & number)
+{
+    if (text.empty()) return false;
+    char first = text.front();
+    if (!isDigit(first) && first != '-' && first != '+' && first != '.') return false;
+    char * end = nullptr;
+    number = strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
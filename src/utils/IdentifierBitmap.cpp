@@ -0,0 +1,122 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file IdentifierBitmap.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Implements the IdentifierBitmap class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <bit>
+#include <stdexcept>
+
+// self include
+#include "IdentifierBitmap.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new IdentifierBitmap:: IdentifierBitmap object, with all identifiers free
+ *
+ */
+IdentifierBitmap::IdentifierBitmap() :
+    m_words{}
+{
+    // 0 is no valid identifier, so it is never handed out
+    m_words[0] = 1;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief looks for the next free identifier after @p identifier, wrapping around after 65535
+ *
+ * @param identifier where to start looking (exclusive), i.e. the last one handed out
+ * @return uint16_t a value between 1 and 65535, that is currently free
+ *
+ * @throws std::runtime_error if all identifiers are in use
+ */
+uint16_t IdentifierBitmap::findFreeAfter(uint16_t identifier) const
+{
+    uint16_t start = identifier + 1;
+    size_t word = start >> 6;
+    // at the first word only the bits from start on count; the last round revisits the bits before
+    uint64_t freeBits = ~m_words[word] & (~uint64_t(0) << (start & 63));
+    for (size_t round = 0; freeBits == 0 && round < m_words.size(); round++)
+    {
+        word = (word + 1) % m_words.size();
+        freeBits = ~m_words[word];
+    }
+    if (freeBits == 0) throw std::runtime_error("All packet identifiers are in use!");
+
+    return static_cast<uint16_t>((word << 6) + std::countr_zero(freeBits));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief marks @p identifier as used, so that findFreeAfter() skips it
+ *
+ * @param identifier the identifier to mark
+ */
+void IdentifierBitmap::markUsed(uint16_t identifier)
+{
+    m_words[identifier >> 6] |= uint64_t(1) << (identifier & 63);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief marks @p identifier as free again. The 0 stays used.
+ *
+ * @param identifier the identifier to free
+ */
+void IdentifierBitmap::markFree(uint16_t identifier)
+{
+    if (identifier == 0) return;
+    m_words[identifier >> 6] &= ~(uint64_t(1) << (identifier & 63));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks, whether @p identifier is used
+ *
+ * @param identifier the identifier to check
+ * @return true if @p identifier was marked as used (never for 0)
+ */
+bool IdentifierBitmap::isUsed(uint16_t identifier) const
+{
+    return identifier != 0 && ((m_words[identifier >> 6] >> (identifier & 63)) & 1) != 0;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief appends all used identifiers in ascending order
+ *
+ * @param identifiers the identifiers are appended here
+ */
+void IdentifierBitmap::collectUsed(vector<uint64_t> & identifiers) const
+{
+    for (size_t word = 0; word < m_words.size(); word++)
+    {
+        uint64_t usedBits = m_words[word];
+        // 0 is never used, but marked as such
+        if (word == 0) usedBits &= ~uint64_t(1);
+        while (usedBits != 0)
+        {
+            identifiers.push_back((word << 6) + std::countr_zero(usedBits));
+            usedBits &= usedBits - 1;
+        }
+    }
+}
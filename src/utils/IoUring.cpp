@@ -0,0 +1,500 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file IoUring.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Implements the IoUring class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// self include
+#include "IoUring.hpp"
+
+#ifdef IORING_RECV_MULTISHOT
+
+// std includes
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new IoUring:: IoUring object sets up an io_uring with at least @p entries
+ * submission queue entries and four times as many completion queue entries, as multishot
+ * receives complete more often than they are submitted
+ *
+ * @param entries number of operations, that can be prepared before submit()
+ *
+ * @throws std::system_error if the kernel does not set up the io_uring
+ */
+IoUring::IoUring(unsigned int entries) :
+    m_ringFd(-1),
+    m_eventFd(-1),
+    m_sqRing(MAP_FAILED),
+    m_sqRingSize(0),
+    m_cqRing(MAP_FAILED),
+    m_cqRingSize(0),
+    m_sqes(static_cast<io_uring_sqe *>(MAP_FAILED)),
+    m_sqesSize(0),
+    m_sqPrepared(0),
+    m_bufferRing(static_cast<io_uring_buf *>(MAP_FAILED)),
+    m_bufferRingSize(0),
+    m_bufferCount(0),
+    m_bufferTail(0),
+    m_bufferSize(0)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = max(entries, 1U) * 4;
+    m_ringFd = static_cast<int>(syscall(__NR_io_uring_setup, max(entries, 1U), &params));
+    if (m_ringFd < 0) throw system_error(errno, generic_category(), "io_uring_setup");
+
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        m_sqRingSize = max(m_sqRingSize, m_cqRingSize);
+        m_cqRingSize = m_sqRingSize;
+    }
+    m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    m_ringFd, IORING_OFF_SQ_RING);
+    if (m_sqRing == MAP_FAILED)
+    {
+        int error = errno;
+        release();
+        throw system_error(error, generic_category(), "mmap of io_uring");
+    }
+    m_cqRing = m_sqRing;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ringFd, IORING_OFF_CQ_RING);
+    }
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    m_sqes = static_cast<io_uring_sqe *>(mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_POPULATE, m_ringFd,
+                                              IORING_OFF_SQES));
+    if (m_cqRing == MAP_FAILED || m_sqes == MAP_FAILED)
+    {
+        int error = errno;
+        release();
+        throw system_error(error, generic_category(), "mmap of io_uring");
+    }
+
+    char * sqRing = static_cast<char *>(m_sqRing);
+    m_sqHead = reinterpret_cast<unsigned int *>(sqRing + params.sq_off.head);
+    m_sqTail = reinterpret_cast<unsigned int *>(sqRing + params.sq_off.tail);
+    m_sqFlags = reinterpret_cast<unsigned int *>(sqRing + params.sq_off.flags);
+    m_sqArray = reinterpret_cast<unsigned int *>(sqRing + params.sq_off.array);
+    m_sqMask = *reinterpret_cast<unsigned int *>(sqRing + params.sq_off.ring_mask);
+    m_sqEntries = params.sq_entries;
+    m_sqPrepared = *m_sqTail;
+    char * cqRing = static_cast<char *>(m_cqRing);
+    m_cqHead = reinterpret_cast<unsigned int *>(cqRing + params.cq_off.head);
+    m_cqTail = reinterpret_cast<unsigned int *>(cqRing + params.cq_off.tail);
+    m_cqMask = *reinterpret_cast<unsigned int *>(cqRing + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe *>(cqRing + params.cq_off.cqes);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Destroy the IoUring:: IoUring object. Closing the io_uring cancels its pending
+ * operations, e.g. multishot receives, which keep their sockets open until then.
+ *
+ */
+IoUring::~IoUring()
+{
+    release();
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief closes the io_uring and unmaps its memory, as far as it was set up
+ *
+ */
+void IoUring::release()
+{
+    if (m_ringFd >= 0) close(m_ringFd);
+    m_ringFd = -1;
+    if (m_eventFd >= 0) close(m_eventFd);
+    m_eventFd = -1;
+    if (m_bufferRing != MAP_FAILED) munmap(m_bufferRing, m_bufferRingSize);
+    m_bufferRing = static_cast<io_uring_buf *>(MAP_FAILED);
+    if (m_sqes != MAP_FAILED) munmap(m_sqes, m_sqesSize);
+    m_sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing) munmap(m_cqRing, m_cqRingSize);
+    m_cqRing = MAP_FAILED;
+    if (m_sqRing != MAP_FAILED) munmap(m_sqRing, m_sqRingSize);
+    m_sqRing = MAP_FAILED;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief tells, if this system runs io_uring with all, that is used here. Checked once.
+ * @details The kernel is asked for the operations it supports. As multishot receives cannot be
+ * asked for, IORING_OP_SEND_ZC, which came with the same kernel (6.0), stands in for them.
+ *
+ * @return true if io_uring can be used
+ * @return false if io_uring is unavailable (e.g. disabled, old kernel, denied by a sandbox)
+ */
+bool IoUring::isSupported()
+{
+    static const bool supported = []()
+    {
+        try
+        {
+            IoUring ring(2);
+            size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+            unique_ptr<char[]> probeMemory(new char[probeSize]());
+            io_uring_probe * probe = reinterpret_cast<io_uring_probe *>(probeMemory.get());
+            if (syscall(__NR_io_uring_register, ring.m_ringFd, IORING_REGISTER_PROBE, probe,
+                        256) < 0)
+            {
+                return false;
+            }
+            for (uint8_t opcode : {IORING_OP_RECV, IORING_OP_SEND, IORING_OP_RECVMSG,
+                                   IORING_OP_SENDMSG, IORING_OP_SEND_ZC})
+            {
+                if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED))
+                {
+                    return false;
+                }
+            }
+            ring.registerBuffers(1, 64);
+            return true;
+        }
+        catch (exception & /*unused*/)
+        {
+            return false;
+        }
+    }();
+    return supported;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief allocates @p count buffers of @p size bytes and registers them with the kernel as ring
+ * BUFFER_GROUP, that the receives of this take their buffers from
+ *
+ * @param count number of buffers (rounded up to a power of two, at most 32768)
+ * @param size size of each buffer in bytes
+ *
+ * @throws std::system_error if the kernel does not take the buffers
+ */
+void IoUring::registerBuffers(unsigned int count, size_t size)
+{
+    m_bufferCount = 1;
+    while (m_bufferCount < count && m_bufferCount < 32768) m_bufferCount <<= 1;
+    m_bufferSize = size;
+    m_buffers.assign(m_bufferCount * m_bufferSize, 0);
+    m_bufferRingSize = m_bufferCount * sizeof(io_uring_buf);
+    // the kernel wants the ring page aligned
+    m_bufferRing = static_cast<io_uring_buf *>(mmap(nullptr, m_bufferRingSize,
+                                                    PROT_READ | PROT_WRITE,
+                                                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (m_bufferRing == MAP_FAILED) throw system_error(errno, generic_category(), "mmap");
+
+    io_uring_buf_reg registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uint64_t>(m_bufferRing);
+    registration.ring_entries = m_bufferCount;
+    registration.bgid = BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+        throw system_error(errno, generic_category(), "io_uring_register of buffers");
+    }
+    m_bufferTail = 0;
+    for (unsigned int i = 0; i < m_bufferCount; i++)
+    {
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @param bufferId id of the buffer, as given by a completion
+ * @return char * start of the buffer
+ */
+char * IoUring::getBuffer(uint16_t bufferId)
+{
+    return &m_buffers[bufferId * m_bufferSize];
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief hands the buffer @p bufferId back to the kernel, to receive into again
+ *
+ * @param bufferId id of the buffer, as given by a completion
+ */
+void IoUring::recycleBuffer(uint16_t bufferId)
+{
+    io_uring_buf & entry = m_bufferRing[m_bufferTail & (m_bufferCount - 1)];
+    entry.addr = reinterpret_cast<uint64_t>(getBuffer(bufferId));
+    entry.len = static_cast<uint32_t>(m_bufferSize);
+    entry.bid = bufferId;
+    m_bufferTail++;
+    // the tail overlays the reserved field of the first entry
+    std::atomic_ref<uint16_t>(m_bufferRing[0].resv).store(m_bufferTail, memory_order_release);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief lets the kernel signal completions on an eventfd
+ *
+ * @return int a duplicate of the eventfd, owned by the caller (e.g. by a
+ * boost::asio::posix::stream_descriptor); after it became readable, call clearEventFd()
+ *
+ * @throws std::system_error if the eventfd cannot be set up
+ */
+int IoUring::openEventFd()
+{
+    if (m_eventFd < 0)
+    {
+        m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_eventFd < 0) throw system_error(errno, generic_category(), "eventfd");
+        if (syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_EVENTFD, &m_eventFd, 1) < 0)
+        {
+            throw system_error(errno, generic_category(), "io_uring_register of eventfd");
+        }
+    }
+    int duplicate = dup(m_eventFd);
+    if (duplicate < 0) throw system_error(errno, generic_category(), "dup");
+    return duplicate;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief resets the eventfd, so that it becomes readable again with the next completion only
+ *
+ */
+void IoUring::clearEventFd()
+{
+    uint64_t signals = 0;
+    if (m_eventFd >= 0 && read(m_eventFd, &signals, sizeof(signals)) < 0)
+    {
+        // EAGAIN: nothing signaled since the last call
+        signals = 0;
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief prepares a multishot recvmsg on @p fd , that receives every message into its own
+ * registered buffer, laid out as described by @p header (see parseMessage())
+ *
+ * @param fd socket to receive on
+ * @param header room for the name and ancillary data (msg_namelen, msg_controllen); must stay
+ * valid while receiving
+ * @param userData handed to the completions
+ * @return true if prepared
+ * @return false if the submission queue is full
+ */
+bool IoUring::prepareReceiveMessages(int fd, msghdr * header, uint64_t userData)
+{
+    io_uring_sqe * entry = nextSqe(IORING_OP_RECVMSG, fd);
+    if (entry == nullptr) return false;
+    entry->addr = reinterpret_cast<uint64_t>(header);
+    entry->len = 1;
+    entry->ioprio = IORING_RECV_MULTISHOT;
+    entry->flags = IOSQE_BUFFER_SELECT;
+    entry->buf_group = BUFFER_GROUP;
+    entry->user_data = userData;
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief prepares a multishot recv on the stream socket @p fd , that receives into registered
+ * buffers, until the connection ends
+ *
+ * @param fd socket to receive on
+ * @param userData handed to the completions
+ * @return true if prepared
+ * @return false if the submission queue is full
+ */
+bool IoUring::prepareReceive(int fd, uint64_t userData)
+{
+    io_uring_sqe * entry = nextSqe(IORING_OP_RECV, fd);
+    if (entry == nullptr) return false;
+    entry->ioprio = IORING_RECV_MULTISHOT;
+    entry->flags = IOSQE_BUFFER_SELECT;
+    entry->buf_group = BUFFER_GROUP;
+    entry->user_data = userData;
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief prepares a sendmsg of @p header on @p fd
+ *
+ * @param fd socket to send on
+ * @param header the message; it and what it points to must stay valid until its completion
+ * @param userData handed to the completion
+ * @return true if prepared
+ * @return false if the submission queue is full
+ */
+bool IoUring::prepareSendMessage(int fd, const msghdr * header, uint64_t userData)
+{
+    io_uring_sqe * entry = nextSqe(IORING_OP_SENDMSG, fd);
+    if (entry == nullptr) return false;
+    entry->addr = reinterpret_cast<uint64_t>(header);
+    entry->len = 1;
+    entry->user_data = userData;
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief prepares a send of @p length bytes at @p data on the connected socket @p fd
+ *
+ * @param fd socket to send on
+ * @param data the data; must stay valid until its completion
+ * @param length number of bytes to send
+ * @param userData handed to the completion
+ * @return true if prepared
+ * @return false if the submission queue is full
+ */
+bool IoUring::prepareSend(int fd, const void * data, size_t length, uint64_t userData)
+{
+    io_uring_sqe * entry = nextSqe(IORING_OP_SEND, fd);
+    if (entry == nullptr) return false;
+    entry->addr = reinterpret_cast<uint64_t>(data);
+    entry->len = static_cast<uint32_t>(length);
+    entry->msg_flags = MSG_NOSIGNAL;
+    entry->user_data = userData;
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief hands all prepared operations to the kernel with one system call
+ *
+ * @param waitFor number of completions to wait for (0: do not wait)
+ * @return unsigned int number of operations submitted
+ *
+ * @throws std::system_error if the kernel refuses the submission
+ */
+unsigned int IoUring::submit(unsigned int waitFor)
+{
+    unsigned int toSubmit = m_sqPrepared - *m_sqTail;
+    std::atomic_ref<unsigned int>(*m_sqTail).store(m_sqPrepared, memory_order_release);
+    if (toSubmit == 0 && waitFor == 0) return 0;
+    int submitted = enter(toSubmit, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0);
+    if (submitted < 0) throw system_error(-submitted, generic_category(), "io_uring_enter");
+    return static_cast<unsigned int>(submitted);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief finds the parts of a message, that a multishot recvmsg received into @p buffer
+ *
+ * @param buffer the registered buffer
+ * @param length number of bytes received into it (the result of the completion)
+ * @param header the header handed to prepareReceiveMessages()
+ * @param message is set to the parts of the message
+ * @return true if the buffer holds a message
+ * @return false if it is too short
+ */
+bool IoUring::parseMessage(char * buffer, size_t length, const msghdr & header,
+                           ReceivedMessage & message)
+{
+    size_t payloadOffset = sizeof(io_uring_recvmsg_out) + header.msg_namelen
+                           + header.msg_controllen;
+    if (length < payloadOffset) return false;
+    io_uring_recvmsg_out out;
+    memcpy(&out, buffer, sizeof(out));
+    message.name = buffer + sizeof(io_uring_recvmsg_out);
+    message.nameLength = min<size_t>(out.namelen, header.msg_namelen);
+    message.control = buffer + sizeof(io_uring_recvmsg_out) + header.msg_namelen;
+    message.controlLength = min<size_t>(out.controllen, header.msg_controllen);
+    message.payload = buffer + payloadOffset;
+    message.payloadLength = length - payloadOffset;
+    message.truncated = out.payloadlen > message.payloadLength || (out.flags & MSG_TRUNC);
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief takes the next free submission queue entry and clears it
+ *
+ * @param opcode operation of the entry
+ * @param fd file descriptor the operation works on
+ * @return io_uring_sqe * the entry, or nullptr if the submission queue is full
+ */
+io_uring_sqe * IoUring::nextSqe(uint8_t opcode, int fd)
+{
+    unsigned int head = std::atomic_ref<unsigned int>(*m_sqHead).load(memory_order_acquire);
+    if (m_sqPrepared - head >= m_sqEntries) return nullptr;
+    unsigned int index = m_sqPrepared & m_sqMask;
+    io_uring_sqe * entry = &m_sqes[index];
+    memset(entry, 0, sizeof(*entry));
+    entry->opcode = opcode;
+    entry->fd = fd;
+    m_sqArray[index] = index;
+    m_sqPrepared++;
+    return entry;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief moves completions, the kernel kept aside, as the completion queue was full, into the
+ * queue
+ *
+ * @return true if there were any
+ * @return false otherwise
+ */
+bool IoUring::flushOverflow()
+{
+    if (!(std::atomic_ref<unsigned int>(*m_sqFlags).load(memory_order_relaxed)
+          & IORING_SQ_CQ_OVERFLOW))
+    {
+        return false;
+    }
+    enter(0, 0, IORING_ENTER_GETEVENTS);
+    return true;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief calls io_uring_enter, repeating it if interrupted
+ *
+ * @param toSubmit number of entries to submit
+ * @param waitFor number of completions to wait for
+ * @param flags flags of io_uring_enter
+ * @return int the result of io_uring_enter, or -errno
+ */
+int IoUring::enter(unsigned int toSubmit, unsigned int waitFor, unsigned int flags)
+{
+    long result = 0;
+    do
+    {
+        result = syscall(__NR_io_uring_enter, m_ringFd, toSubmit, waitFor, flags, nullptr, 0);
+    }
+    while (result < 0 && errno == EINTR);
+    return result < 0 ? -errno : static_cast<int>(result);
+}
+
+#endif // IORING_RECV_MULTISHOT
@@ -0,0 +1,99 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file LatencyMetric.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Implements the LatencyMetric class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// self include
+#include "LatencyMetric.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new LatencyMetric:: LatencyMetric object, that has nothing recorded yet
+ *
+ */
+LatencyMetric::LatencyMetric() :
+    m_count(0),
+    m_totalLatency(0),
+    m_maxLatency(0)
+{
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief adds @p latency to the metric. Negative latencies (clocks of different sources) count
+ * as 0.
+ *
+ * @param latency the latency of one Datagram
+ */
+void LatencyMetric::record(chrono::steady_clock::duration latency)
+{
+    int64_t micros = chrono::duration_cast<chrono::microseconds>(latency).count();
+    uint64_t value = micros > 0 ? static_cast<uint64_t>(micros) : 0;
+    m_count.fetch_add(1, memory_order_relaxed);
+    m_totalLatency.fetch_add(value, memory_order_relaxed);
+    uint64_t known = m_maxLatency.load(memory_order_relaxed);
+    while (value > known && !m_maxLatency.compare_exchange_weak(known, value, memory_order_relaxed));
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return uint64_t number of recorded latencies
+ */
+uint64_t LatencyMetric::getCount() const
+{
+    return m_count.load(memory_order_relaxed);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief average of the recorded latencies
+ *
+ * @return uint64_t average latency in µs (0, if nothing was recorded)
+ */
+uint64_t LatencyMetric::getAverage() const
+{
+    uint64_t count = getCount();
+    return count > 0 ? m_totalLatency.load(memory_order_relaxed) / count : 0;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return uint64_t highest recorded latency in µs
+ */
+uint64_t LatencyMetric::getMaximum() const
+{
+    return m_maxLatency.load(memory_order_relaxed);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief summary of the metric, e.g. "avg 12 us, max 80 us"
+ *
+ * @return std::string human readable summary
+ */
+string LatencyMetric::toString() const
+{
+    return "avg " + to_string(getAverage()) + " us, max " + to_string(getMaximum()) + " us";
+}
@@ -27,8 +27,15 @@
  * @brief Construct a new Plag Interface:: Plag Interface object
  * 
  * @param type type of Plag
+ * @param queueCapacity number of Datagrams each of the queues can hold
  */
-PlagInterface::PlagInterface(PlagType type) :
+PlagInterface::PlagInterface(PlagType type, size_t queueCapacity) :
+    m_outgoingDatagrams(queueCapacity),
+    m_incommingDatagrams(queueCapacity),
+    m_droppedDatagrams(0),
+    m_evictedDatagrams(0),
+    m_coalescedDatagrams(0),
+    m_blockedPushes(0),
     m_type(type)
 {
 }
@@ -43,3 +50,34 @@ PlagType PlagInterface::getType() const
 {
     return m_type;
 }
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief places several Datagrams at once, in order. Plags may override this, if they can take a
+ * batch cheaper than one by one.
+ *
+ * @param datagrams Datagrams for this Plag to interprete
+ */
+void PlagInterface::placeDatagrams(const std::vector<std::shared_ptr<Datagram>> & datagrams)
+{
+    for (const std::shared_ptr<Datagram> & datagram : datagrams)
+    {
+        placeDatagram(datagram);
+    }
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief tells a producing Plag, how many Datagrams may be placed here right now. Plags applying
+ * backpressure override this, to hold back @p producer until there is room and to notify() it
+ * then.
+ *
+ * @param count number of Datagrams the producer is about to place
+ * @param producer the Plag, that would place them
+ * @return size_t @p count by default, as the Datagrams are taken (or dropped) anyway
+ */
+size_t PlagInterface::getRoomFor(size_t count, const std::weak_ptr<PlagInterface> & producer)
+{
+    (void) producer;
+    return count;
+}
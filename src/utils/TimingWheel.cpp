@@ -0,0 +1,204 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file TimingWheel.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Implements the TimingWheel class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <algorithm>
+#include <stdexcept>
+
+// self include
+#include "TimingWheel.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief Construct a new TimingWheel:: TimingWheel object, that is empty
+ *
+ * @param tickDuration time covered by one slot (at least 1 ms). Keys are handed out by expire()
+ * up to this late.
+ * @param slotCount number of slots (at least 1); one turn of the wheel is @p slotCount ticks
+ * @param keyCount keys have to be lower than this
+ */
+TimingWheel::TimingWheel(chrono::milliseconds tickDuration, size_t slotCount, size_t keyCount) :
+    m_tickDuration(max(tickDuration, chrono::milliseconds(1))),
+    m_slots(min<size_t>(max<size_t>(slotCount, 1), NOT_SCHEDULED)),
+    m_positions(keyCount, Position{ NOT_SCHEDULED, 0 }),
+    m_origin(chrono::steady_clock::now()),
+    m_currentTick(0),
+    m_size(0)
+{
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief schedules @p key to be handed out by expire(), once @p deadline passed. An earlier
+ * deadline of @p key is replaced.
+ *
+ * @param key what to hand out (lower than the keyCount of the wheel)
+ * @param deadline when to hand it out (deadlines of ticks, that passed, are handed out by the
+ * next expire() after the current tick)
+ */
+void TimingWheel::schedule(uint64_t key, chrono::steady_clock::time_point deadline)
+{
+    if (key >= m_positions.size()) throw std::out_of_range("Key exceeds the keys of TimingWheel!");
+    cancel(key);
+    uint64_t ticksAhead = max(getTick(deadline), m_currentTick) - m_currentTick;
+    uint64_t slotIndex = (m_currentTick + ticksAhead) % m_slots.size();
+    vector<Entry> & slot = m_slots[slotIndex];
+    m_positions[key] = Position{ static_cast<uint32_t>(slotIndex),
+                                 static_cast<uint32_t>(slot.size()) };
+    slot.push_back(Entry{ key, ticksAhead / m_slots.size() });
+    ++m_size;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief removes @p key, so that it is not handed out. Does nothing, if it is not scheduled.
+ *
+ * @param key the key to remove
+ */
+void TimingWheel::cancel(uint64_t key)
+{
+    if (!isScheduled(key)) return;
+    Position position = m_positions[key];
+    removeEntry(m_slots[position.slot], position.index);
+    --m_size;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks, whether @p key waits to be handed out
+ *
+ * @param key the key to check
+ * @return true if @p key is scheduled
+ */
+bool TimingWheel::isScheduled(uint64_t key) const
+{
+    return key < m_positions.size() && m_positions[key].slot != NOT_SCHEDULED;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief hands out all keys, whose tick passed until @p now, and removes them
+ *
+ * @details Each slot is visited once per call, even if more than one turn of the wheel passed: the
+ * number of times a tick of the slot passed is subtracted from the rounds of its entries at once.
+ *
+ * @param now the current time
+ * @param expired the expired keys are appended here
+ * @return size_t number of keys appended to @p expired
+ */
+size_t TimingWheel::expire(chrono::steady_clock::time_point now, vector<uint64_t> & expired)
+{
+    uint64_t nowTick = getTick(now);
+    if (nowTick <= m_currentTick) return 0;
+    if (m_size == 0)
+    {
+        m_currentTick = nowTick;
+        return 0;
+    }
+    size_t expiredCount = 0;
+    uint64_t endTick = min<uint64_t>(nowTick, m_currentTick + m_slots.size());
+    for (uint64_t tick = m_currentTick; tick < endTick; tick++)
+    {
+        vector<Entry> & slot = m_slots[tick % m_slots.size()];
+        uint64_t passes = (nowTick - 1 - tick) / m_slots.size() + 1;
+        size_t i = 0;
+        while (i < slot.size())
+        {
+            if (slot[i].rounds < passes)
+            {
+                expired.push_back(slot[i].key);
+                ++expiredCount;
+                // order within a slot does not matter: removing moves the last one here
+                removeEntry(slot, i);
+            }
+            else
+            {
+                slot[i].rounds -= passes;
+                ++i;
+            }
+        }
+    }
+    m_currentTick = nowTick;
+    m_size -= expiredCount;
+    return expiredCount;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief removes all scheduled keys
+ *
+ */
+void TimingWheel::clear()
+{
+    for (vector<Entry> & slot : m_slots)
+    {
+        for (const Entry & entry : slot)
+        {
+            m_positions[entry.key].slot = NOT_SCHEDULED;
+        }
+        slot.clear();
+    }
+    m_size = 0;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief simple getter
+ *
+ * @return size_t number of scheduled keys
+ */
+size_t TimingWheel::size() const
+{
+    return m_size;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief computes the tick @p timePoint is in
+ *
+ * @param timePoint the point in time
+ * @return uint64_t number of ticks since m_origin (0 for time points before it)
+ */
+uint64_t TimingWheel::getTick(chrono::steady_clock::time_point timePoint) const
+{
+    if (timePoint <= m_origin) return 0;
+    return static_cast<uint64_t>((timePoint - m_origin) / m_tickDuration);
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief removes the entry at @p index of @p slot by moving the last entry of @p slot there
+ *
+ * @param slot the slot holding the entry
+ * @param index index of the entry in @p slot
+ */
+void TimingWheel::removeEntry(vector<Entry> & slot, size_t index)
+{
+    m_positions[slot[index].key].slot = NOT_SCHEDULED;
+    if (index + 1 < slot.size())
+    {
+        slot[index] = slot.back();
+        m_positions[slot[index].key].index = static_cast<uint32_t>(index);
+    }
+    slot.pop_back();
+}
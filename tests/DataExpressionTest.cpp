@@ -0,0 +1,99 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file DataExpressionTest.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Tests the DataExpression class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// own includes
+#include "DataExpression.hpp"
+#include "DatagramUdp.hpp"
+#include "Tests.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks, that a compiled SPLIT yields what Datagram::getData() yields for its text, with
+ * and without knowing the type of the source Plag
+ *
+ * @param expression text of the SPLIT
+ * @param datagram the Datagram to evaluate it for
+ * @param expected expected value
+ * @return true if all three are equal
+ */
+static bool splitsTo(const string & expression, const Datagram & datagram,
+                     const DataType & expected)
+{
+    DataType byName = datagram.getData(expression);
+    return byName == expected && DataExpression(expression).evaluate(datagram) == byName
+           && DataExpression(expression, PlagType::UDP).evaluate(datagram) == byName;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks literals, keys and SPLIT(...) against the results of parsing by name in
+ * Datagram::getData(), including nested SPLITs, several separators and invalid indices
+ *
+ */
+void testDataExpression()
+{
+    DatagramUdp datagram("udp1", "10.0.0.1", 4004, "sensors/a;42;hello/world");
+
+    DataExpression literal("\"text\"");
+    CHECK(literal.getType() == DataExpression::LITERAL);
+    CHECK(convertDataTypeToString(literal.evaluate(datagram)) == "text");
+    CHECK(convertDataTypeToString(DataExpression("42").evaluate(datagram)) == "42");
+    DataExpression key("payload", PlagType::UDP);
+    CHECK(key.getType() == DataExpression::KEY);
+    CHECK(key.evaluate(datagram) == datagram.getData("payload"));
+    CHECK(DataExpression("sourcePlag").evaluate(datagram) == datagram.getData("sourcePlag"));
+
+    CHECK(DataExpression("SPLIT(payload,;)").getType() == DataExpression::SPLIT);
+    CHECK(splitsTo("SPLIT(payload,;)", datagram,
+                   vector<string>{ "sensors/a", "42", "hello/world" }));
+    CHECK(splitsTo("SPLIT(payload,;).1", datagram, string("sensors/a")));
+    CHECK(splitsTo("SPLIT(payload,;).3", datagram, string("hello/world")));
+    CHECK(splitsTo("SPLIT(payload,;/).4", datagram, string("hello")));
+    CHECK(splitsTo("SPLIT(SPLIT(payload,;).3,/).2", datagram, string("world")));
+    CHECK(splitsTo("SPLIT(\"a-b-c\",-).2", datagram, string("b")));
+    CHECK(splitsTo("SPLIT(sender,.).4", datagram, string("1")));
+
+    // an index beyond the parts fails either way
+    bool byNameThrew = false;
+    try { datagram.getData("SPLIT(payload,;).4"); }
+    catch (std::exception &) { byNameThrew = true; }
+    bool compiledThrew = false;
+    try { DataExpression("SPLIT(payload,;).4").evaluate(datagram); }
+    catch (std::exception &) { compiledThrew = true; }
+    CHECK(byNameThrew && compiledThrew);
+
+    // malformed SPLITs are rejected, when compiled
+    const char * malformed[] = { "SPLIT(payload;)", "SPLIT(payload,;" };
+    for (const char * expression : malformed)
+    {
+        bool threw = false;
+        try { DataExpression compiled(expression); }
+        catch (std::invalid_argument &) { threw = true; }
+        checkCondition(threw, expression, __FILE__, __LINE__);
+    }
+}
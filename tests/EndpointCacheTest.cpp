@@ -0,0 +1,90 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file EndpointCacheTest.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Tests the EndpointCache class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// boost includes
+#include <boost/asio.hpp>
+
+// own includes
+#include "EndpointCache.hpp"
+#include "Tests.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks, that lookups are answered from the cache and that the least recently used entry
+ * is evicted, once the capacity is reached. Then, that hostnames are resolved in the background,
+ * and that one, that cannot be resolved, is kept as such.
+ *
+ */
+void testEndpointCache()
+{
+    boost::asio::io_context ioContext;
+    boost::asio::strand<boost::asio::io_context::executor_type> strand
+        = boost::asio::make_strand(ioContext);
+    size_t resolves = 0;
+    EndpointCache cache(strand, 2, chrono::seconds(60), chrono::seconds(60),
+                        [&resolves]() { resolves++; });
+    boost::asio::ip::udp::endpoint endpoint;
+
+    CHECK(cache.lookUp("127.0.0.1", 5000, endpoint) == EndpointCache::RESOLVED);
+    CHECK(endpoint.address().to_string() == "127.0.0.1" && endpoint.port() == 5000);
+    CHECK(cache.getHits() == 0 && cache.getMisses() == 1);
+    cache.lookUp("127.0.0.1", 5000, endpoint);
+    CHECK(cache.getHits() == 1 && cache.getMisses() == 1);
+    // another port is another entry
+    cache.lookUp("127.0.0.1", 5001, endpoint);
+    CHECK(endpoint.port() == 5001);
+    CHECK(cache.getMisses() == 2);
+
+    // 5000 becomes the most recently used, so 5001 is evicted for a third entry
+    cache.lookUp("127.0.0.1", 5000, endpoint);
+    cache.lookUp("127.0.0.2", 5000, endpoint);
+    CHECK(endpoint.address().to_string() == "127.0.0.2");
+    CHECK(cache.getHits() == 2 && cache.getMisses() == 3);
+    cache.lookUp("127.0.0.1", 5000, endpoint);
+    CHECK(cache.getHits() == 3 && cache.getMisses() == 3);
+    cache.lookUp("127.0.0.1", 5001, endpoint);
+    CHECK(cache.getHits() == 3 && cache.getMisses() == 4);
+    // which evicted 127.0.0.2, as 127.0.0.1:5000 was used after it
+    cache.lookUp("127.0.0.1", 5000, endpoint);
+    CHECK(cache.getHits() == 4 && cache.getMisses() == 4);
+    cache.lookUp("127.0.0.2", 5000, endpoint);
+    CHECK(cache.getHits() == 4 && cache.getMisses() == 5);
+
+    // a hostname is resolved on the strand, the lookup does not wait for it
+    CHECK(cache.lookUp("localhost", 5000, endpoint) == EndpointCache::RESOLVING);
+    CHECK(cache.lookUp("localhost", 5000, endpoint) == EndpointCache::RESOLVING);
+    ioContext.run();
+    CHECK(resolves == 1);
+    CHECK(cache.lookUp("localhost", 5000, endpoint) == EndpointCache::RESOLVED);
+    CHECK(endpoint.address().is_loopback() && endpoint.port() == 5000);
+
+    // the failure is kept for its time to live, instead of being resolved with each lookup
+    CHECK(cache.lookUp("no.such.host.invalid", 5000, endpoint) == EndpointCache::RESOLVING);
+    ioContext.restart();
+    ioContext.run();
+    CHECK(resolves == 2);
+    CHECK(cache.lookUp("no.such.host.invalid", 5000, endpoint) == EndpointCache::UNRESOLVABLE);
+    ioContext.restart();
+    ioContext.run();
+    CHECK(resolves == 2);
+}
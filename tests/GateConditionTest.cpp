@@ -0,0 +1,100 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file GateConditionTest.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Tests the GateCondition class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// own includes
+#include "DatagramUdp.hpp"
+#include "GateCondition.hpp"
+#include "Tests.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks whether @p condition parses and evaluates to @p expected, both with and without
+ * knowing the type of the source Plag
+ *
+ * @param condition text of the condition
+ * @param datagram the Datagram to evaluate it for
+ * @param expected expected outcome
+ * @return true if both outcomes are as expected
+ */
+static bool evaluatesTo(const string & condition, const Datagram & datagram, bool expected)
+{
+    return GateCondition(condition).evaluate(datagram) == expected
+           && GateCondition(condition, PlagType::UDP).evaluate(datagram) == expected;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks comparisons, the functions, their combinations and the precedence of "&&" over
+ * "||", as well as rejecting malformed conditions
+ *
+ */
+void testGateCondition()
+{
+    DatagramUdp datagram("udp1", "10.0.0.1", 4004, "sensors/a;42;hello");
+
+    const pair<const char *, bool> conditions[] = {
+        { "port == 4004", true },
+        { "port != 4004", false },
+        { "port < 5000", true },
+        { "port <= 4004", true },
+        { "port > 4004", false },
+        { "port >= 4005", false },
+        { "sender == \"10.0.0.1\"", true },
+        { "sender < \"9\"", true },          // strings compare as strings
+        { "PREFIX(payload,\"sensors/\")", true },
+        { "PREFIX(payload,\"actors/\")", false },
+        { "MATCH(payload,\"h.llo$\")", true },
+        { "MATCH(payload,\"^hello\")", false },
+        { "RANGE(SPLIT(payload,;).2,0,100)", true },
+        { "RANGE(SPLIT(payload,;).2,43,100)", false },
+        { "SPLIT(payload,;).2 == 42", true },
+        { "\"yes\"", true },
+        { "0", false },
+        { "!(port == 4004)", false },
+        { "port == 1 || port == 4004", true },
+        { "port == 1 && port == 4004", false },
+        { "port == 1 && port == 2 || port == 4004", true },
+        { "port == 1 && (port == 2 || port == 4004)", false },
+        { "  PREFIX(sender,\"10.\")  &&  !MATCH(payload,\"x\")  ", true }
+    };
+    for (const pair<const char *, bool> & condition : conditions)
+    {
+        checkCondition(evaluatesTo(condition.first, datagram, condition.second), condition.first,
+                       __FILE__, __LINE__);
+    }
+
+    const char * malformed[] = { "port ==", "PREFIX(payload", "port == 1 )", "(port == 1",
+                                 "RANGE(port,1)", "port == 1 &&" };
+    for (const char * condition : malformed)
+    {
+        bool threw = false;
+        try { GateCondition gate(condition); }
+        catch (std::invalid_argument &) { threw = true; }
+        checkCondition(threw, condition, __FILE__, __LINE__);
+    }
+}
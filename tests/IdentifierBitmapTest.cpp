@@ -0,0 +1,86 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file IdentifierBitmapTest.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Tests the IdentifierBitmap class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <stdexcept>
+#include <vector>
+
+// own includes
+#include "IdentifierBitmap.hpp"
+#include "Tests.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks handing out identifiers in order, skipping the 0, exhausting all identifiers and
+ * reusing freed ones after wrapping around
+ *
+ */
+void testIdentifierBitmap()
+{
+    IdentifierBitmap identifiers;
+    CHECK(!identifiers.isUsed(0));
+    CHECK(identifiers.findFreeAfter(0) == 1);
+    CHECK(identifiers.findFreeAfter(65535) == 1);
+
+    // in order, skipping used ones, also across words
+    identifiers.markUsed(1);
+    identifiers.markUsed(2);
+    identifiers.markUsed(64);
+    CHECK(identifiers.findFreeAfter(0) == 3);
+    CHECK(identifiers.findFreeAfter(63) == 65);
+    CHECK(identifiers.isUsed(64) && !identifiers.isUsed(65));
+    vector<uint64_t> used;
+    identifiers.collectUsed(used);
+    CHECK(used == (vector<uint64_t>{ 1, 2, 64 }));
+
+    // exhaustion
+    for (uint32_t identifier = 1; identifier <= 65535; identifier++)
+    {
+        identifiers.markUsed(static_cast<uint16_t>(identifier));
+    }
+    bool threw = false;
+    try { identifiers.findFreeAfter(0); }
+    catch (std::runtime_error &) { threw = true; }
+    CHECK(threw);
+    used.clear();
+    identifiers.collectUsed(used);
+    CHECK(used.size() == 65535 && used.front() == 1 && used.back() == 65535);
+
+    // reuse: a freed identifier is found from anywhere, wrapping around; 0 stays out
+    identifiers.markFree(40000);
+    CHECK(!identifiers.isUsed(40000));
+    CHECK(identifiers.findFreeAfter(0) == 40000);
+    CHECK(identifiers.findFreeAfter(39999) == 40000);
+    CHECK(identifiers.findFreeAfter(40000) == 40000);
+    CHECK(identifiers.findFreeAfter(50000) == 40000);
+    identifiers.markFree(0);
+    identifiers.markFree(65535);
+    CHECK(identifiers.findFreeAfter(40000) == 65535);
+    CHECK(identifiers.findFreeAfter(65535) == 40000);
+    identifiers.markUsed(40000);
+    identifiers.markUsed(65535);
+    threw = false;
+    try { identifiers.findFreeAfter(12345); }
+    catch (std::runtime_error &) { threw = true; }
+    CHECK(threw);
+}
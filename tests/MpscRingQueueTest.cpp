@@ -0,0 +1,113 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file MpscRingQueueTest.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Tests the MpscRingQueue class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <thread>
+#include <vector>
+
+// own includes
+#include "MpscRingQueue.hpp"
+#include "Tests.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks a full and an empty queue, the order of items across many wraparounds of the
+ * ring, the batch operations and several producers pushing while the consumer pops
+ *
+ */
+void testMpscRingQueue()
+{
+    // full and empty
+    MpscRingQueue<int> queue(5);
+    CHECK(queue.capacity() == 8);
+    CHECK(queue.empty());
+    int item = -1;
+    CHECK(!queue.pop(item));
+    for (int i = 0; i < 8; i++) CHECK(queue.push(i));
+    CHECK(!queue.push(8));
+    CHECK(queue.size() == 8);
+    CHECK(queue.pop(item) && item == 0);
+    CHECK(queue.push(8));
+    for (int i = 1; i <= 8; i++) CHECK(queue.pop(item) && item == i);
+    CHECK(!queue.pop(item));
+    CHECK(queue.empty());
+
+    // wraparound: the positions pass the capacity many times, the order stays
+    int next = 0;
+    int expected = 0;
+    for (int round = 0; round < 1000; round++)
+    {
+        for (int i = 0; i < 3 + round % 6; i++) CHECK(queue.push(next++));
+        while (queue.pop(item)) CHECK(item == expected++);
+    }
+    CHECK(expected == next);
+
+    // batches: what does not fit stays in the vector
+    vector<int> items;
+    for (int i = 0; i < 10; i++) items.push_back(100 + i);
+    CHECK(queue.pushBatch(items) == 8);
+    CHECK(items[8] == 108 && items[9] == 109);
+    vector<int> popped;
+    CHECK(queue.popBatch(popped, 5) == 5);
+    CHECK(queue.popBatch(popped, 5) == 3);
+    CHECK(popped.size() == 8 && popped.front() == 100 && popped.back() == 107);
+
+    // several producers: all items arrive once, those of each producer in order
+    const int producerCount = 4;
+    const int itemsPerProducer = 100000;
+    MpscRingQueue<int> shared(64);
+    vector<thread> producers;
+    for (int producer = 0; producer < producerCount; producer++)
+    {
+        producers.emplace_back([&shared, producer, itemsPerProducer]()
+        {
+            for (int i = 0; i < itemsPerProducer; i++)
+            {
+                while (!shared.push(producer * itemsPerProducer + i)) this_thread::yield();
+            }
+        });
+    }
+    vector<int> nextOfProducer(producerCount, 0);
+    int received = 0;
+    bool inOrder = true;
+    while (received < producerCount * itemsPerProducer)
+    {
+        if (!shared.pop(item))
+        {
+            this_thread::yield();
+            continue;
+        }
+        int producer = item / itemsPerProducer;
+        inOrder = inOrder && producer >= 0 && producer < producerCount
+                  && item % itemsPerProducer == nextOfProducer[producer];
+        if (producer >= 0 && producer < producerCount) ++nextOfProducer[producer];
+        ++received;
+    }
+    for (thread & producer : producers) producer.join();
+    CHECK(inOrder);
+    CHECK(shared.empty());
+    for (int producer = 0; producer < producerCount; producer++)
+    {
+        CHECK(nextOfProducer[producer] == itemsPerProducer);
+    }
+}
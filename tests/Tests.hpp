@@ -0,0 +1,42 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file Tests.hpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Holds the helpers shared by the tests
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+#ifndef TESTS_HPP
+#define TESTS_HPP
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks @p condition and reports it with its location, if it does not hold. The test goes
+ * on, so that one run reports all failed checks.
+ */
+#define CHECK(condition) checkCondition((condition), #condition, __FILE__, __LINE__)
+
+bool checkCondition(bool condition, const char * text, const char * file, int line);
+
+// one test per class, run by main() by name
+void testMpscRingQueue();
+void testDataExpression();
+void testGateCondition();
+void testEndpointCache();
+void testTimingWheel();
+void testIdentifierBitmap();
+
+#endif // TESTS_HPP
@@ -0,0 +1,124 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file TimingWheelTest.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Tests the TimingWheel class
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// own includes
+#include "TimingWheel.hpp"
+#include "Tests.hpp"
+
+using namespace std;
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief checks expiry within a turn and after several turns, cancelling and rescheduling keys
+ * and a jump over many turns at once. Times are given relative to the construction of each
+ * wheel, with a margin of two ticks around each deadline.
+ *
+ */
+void testTimingWheel()
+{
+    using chrono::milliseconds;
+    vector<uint64_t> expired;
+
+    // 10 ms ticks, a turn of 80 ms
+    TimingWheel wheel(milliseconds(10), 8, 100);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    wheel.schedule(1, start + milliseconds(25));
+    wheel.schedule(2, start + milliseconds(300));   // more than three turns ahead
+    wheel.schedule(3, start + milliseconds(50));
+    wheel.schedule(4, start + milliseconds(50));
+    CHECK(wheel.size() == 4);
+    CHECK(wheel.isScheduled(3));
+    wheel.cancel(3);
+    CHECK(!wheel.isScheduled(3));
+    wheel.cancel(3);
+    // rescheduling replaces the earlier deadline
+    wheel.schedule(4, start + milliseconds(150));
+    CHECK(wheel.size() == 3);
+
+    CHECK(wheel.expire(start + milliseconds(5), expired) == 0);
+    CHECK(wheel.expire(start + milliseconds(45), expired) == 1);
+    CHECK(expired == vector<uint64_t>{ 1 });
+    expired.clear();
+    CHECK(wheel.expire(start + milliseconds(120), expired) == 0);
+    CHECK(wheel.expire(start + milliseconds(170), expired) == 1);
+    CHECK(expired == vector<uint64_t>{ 4 });
+    expired.clear();
+    // key 2 passes its slot three times, before its rounds are used up
+    CHECK(wheel.expire(start + milliseconds(200), expired) == 0);
+    CHECK(wheel.expire(start + milliseconds(280), expired) == 0);
+    CHECK(wheel.expire(start + milliseconds(320), expired) == 1);
+    CHECK(expired == vector<uint64_t>{ 2 });
+    CHECK(wheel.size() == 0);
+    CHECK(!wheel.isScheduled(2));
+
+    bool threw = false;
+    try { wheel.schedule(100, start); }
+    catch (std::out_of_range &) { threw = true; }
+    CHECK(threw);
+
+    // many keys, expired in steps: each once, not before its deadline and at most a tick late
+    TimingWheel manyKeys(milliseconds(10), 16, 1000);
+    start = chrono::steady_clock::now();
+    vector<int> deadlines(1000);
+    for (uint64_t key = 0; key < 1000; key++)
+    {
+        deadlines[key] = static_cast<int>((key * 7919) % 2000);
+        manyKeys.schedule(key, start + milliseconds(deadlines[key]));
+    }
+    vector<int> expiredAt(1000, -1);
+    size_t expiredCount = 0;
+    for (int step = 0; step <= 2100; step += 37)
+    {
+        expired.clear();
+        expiredCount += manyKeys.expire(start + milliseconds(step), expired);
+        for (uint64_t key : expired)
+        {
+            CHECK(expiredAt[key] == -1);
+            expiredAt[key] = step;
+        }
+    }
+    CHECK(expiredCount == 1000);
+    bool inTime = true;
+    for (uint64_t key = 0; key < 1000; key++)
+    {
+        inTime = inTime && expiredAt[key] >= deadlines[key] - 20
+                 && expiredAt[key] <= deadlines[key] + 37 + 20;
+    }
+    CHECK(inTime);
+
+    // a jump over many turns hands out everything due at once
+    TimingWheel jump(milliseconds(10), 8, 10);
+    start = chrono::steady_clock::now();
+    for (uint64_t key = 0; key < 10; key++) jump.schedule(key, start + milliseconds(key * 100));
+    expired.clear();
+    CHECK(jump.expire(start + milliseconds(10000), expired) == 10);
+    sort(expired.begin(), expired.end());
+    CHECK(expired == (vector<uint64_t>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+
+    jump.schedule(5, start + milliseconds(20000));
+    jump.clear();
+    CHECK(jump.size() == 0 && !jump.isScheduled(5));
+}
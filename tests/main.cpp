@@ -0,0 +1,98 @@
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @file main.cpp
+ * @author Gerrit Erichsen (saxomophon@gmx.de)
+ * @contributors:
+ * @brief Runs the tests given by name, or all of them
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright LGPL v2.1
+ *
+ * Targets of chosen license for:
+ *      Users    : Please be so kind as to indicate your usage of this library by linking to the project
+ *                 page, currently being: https://github.com/saxomophon/plagn
+ *      Devs     : Your improvements to the code, should be available publicly under the same license.
+ *                 That way, anyone will benefit from it.
+ *      Corporate: Even you are either a User or a Developer. No charge will apply, no guarantee or
+ *                 warranty will be given.
+ *
+ */
+
+// std includes
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+// own includes
+#include "Tests.hpp"
+
+using namespace std;
+
+//! number of failed checks, may be counted from several threads
+static atomic<size_t> failureCount(0);
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief counts and reports a failed check
+ *
+ * @param condition outcome of the check
+ * @param text the checked condition as written
+ * @param file file of the check
+ * @param line line of the check
+ * @return bool @p condition
+ */
+bool checkCondition(bool condition, const char * text, const char * file, int line)
+{
+    if (!condition)
+    {
+        ++failureCount;
+        cerr << file << ":" << line << ": failed: " << text << endl;
+    }
+    return condition;
+}
+
+/**
+ *-------------------------------------------------------------------------------------------------
+ * @brief runs the tests named by the arguments, all of them without arguments
+ *
+ * @return int 0 if all checks held, 1 else
+ */
+int main(int argc, char * argv[])
+{
+    const pair<const char *, void (*)()> tests[] = {
+        { "MpscRingQueue", testMpscRingQueue },
+        { "DataExpression", testDataExpression },
+        { "GateCondition", testGateCondition },
+        { "EndpointCache", testEndpointCache },
+        { "TimingWheel", testTimingWheel },
+        { "IdentifierBitmap", testIdentifierBitmap }
+    };
+
+    bool ranAny = false;
+    for (const pair<const char *, void (*)()> & test : tests)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++) selected = selected || strcmp(argv[i], test.first) == 0;
+        if (!selected) continue;
+        ranAny = true;
+        size_t failuresBefore = failureCount;
+        try
+        {
+            test.second();
+        }
+        catch (exception & e)
+        {
+            ++failureCount;
+            cerr << test.first << " threw: " << e.what() << endl;
+        }
+        cout << test.first << (failureCount == failuresBefore ? " passed" : " failed") << endl;
+    }
+    if (!ranAny)
+    {
+        cerr << "No such test" << endl;
+        return 1;
+    }
+    return failureCount == 0 ? 0 : 1;
+}